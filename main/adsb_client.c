@@ -3,57 +3,100 @@
  */
 
 #include "adsb_client.h"
+#include "adsb_parser.h"
+#include "gzip_stream.h"
 #include "radar_config.h"
+#include "perf_stats.h"
+#include "task_layout.h"
+#include "poll_scheduler.h"
 #include "wifi.h"
 #include "esp_log.h"
 #include "esp_http_client.h"
 #include "esp_tls.h"
 #include "esp_crt_bundle.h"
-#include "cJSON.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <time.h>
 
 static const char *TAG = "adsb_client";
 
-// HTTP response buffer
-#define HTTP_RECV_BUFFER_SIZE (32 * 1024)  // 32KB for JSON response
-static char s_http_buffer[HTTP_RECV_BUFFER_SIZE];
-static int s_http_buffer_len = 0;
+// Streaming parser state (body is parsed as it arrives, no response buffer)
+static adsb_parser_t s_parser;
+static int s_http_body_len = 0;
+
+// gzip bodies are inflated chunk by chunk in front of the parser
+static gzip_stream_t s_gzip;
+static bool s_body_gzip = false;
+
+// Per-request timing (see perf_stats.h)
+static int64_t s_request_start_us = 0;
+static int64_t s_feed_us = 0;        // Time inside adsb_parser_feed()
+static int64_t s_callback_us = 0;    // Part of s_feed_us spent in the data callback
+
+// Persistent HTTP client, kept alive across polls so the TCP/TLS session
+// is reused. Rebuilt only when the request URL changes.
+static esp_http_client_handle_t s_client = NULL;
+static char s_url[256];
+static bool s_connection_reused = false;
+
+// Aircraft are handed to the callback in small batches while streaming
+#define ADSB_EMIT_BATCH_SIZE 32
+static adsb_aircraft_t s_batch[ADSB_EMIT_BATCH_SIZE];
+static int s_batch_count = 0;
 
 // Client state
 static adsb_data_callback_t s_data_callback = NULL;
 static TaskHandle_t s_poll_task = NULL;
 static bool s_running = false;
 static uint32_t s_last_update_time = 0;
-static int s_current_interval_ms = ADSB_POLL_INTERVAL_MS;
 
-// Radar parameters (defaults from config)
-static float s_home_lat = HOME_LAT;
-static float s_home_lon = HOME_LON;
-static int s_radar_radius_nm = RADAR_RADIUS_NM;
+// Outcome of the last request, for the scheduler
+static int s_last_status = 0;
+static int s_retry_after_s = 0;
+static uint32_t s_last_latency_ms = 0;
+
+// Radar parameters (defaults from config). Set from the settings task and
+// read by the poll task, so both sides copy the whole struct under the lock.
+typedef struct {
+    float home_lat;
+    float home_lon;
+    int radius_nm;
+    bool changed;         // Poll task rebuilds the client before the next request
+} radar_params_t;
+
+static radar_params_t s_params = {HOME_LAT, HOME_LON, RADAR_RADIUS_NM, true};
+static portMUX_TYPE s_params_lock = portMUX_INITIALIZER_UNLOCKED;
 
 // Forward declarations
 static void adsb_poll_task(void *pvParameters);
 static esp_err_t http_event_handler(esp_http_client_event_t *evt);
 static bool fetch_and_parse_aircraft(void);
-static int parse_aircraft_json(const char *json_str, adsb_aircraft_t *aircraft, int max_count);
+static bool ensure_http_client(void);
+static void destroy_http_client(void);
+static void parser_emit_callback(const adsb_aircraft_t *aircraft, void *user_ctx);
+static void flush_batch(void);
+static void feed_body(const char *data, int len);
+static void gzip_sink(const char *data, int len, void *user_ctx);
 
 void adsb_client_init(adsb_data_callback_t callback)
 {
     s_data_callback = callback;
-    s_http_buffer_len = 0;
+    s_http_body_len = 0;
+    s_batch_count = 0;
     s_last_update_time = 0;
-    s_current_interval_ms = ADSB_POLL_INTERVAL_MS;
+    poll_scheduler_init();
     ESP_LOGI(TAG, "ADSB client initialized");
 }
 
 void adsb_client_set_radar_params(float lat, float lon, int radius_nm)
 {
-    s_home_lat = lat;
-    s_home_lon = lon;
-    s_radar_radius_nm = radius_nm;
+    radar_params_t params = {lat, lon, radius_nm, true};
+    portENTER_CRITICAL(&s_params_lock);
+    s_params = params;
+    portEXIT_CRITICAL(&s_params_lock);
     ESP_LOGI(TAG, "Radar params set: lat=%.4f, lon=%.4f, radius=%d NM", lat, lon, radius_nm);
 }
 
@@ -65,7 +108,11 @@ void adsb_client_start(void)
     }
 
     s_running = true;
-    xTaskCreate(adsb_poll_task, "adsb_poll", 8192, NULL, 5, &s_poll_task);
+    if (!task_layout_create(&TASK_LAYOUT_POLL, adsb_poll_task, NULL, &s_poll_task)) {
+        s_running = false;
+        s_poll_task = NULL;
+        return;
+    }
     ESP_LOGI(TAG, "ADSB polling task started");
 }
 
@@ -107,106 +154,196 @@ static void adsb_poll_task(void *pvParameters)
         ESP_LOGI(TAG, "Polling ADSB API...");
         bool success = fetch_and_parse_aircraft();
 
+        uint32_t now = xTaskGetTickCount() * portTICK_PERIOD_MS;
         if (success) {
-            // Success - reset to base interval
-            s_current_interval_ms = ADSB_POLL_INTERVAL_MS;
-            s_last_update_time = xTaskGetTickCount() * portTICK_PERIOD_MS;
-            ESP_LOGI(TAG, "ADSB data updated successfully, next poll in %d seconds",
-                     s_current_interval_ms / 1000);
+            poll_scheduler_on_success(s_last_latency_ms);
+            s_last_update_time = now;
         } else {
-            // Failed - exponential backoff
-            s_current_interval_ms *= 2;
-            if (s_current_interval_ms > ADSB_MAX_BACKOFF_MS) {
-                s_current_interval_ms = ADSB_MAX_BACKOFF_MS;
-            }
-            ESP_LOGW(TAG, "ADSB poll failed, backing off to %d seconds",
-                     s_current_interval_ms / 1000);
+            poll_scheduler_on_failure(s_last_status, s_retry_after_s);
         }
 
-        // Wait for next poll
-        vTaskDelay(pdMS_TO_TICKS(s_current_interval_ms));
+        // Wait for next poll (traffic-adaptive, backoff after failures)
+        uint32_t delay_ms = poll_scheduler_next_delay_ms(now);
+        if (success) {
+            ESP_LOGI(TAG, "ADSB data updated successfully, next poll in %.1f seconds", delay_ms / 1000.0f);
+        } else {
+            ESP_LOGW(TAG, "ADSB poll failed, backing off to %.1f seconds", delay_ms / 1000.0f);
+        }
+        vTaskDelay(pdMS_TO_TICKS(delay_ms));
     }
 
+    destroy_http_client();
     ESP_LOGI(TAG, "ADSB poll task exiting");
-    vTaskDelete(NULL);
+    task_layout_exit();
 }
 
 static bool fetch_and_parse_aircraft(void)
 {
-    // Build API URL with runtime radar parameters
-    char url[256];
-    snprintf(url, sizeof(url), "%s/%.7f/%.7f/%d",
-             ADSB_API_URL, s_home_lat, s_home_lon, s_radar_radius_nm);
-
-    ESP_LOGI(TAG, "Fetching: %s", url);
-
-    // Reset buffer
-    s_http_buffer_len = 0;
-    memset(s_http_buffer, 0, sizeof(s_http_buffer));
+    if (!ensure_http_client()) {
+        return false;
+    }
 
-    // Configure HTTP client
-    esp_http_client_config_t config = {
-        .url = url,
-        .event_handler = http_event_handler,
-        .timeout_ms = 10000,
-        .buffer_size = 2048,
-        .user_data = s_http_buffer,
-        .crt_bundle_attach = esp_crt_bundle_attach,  // Use ESP-IDF cert bundle for TLS
-    };
+    // Perform HTTP GET request (body is parsed inside http_event_handler).
+    // A kept-alive connection may have been dropped by the server while
+    // idle; in that case retry once on a fresh connection, which resumes
+    // the TLS session from the cached ticket.
+    esp_err_t err = ESP_FAIL;
+    for (int attempt = 0; attempt < 2; attempt++) {
+        // Reset streaming state
+        gzip_stream_end(&s_gzip);
+        s_body_gzip = false;
+        s_http_body_len = 0;
+        s_batch_count = 0;
+        s_feed_us = 0;
+        s_callback_us = 0;
+        s_last_status = 0;
+        s_retry_after_s = 0;
+        adsb_parser_init(&s_parser, parser_emit_callback, NULL);
+
+        s_request_start_us = perf_stats_now();
+        err = esp_http_client_perform(s_client);
+        if (err == ESP_OK || !s_connection_reused || s_http_body_len > 0) {
+            break;
+        }
 
-    esp_http_client_handle_t client = esp_http_client_init(&config);
-    if (client == NULL) {
-        ESP_LOGE(TAG, "Failed to initialize HTTP client");
-        return false;
+        ESP_LOGW(TAG, "Kept-alive connection failed (%s), reconnecting", esp_err_to_name(err));
+        esp_http_client_close(s_client);
+        s_connection_reused = false;
     }
 
-    // Perform HTTP GET request
-    esp_err_t err = esp_http_client_perform(client);
+    // Deliver whatever is left in the batch, even on a truncated response
+    uint32_t inflated_len = s_gzip.bytes_out;
+    bool gzip_ok = !s_body_gzip || gzip_stream_end(&s_gzip);
+    flush_batch();
 
     if (err == ESP_OK) {
-        int status_code = esp_http_client_get_status_code(client);
-        ESP_LOGI(TAG, "HTTP Status: %d, Length: %d bytes", status_code, s_http_buffer_len);
+        s_last_latency_ms = (uint32_t)((perf_stats_now() - s_request_start_us) / 1000);
+        perf_stats_record_since(PERF_HTTP_REQUEST, s_request_start_us);
+        perf_stats_record(PERF_DOWNLOAD_BYTES, (uint32_t)s_http_body_len);
+        perf_stats_record(PERF_PARSE, (uint32_t)(s_feed_us - s_callback_us));
+    }
 
-        if (status_code == 200 && s_http_buffer_len > 0) {
-            // Parse JSON response
-            adsb_aircraft_t aircraft[RADAR_MAX_AIRCRAFT];
-            int count = parse_aircraft_json(s_http_buffer, aircraft, RADAR_MAX_AIRCRAFT);
+    bool success = false;
+    if (err == ESP_OK) {
+        int status_code = esp_http_client_get_status_code(s_client);
+        s_last_status = status_code;
+        int count = adsb_parser_get_count(&s_parser);
+        if (s_body_gzip) {
+            ESP_LOGI(TAG, "HTTP Status: %d, Length: %d bytes gzip (%lu inflated)",
+                     status_code, s_http_body_len, (unsigned long)inflated_len);
+        } else {
+            ESP_LOGI(TAG, "HTTP Status: %d, Length: %d bytes", status_code, s_http_body_len);
+        }
 
-            if (count > 0) {
+        if (status_code == 200 && s_http_body_len > 0) {
+            if (!gzip_ok) {
+                ESP_LOGE(TAG, "Corrupt gzip body (%d aircraft recovered)", count);
+            } else if (!adsb_parser_finish(&s_parser)) {
+                ESP_LOGE(TAG, "Failed to parse JSON (%d aircraft recovered)", count);
+            } else {
+                // An empty "ac" array is a valid answer (quiet sky): it
+                // counts as a success so the scheduler backs off to idle
                 ESP_LOGI(TAG, "Parsed %d aircraft from API", count);
-
-                // Call user callback
-                if (s_data_callback) {
-                    s_data_callback(aircraft, count);
+                if (count == 0 && s_data_callback) {
+                    s_data_callback(s_batch, 0);  // Still lets the app prune departed tracks
                 }
-
-                esp_http_client_cleanup(client);
-                return true;
-            } else {
-                ESP_LOGW(TAG, "No aircraft found in response");
+                success = true;
             }
         } else {
-            ESP_LOGW(TAG, "Bad HTTP response: status=%d, len=%d", status_code, s_http_buffer_len);
+            ESP_LOGW(TAG, "Bad HTTP response: status=%d, len=%d", status_code, s_http_body_len);
         }
+
+        // Connection stays open for the next poll
+        s_connection_reused = true;
     } else {
         ESP_LOGE(TAG, "HTTP request failed: %s", esp_err_to_name(err));
+        // Drop the connection; the next poll reconnects on the same handle
+        esp_http_client_close(s_client);
+        s_connection_reused = false;
+    }
+
+    return success;
+}
+
+static bool ensure_http_client(void)
+{
+    portENTER_CRITICAL(&s_params_lock);
+    radar_params_t params = s_params;
+    s_params.changed = false;
+    portEXIT_CRITICAL(&s_params_lock);
+
+    if (s_client != NULL && !params.changed) {
+        return true;
+    }
+
+    destroy_http_client();
+
+    // Build API URL with runtime radar parameters
+    snprintf(s_url, sizeof(s_url), "%s/%.7f/%.7f/%d%s",
+             ADSB_API_URL, params.home_lat, params.home_lon, params.radius_nm, ADSB_API_QUERY);
+
+    ESP_LOGI(TAG, "Creating HTTP client for: %s", s_url);
+
+    // Configure HTTP client
+    esp_http_client_config_t config = {
+        .url = s_url,
+        .event_handler = http_event_handler,
+        .timeout_ms = 10000,
+        .buffer_size = 2048,
+        .crt_bundle_attach = esp_crt_bundle_attach,  // Use ESP-IDF cert bundle for TLS
+        .keep_alive_enable = true,                    // TCP keep-alive probes on the idle connection
+#if CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+        .save_client_session = true,                  // Resume TLS via session ticket on reconnect
+#endif
+    };
+
+    s_client = esp_http_client_init(&config);
+    if (s_client == NULL) {
+        ESP_LOGE(TAG, "Failed to initialize HTTP client");
+        return false;
     }
+#if ADSB_ACCEPT_GZIP
+    esp_http_client_set_header(s_client, "Accept-Encoding", "gzip");
+#endif
 
-    esp_http_client_cleanup(client);
-    return false;
+    s_connection_reused = false;
+    return true;
+}
+
+static void destroy_http_client(void)
+{
+    if (s_client != NULL) {
+        esp_http_client_cleanup(s_client);
+        s_client = NULL;
+    }
+    s_connection_reused = false;
 }
 
 static esp_err_t http_event_handler(esp_http_client_event_t *evt)
 {
     switch (evt->event_id) {
+        case HTTP_EVENT_ON_CONNECTED:
+            // Not raised when a kept-alive connection is reused
+            perf_stats_record_since(PERF_HTTP_CONNECT, s_request_start_us);
+            break;
+
+        case HTTP_EVENT_ON_HEADER:
+            if (strcasecmp(evt->header_key, "Content-Encoding") == 0 &&
+                strstr(evt->header_value, "gzip") != NULL) {
+                s_body_gzip = true;
+            } else if (strcasecmp(evt->header_key, "Retry-After") == 0) {
+                // Delay-seconds form only; an HTTP-date falls back to backoff
+                s_retry_after_s = atoi(evt->header_value);
+            }
+            break;
+
         case HTTP_EVENT_ON_DATA:
-            // Append data to buffer
-            if (s_http_buffer_len + evt->data_len < HTTP_RECV_BUFFER_SIZE - 1) {
-                memcpy(s_http_buffer + s_http_buffer_len, evt->data, evt->data_len);
-                s_http_buffer_len += evt->data_len;
-                s_http_buffer[s_http_buffer_len] = '\0';
-            } else {
-                ESP_LOGW(TAG, "HTTP buffer overflow, response too large");
+            // Parse body incrementally; error pages are counted but not parsed
+            s_http_body_len += evt->data_len;
+            if (esp_http_client_get_status_code(evt->client) == 200) {
+                int64_t start = perf_stats_now();
+                feed_body((const char *)evt->data, evt->data_len);
+                s_feed_us += perf_stats_now() - start;
             }
             break;
 
@@ -224,79 +361,42 @@ static esp_err_t http_event_handler(esp_http_client_event_t *evt)
     return ESP_OK;
 }
 
-static int parse_aircraft_json(const char *json_str, adsb_aircraft_t *aircraft, int max_count)
+// Route a body chunk to the parser, through the gzip decoder when needed
+static void feed_body(const char *data, int len)
 {
-    cJSON *root = cJSON_Parse(json_str);
-    if (root == NULL) {
-        ESP_LOGE(TAG, "Failed to parse JSON");
-        return 0;
+    if (!s_body_gzip) {
+        adsb_parser_feed(&s_parser, data, len);
+        return;
     }
 
-    // Get "ac" array (aircraft array)
-    cJSON *ac_array = cJSON_GetObjectItem(root, "ac");
-    if (!cJSON_IsArray(ac_array)) {
-        ESP_LOGW(TAG, "No 'ac' array in JSON response");
-        cJSON_Delete(root);
-        return 0;
+    if (s_gzip.zs == NULL && !s_gzip.error) {
+        gzip_stream_begin(&s_gzip, gzip_sink, NULL);
     }
+    gzip_stream_feed(&s_gzip, data, len);
+}
 
-    int count = 0;
-    cJSON *ac_item = NULL;
-    cJSON_ArrayForEach(ac_item, ac_array) {
-        if (count >= max_count) {
-            ESP_LOGW(TAG, "Reached max aircraft limit (%d), stopping parse", max_count);
-            break;
-        }
-
-        // Extract fields
-        cJSON *hex = cJSON_GetObjectItem(ac_item, "hex");
-        cJSON *flight = cJSON_GetObjectItem(ac_item, "flight");
-        cJSON *lat = cJSON_GetObjectItem(ac_item, "lat");
-        cJSON *lon = cJSON_GetObjectItem(ac_item, "lon");
-        cJSON *alt_baro = cJSON_GetObjectItem(ac_item, "alt_baro");
-        cJSON *gs = cJSON_GetObjectItem(ac_item, "gs");
-        cJSON *track = cJSON_GetObjectItem(ac_item, "track");
-
-        // Must have hex code and position
-        if (!cJSON_IsString(hex)) {
-            continue;  // Skip aircraft without hex
-        }
-
-        bool has_pos = (cJSON_IsNumber(lat) && cJSON_IsNumber(lon));
-
-        // Fill aircraft structure
-        memset(&aircraft[count], 0, sizeof(adsb_aircraft_t));
-
-        strncpy(aircraft[count].hex, hex->valuestring, sizeof(aircraft[count].hex) - 1);
-
-        if (cJSON_IsString(flight)) {
-            // Trim whitespace from callsign
-            const char *cs = flight->valuestring;
-            while (*cs == ' ') cs++;  // Skip leading spaces
-            strncpy(aircraft[count].callsign, cs, sizeof(aircraft[count].callsign) - 1);
-            // Remove trailing spaces
-            int len = strlen(aircraft[count].callsign);
-            while (len > 0 && aircraft[count].callsign[len - 1] == ' ') {
-                aircraft[count].callsign[--len] = '\0';
-            }
-        }
-
-        if (has_pos) {
-            aircraft[count].lat = (float)lat->valuedouble;
-            aircraft[count].lon = (float)lon->valuedouble;
-            aircraft[count].has_position = true;
-        } else {
-            aircraft[count].has_position = false;
-        }
+static void gzip_sink(const char *data, int len, void *user_ctx)
+{
+    (void)user_ctx;
+    adsb_parser_feed(&s_parser, data, len);
+}
 
-        aircraft[count].altitude = cJSON_IsNumber(alt_baro) ? alt_baro->valueint : 0;
-        aircraft[count].speed = cJSON_IsNumber(gs) ? (float)gs->valuedouble : 0.0f;
-        aircraft[count].track = cJSON_IsNumber(track) ? (float)track->valuedouble : 0.0f;
+static void parser_emit_callback(const adsb_aircraft_t *aircraft, void *user_ctx)
+{
+    (void)user_ctx;
 
-        count++;
+    memcpy(&s_batch[s_batch_count++], aircraft, sizeof(adsb_aircraft_t));
+    if (s_batch_count >= ADSB_EMIT_BATCH_SIZE) {
+        flush_batch();
     }
+}
 
-    cJSON_Delete(root);
-    ESP_LOGI(TAG, "Successfully parsed %d aircraft from JSON", count);
-    return count;
+static void flush_batch(void)
+{
+    if (s_batch_count > 0 && s_data_callback) {
+        int64_t start = perf_stats_now();
+        s_data_callback(s_batch, s_batch_count);
+        s_callback_us += perf_stats_now() - start;
+    }
+    s_batch_count = 0;
 }
@@ -8,6 +8,11 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+// Where a report came from; on the same ICAO a higher source wins while
+// its fix is fresh (see ADSB_SOURCE_HOLD_MS)
+#define ADSB_SOURCE_API   0    // adsb.lol HTTP poll
+#define ADSB_SOURCE_LOCAL 1    // Local receiver feed (sbs_client)
+
 // Aircraft data structure from API
 typedef struct {
     char hex[8];           // ICAO hex code (e.g., "7C6B2D")
@@ -18,10 +23,13 @@ typedef struct {
     float speed;           // Ground speed in knots
     float track;           // Heading in degrees (0-360)
     bool has_position;     // Valid lat/lon data
+    uint8_t source;        // ADSB_SOURCE_*
 } adsb_aircraft_t;
 
 // Callback for new aircraft data
-// Called when API returns fresh data
+// Called with successive batches while a response is being streamed,
+// so one poll may invoke it several times; a poll that returns no
+// aircraft invokes it once with count 0
 typedef void (*adsb_data_callback_t)(const adsb_aircraft_t *aircraft, int count);
 
 /**
@@ -40,7 +48,8 @@ void adsb_client_set_radar_params(float lat, float lon, int radius_nm);
 
 /**
  * @brief Start the ADSB polling task
- * Polls API every 10 seconds for aircraft within configured radius
+ * Polls the API for aircraft within the configured radius, at an
+ * interval set by poll_scheduler (traffic, backoff, sweep phase)
  */
 void adsb_client_start(void);
 
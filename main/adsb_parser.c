@@ -0,0 +1,276 @@
+/*
+ * Streaming ADSB JSON Parser Implementation
+ *
+ * A small hand-written JSON lexer/structure tracker. It understands enough
+ * JSON to walk any well-formed document, but only materialises the scalar
+ * fields of objects found directly inside the top-level "ac" array:
+ *
+ *   depth 1: { ...root object...
+ *   depth 2:   "ac": [ ...
+ *   depth 3:     { "hex": ..., "lat": ..., ... }   <- one aircraft
+ *
+ * Nested values inside an aircraft (e.g. "mlat": [], "nav_modes": [...])
+ * are walked and discarded.
+ */
+
+#include "adsb_parser.h"
+#include <string.h>
+#include <stdlib.h>
+
+// Lexer states
+enum {
+    LEX_VALUE = 0,       // Between tokens (structural characters)
+    LEX_STRING,          // Inside a string
+    LEX_STRING_ESCAPE,   // After a backslash inside a string
+    LEX_STRING_UNICODE,  // Skipping the 4 hex digits of a \uXXXX escape
+    LEX_LITERAL,         // Inside a number / true / false / null
+};
+
+// Depth of an aircraft object (root object -> "ac" array -> aircraft)
+#define AIRCRAFT_DEPTH 3
+
+static void process_structural(adsb_parser_t *p, char c);
+static void handle_scalar(adsb_parser_t *p, bool is_string);
+static void begin_aircraft(adsb_parser_t *p);
+static void finish_aircraft(adsb_parser_t *p);
+
+void adsb_parser_init(adsb_parser_t *parser, adsb_parser_emit_cb_t emit, void *user_ctx)
+{
+    memset(parser, 0, sizeof(*parser));
+    parser->lex_state = LEX_VALUE;
+    parser->emit = emit;
+    parser->user_ctx = user_ctx;
+}
+
+void adsb_parser_feed(adsb_parser_t *parser, const char *data, int len)
+{
+    adsb_parser_t *p = parser;
+
+    for (int i = 0; i < len && !p->error; i++) {
+        char c = data[i];
+
+        switch (p->lex_state) {
+            case LEX_STRING:
+                if (c == '"') {
+                    p->token[p->token_len] = '\0';
+                    p->lex_state = LEX_VALUE;
+                    if (p->string_is_key) {
+                        strncpy(p->key, p->token, sizeof(p->key) - 1);
+                        p->key[sizeof(p->key) - 1] = '\0';
+                        p->expect_key = false;
+                    } else {
+                        handle_scalar(p, true);
+                    }
+                } else if (c == '\\') {
+                    p->lex_state = LEX_STRING_ESCAPE;
+                } else if (p->token_len < ADSB_PARSER_TOKEN_LEN - 1) {
+                    p->token[p->token_len++] = c;
+                }
+                break;
+
+            case LEX_STRING_ESCAPE: {
+                char decoded = c;
+                switch (c) {
+                    case 'n': decoded = '\n'; break;
+                    case 't': decoded = '\t'; break;
+                    case 'r': decoded = '\r'; break;
+                    case 'b': decoded = '\b'; break;
+                    case 'f': decoded = '\f'; break;
+                    case 'u':
+                        decoded = '?';  // Non-ASCII never appears in fields we keep
+                        p->unicode_remaining = 4;
+                        break;
+                    default:
+                        break;  // \" \\ \/ map to themselves
+                }
+                if (p->token_len < ADSB_PARSER_TOKEN_LEN - 1) {
+                    p->token[p->token_len++] = decoded;
+                }
+                p->lex_state = (c == 'u') ? LEX_STRING_UNICODE : LEX_STRING;
+                break;
+            }
+
+            case LEX_STRING_UNICODE:
+                if (--p->unicode_remaining == 0) {
+                    p->lex_state = LEX_STRING;
+                }
+                break;
+
+            case LEX_LITERAL:
+                if ((c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+                    c == '-' || c == '+' || c == '.') {
+                    if (p->token_len < ADSB_PARSER_TOKEN_LEN - 1) {
+                        p->token[p->token_len++] = c;
+                    }
+                    break;
+                }
+                // Literal ended - handle it, then treat this char as structural
+                p->token[p->token_len] = '\0';
+                p->lex_state = LEX_VALUE;
+                handle_scalar(p, false);
+                process_structural(p, c);
+                break;
+
+            case LEX_VALUE:
+            default:
+                process_structural(p, c);
+                break;
+        }
+    }
+
+    p->bytes += len;
+}
+
+bool adsb_parser_finish(adsb_parser_t *parser)
+{
+    return !parser->error &&
+           parser->depth == 0 &&
+           parser->lex_state == LEX_VALUE &&
+           parser->seen_ac_array;
+}
+
+int adsb_parser_get_count(const adsb_parser_t *parser)
+{
+    return parser->emitted;
+}
+
+// Internal functions
+
+static void process_structural(adsb_parser_t *p, char c)
+{
+    switch (c) {
+        case '{':
+        case '[':
+            if (p->depth >= ADSB_PARSER_MAX_DEPTH) {
+                p->error = true;
+                return;
+            }
+            if (c == '[' && p->depth == 1 && p->stack[0] == '{' && strcmp(p->key, "ac") == 0) {
+                p->in_ac_array = true;
+                p->seen_ac_array = true;
+            } else if (c == '{' && p->depth == AIRCRAFT_DEPTH - 1 && p->in_ac_array) {
+                begin_aircraft(p);
+            }
+            p->stack[p->depth++] = c;
+            p->expect_key = (c == '{');
+            break;
+
+        case '}':
+        case ']':
+            if (p->depth == 0 || p->stack[p->depth - 1] != (c == '}' ? '{' : '[')) {
+                p->error = true;
+                return;
+            }
+            p->depth--;
+            if (c == '}' && p->depth == AIRCRAFT_DEPTH - 1 && p->in_ac_array) {
+                finish_aircraft(p);
+            } else if (c == ']' && p->depth == 1 && p->in_ac_array) {
+                p->in_ac_array = false;
+            }
+            p->expect_key = false;
+            break;
+
+        case ',':
+            p->expect_key = (p->depth > 0 && p->stack[p->depth - 1] == '{');
+            break;
+
+        case ':':
+            p->expect_key = false;
+            break;
+
+        case '"':
+            p->lex_state = LEX_STRING;
+            p->token_len = 0;
+            p->string_is_key = p->expect_key;
+            break;
+
+        case ' ':
+        case '\t':
+        case '\r':
+        case '\n':
+            break;
+
+        default:
+            p->lex_state = LEX_LITERAL;
+            p->token[0] = c;
+            p->token_len = 1;
+            break;
+    }
+}
+
+static void begin_aircraft(adsb_parser_t *p)
+{
+    memset(&p->current, 0, sizeof(p->current));
+    p->current_has_hex = false;
+    p->current_has_lat = false;
+    p->current_has_lon = false;
+}
+
+static void finish_aircraft(adsb_parser_t *p)
+{
+    // Must have hex code (same rule as the old cJSON path)
+    if (!p->current_has_hex) {
+        return;
+    }
+
+    p->current.has_position = p->current_has_lat && p->current_has_lon;
+    if (!p->current.has_position) {
+        p->current.lat = 0.0f;
+        p->current.lon = 0.0f;
+    }
+
+    if (p->emit) {
+        p->emit(&p->current, p->user_ctx);
+    }
+    p->emitted++;
+}
+
+static void handle_scalar(adsb_parser_t *p, bool is_string)
+{
+    // Only scalar members of an aircraft object are interesting
+    if (!p->in_ac_array || p->depth != AIRCRAFT_DEPTH || p->stack[AIRCRAFT_DEPTH - 1] != '{') {
+        return;
+    }
+
+    const char *tok = p->token;
+    bool is_number = !is_string && (tok[0] == '-' || (tok[0] >= '0' && tok[0] <= '9'));
+    adsb_aircraft_t *ac = &p->current;
+
+    if (strcmp(p->key, "hex") == 0) {
+        if (is_string) {
+            strncpy(ac->hex, tok, sizeof(ac->hex) - 1);
+            ac->hex[sizeof(ac->hex) - 1] = '\0';
+            p->current_has_hex = true;
+        }
+    } else if (strcmp(p->key, "flight") == 0) {
+        if (is_string) {
+            // Trim whitespace from callsign
+            const char *cs = tok;
+            while (*cs == ' ') cs++;  // Skip leading spaces
+            strncpy(ac->callsign, cs, sizeof(ac->callsign) - 1);
+            ac->callsign[sizeof(ac->callsign) - 1] = '\0';
+            // Remove trailing spaces
+            int len = strlen(ac->callsign);
+            while (len > 0 && ac->callsign[len - 1] == ' ') {
+                ac->callsign[--len] = '\0';
+            }
+        }
+    } else if (strcmp(p->key, "lat") == 0) {
+        if (is_number) {
+            ac->lat = strtof(tok, NULL);
+            p->current_has_lat = true;
+        }
+    } else if (strcmp(p->key, "lon") == 0) {
+        if (is_number) {
+            ac->lon = strtof(tok, NULL);
+            p->current_has_lon = true;
+        }
+    } else if (strcmp(p->key, "alt_baro") == 0) {
+        // "ground" (string) leaves altitude at 0
+        ac->altitude = is_number ? (int)strtod(tok, NULL) : 0;
+    } else if (strcmp(p->key, "gs") == 0) {
+        ac->speed = is_number ? strtof(tok, NULL) : 0.0f;
+    } else if (strcmp(p->key, "track") == 0) {
+        ac->track = is_number ? strtof(tok, NULL) : 0.0f;
+    }
+}
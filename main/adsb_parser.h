@@ -0,0 +1,87 @@
+/*
+ * Streaming ADSB JSON Parser
+ * Incremental, event-driven parser for adsb.lol "ac" responses
+ *
+ * Bytes are fed as they arrive from the HTTP client. Each element of the
+ * top-level "ac" array is decoded into an adsb_aircraft_t and emitted as
+ * soon as its closing brace is seen, so at most one aircraft object is held
+ * in memory regardless of response size.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "adsb_client.h"
+
+// Maximum JSON nesting depth tracked (adsb.lol responses nest 4 deep)
+#define ADSB_PARSER_MAX_DEPTH 16
+
+// Token buffer sizes (longer values are truncated, never overflowed)
+#define ADSB_PARSER_KEY_LEN   16
+#define ADSB_PARSER_TOKEN_LEN 32
+
+// Callback for each decoded aircraft
+typedef void (*adsb_parser_emit_cb_t)(const adsb_aircraft_t *aircraft, void *user_ctx);
+
+// Parser state (opaque to callers, allocate statically)
+typedef struct {
+    // Lexer
+    uint8_t lex_state;
+    uint8_t unicode_remaining;
+    bool string_is_key;
+    char token[ADSB_PARSER_TOKEN_LEN];
+    int token_len;
+    char key[ADSB_PARSER_KEY_LEN];
+
+    // Structure
+    char stack[ADSB_PARSER_MAX_DEPTH];  // '{' or '['
+    int depth;
+    bool expect_key;
+    bool in_ac_array;
+    bool seen_ac_array;
+    bool error;
+
+    // Aircraft under construction
+    adsb_aircraft_t current;
+    bool current_has_hex;
+    bool current_has_lat;
+    bool current_has_lon;
+
+    // Output
+    adsb_parser_emit_cb_t emit;
+    void *user_ctx;
+    int emitted;
+    int bytes;
+} adsb_parser_t;
+
+/**
+ * @brief Reset parser for a new response
+ * @param parser Parser state
+ * @param emit Callback invoked once per decoded aircraft
+ * @param user_ctx Opaque pointer passed to the callback
+ */
+void adsb_parser_init(adsb_parser_t *parser, adsb_parser_emit_cb_t emit, void *user_ctx);
+
+/**
+ * @brief Feed a chunk of response body
+ * Can be called with arbitrary chunk boundaries (mid-token, mid-string)
+ * @param parser Parser state
+ * @param data Chunk data (not NUL-terminated)
+ * @param len Chunk length in bytes
+ */
+void adsb_parser_feed(adsb_parser_t *parser, const char *data, int len);
+
+/**
+ * @brief Finish parsing after the last chunk
+ * @param parser Parser state
+ * @return true if a complete document containing an "ac" array was parsed
+ */
+bool adsb_parser_finish(adsb_parser_t *parser);
+
+/**
+ * @brief Get number of aircraft emitted so far
+ * @param parser Parser state
+ * @return Emitted aircraft count
+ */
+int adsb_parser_get_count(const adsb_parser_t *parser);
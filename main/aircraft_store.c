@@ -4,144 +4,360 @@
 
 #include "aircraft_store.h"
 #include "adsb_client.h"
+#include "icao_index.h"
+#include "perf_stats.h"
+#include "radar_math.h"
 #include "radar_config.h"
 #include "esp_log.h"
+#include "mem_budget.h"
+#include "esp_heap_caps.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/semphr.h"
 #include <string.h>
 #include <math.h>
+#include <stdatomic.h>
 
 static const char *TAG = "aircraft_store";
 
-// Aircraft storage
-static tracked_aircraft_t s_aircraft[MAX_AIRCRAFT];
+// Eviction weighting: each second since a track was last seen counts as
+// this many NM of extra distance, so stale far-away tracks go first
+#define EVICTION_NM_PER_STALE_SEC 1.0f
+
+#define NM_PER_DEG_LAT 60.0f
+#define DEG_TO_RAD ((float)M_PI / 180.0f)
+#define EARTH_RADIUS_NM 3440.065f
+
+// Per-track strings (PSRAM; only read when publishing or logging)
+typedef struct {
+    char hex[8];
+    char callsign[12];
+} track_strings_t;
+
+// Decimated fix history (PSRAM ring, TRACK_HISTORY_POINTS per slot).
+// Screen positions are kept next to lat/lon so publishing only copies;
+// they are recomputed when home or radius change.
+typedef struct {
+    float lat[TRACK_HISTORY_POINTS];
+    float lon[TRACK_HISTORY_POINTS];
+    aircraft_trail_point_t screen[TRACK_HISTORY_POINTS];
+    uint32_t last_ms;      // When the newest point was added
+    uint8_t head;          // Next write position
+    uint8_t count;
+} track_history_t;
+
+_Static_assert(TRACK_HISTORY_POINTS >= 2 && TRACK_HISTORY_POINTS <= 255, "TRACK_HISTORY_POINTS out of range");
+
+// Working set as structure-of-arrays, indexed by slot.
+// Each pass touches only the columns it needs: prune walks the active
+// bitmap and heard_ms, eviction adds distance_nm, and publish is the
+// only reader of the remaining columns and the string table.
+typedef struct {
+    uint32_t *active_bits;     // Bit per slot, 1 = in use
+    uint32_t *last_seen_ms;    // When the current fix arrived (dead-reckoning base)
+    uint32_t *heard_ms;        // Last time the aircraft was in a response (liveness)
+    uint32_t *icao;            // Integer ICAO keys
+    float *lat;                // Displayed (dead-reckoned) positions
+    float *lon;
+    float *fix_lat;            // Last reported positions (at last_seen_ms)
+    float *fix_lon;
+    float *err_lat;            // Projection error at the last fix, blended out
+    float *err_lon;
+    float *distance_nm;        // Range from home (bearing is computed on demand)
+    int16_t *screen_x;         // Projected screen coords
+    int16_t *screen_y;
+    int32_t *altitude;         // Kinematics
+    float *speed;
+    float *track;
+    uint8_t *source;           // ADSB_SOURCE_* that supplied the current fix
+    track_strings_t *strings;  // String table (PSRAM)
+    track_history_t *history;  // Trail rings (PSRAM)
+} track_columns_t;
+
+#define ACTIVE_WORDS(capacity) (((capacity) + 31) / 32)
+#define TRAIL_COORD_LIMIT 4096  // Trail points are clamped to +-this many pixels
+
+// Aircraft storage (working set, only touched by writers under s_mutex)
+static int s_capacity = 0;
+static track_columns_t s_tracks;
 static int s_active_count = 0;
 static SemaphoreHandle_t s_mutex = NULL;
 
+// ICAO -> slot index (also owns the free-list of slots)
+static icao_index_t s_index;
+
+// Slots written by the current update/projection pass (s_capacity entries)
+static int *s_touched = NULL;
+
+// Published snapshots
+// Three buffers so the writer always finds one that is neither the current
+// front nor held by a reader. Readers pin a buffer with a reference count
+// and re-check the front index, so they never block and never see a buffer
+// that is being rewritten.
+#define SNAPSHOT_BUFFERS 3
+typedef struct {
+    aircraft_snapshot_t view;             // Must be first (release casts back)
+    tracked_aircraft_t *aircraft;         // s_capacity entries (PSRAM)
+    aircraft_trail_point_t *trails;       // TRACK_HISTORY_POINTS per entry (PSRAM)
+    atomic_int readers;
+} snapshot_buffer_t;
+
+static snapshot_buffer_t s_snapshots[SNAPSHOT_BUFFERS];
+static atomic_int s_front = 0;
+static atomic_uint s_generation = 0;
+static bool s_publish_pending = false;
+
 // Home location (set at runtime)
 static float s_home_lat = HOME_LAT;  // Default from radar_config.h
 static float s_home_lon = HOME_LON;
 static int s_radar_radius_nm = RADAR_RADIUS_NM;  // Default radar radius
 
+// Home-derived terms, refreshed by update_home_terms() whenever home or
+// radius change so the per-track projection needs no home trig
+static float s_home_cos_lat = 1.0f;
+static float s_home_sin_lat = 0.0f;
+static float s_nm_per_deg_lon = NM_PER_DEG_LAT;
+static float s_pixels_per_nm = (float)RADAR_DISPLAY_RADIUS / RADAR_RADIUS_NM;
+static q16_t s_px_per_nm_q16 = (q16_t)((RADAR_DISPLAY_RADIUS << 16) / RADAR_RADIUS_NM);
+
 // Forward declarations
-static float haversine_distance_nm(float lat1, float lon1, float lat2, float lon2);
-static float calculate_bearing(float lat1, float lon1, float lat2, float lon2);
+static void update_home_terms(void);
+static float wrap_lon_delta(float dlon);
+#if RADAR_PROJECTION == PROJECTION_TANGENT_PLANE
+static void tangent_offset(float lat, float lon, float *out_east_nm, float *out_north_nm);
+#endif
+static float distance_from_home_nm(float lat, float lon);
+#if RADAR_PROJECTION == PROJECTION_GREAT_CIRCLE
+static float haversine_distance_nm(float lat, float lon);
+static float calculate_bearing(float lat, float lon);
 static void polar_to_screen(float distance_nm, float bearing_deg, int *out_x, int *out_y);
-static int find_aircraft(const char *hex);
-
-void aircraft_store_init(void)
+#endif
+static void project_screen(const int *slots, int count);
+static void project_point(float lat, float lon, aircraft_trail_point_t *out);
+static void history_append(int idx, uint32_t now);
+static void reproject_all(void);
+static void publish_snapshot(void);
+static void *pool_calloc(int count, size_t size, uint32_t caps, const char *what);
+static bool alloc_columns(int capacity);
+static int find_eviction_victim(uint32_t now, float incoming_distance_nm);
+static void project_track(int idx, uint32_t now);
+static bool track_unchanged(int idx, const adsb_aircraft_t *aircraft);
+
+bool aircraft_store_init(int capacity)
 {
-    memset(s_aircraft, 0, sizeof(s_aircraft));
+    radar_math_init();  // Dead reckoning and projection use the sine table
+
+    if (capacity < AIRCRAFT_STORE_MIN_CAPACITY) {
+        capacity = AIRCRAFT_STORE_MIN_CAPACITY;
+    } else if (capacity > RADAR_MAX_AIRCRAFT_LIMIT) {
+        capacity = RADAR_MAX_AIRCRAFT_LIMIT;
+    }
+
+    if (!alloc_columns(capacity)) {
+        return false;
+    }
+
+    for (int i = 0; i < SNAPSHOT_BUFFERS; i++) {
+        s_snapshots[i].aircraft = pool_calloc(capacity, sizeof(tracked_aircraft_t), MALLOC_CAP_SPIRAM, "snapshot");
+        s_snapshots[i].trails = pool_calloc(capacity * TRACK_HISTORY_POINTS, sizeof(aircraft_trail_point_t),
+                                            MALLOC_CAP_SPIRAM, "snapshot trails");
+        if (s_snapshots[i].aircraft == NULL || s_snapshots[i].trails == NULL) {
+            return false;
+        }
+        s_snapshots[i].view.generation = 0;
+        s_snapshots[i].view.count = 0;
+        s_snapshots[i].view.aircraft = s_snapshots[i].aircraft;
+        atomic_store(&s_snapshots[i].readers, 0);
+    }
+    atomic_store(&s_front, 0);
+    atomic_store(&s_generation, 0);
     s_active_count = 0;
+    update_home_terms();
+
+    if (!icao_index_init(&s_index, capacity, MEM_TAG_STORE)) {
+        ESP_LOGE(TAG, "Failed to allocate ICAO index!");
+        return false;
+    }
 
     s_mutex = xSemaphoreCreateMutex();
     if (s_mutex == NULL) {
         ESP_LOGE(TAG, "Failed to create mutex!");
-        return;
+        return false;
     }
 
-    ESP_LOGI(TAG, "Aircraft store initialized (max %d aircraft)", MAX_AIRCRAFT);
+    s_capacity = capacity;
+    ESP_LOGI(TAG, "Aircraft store initialized (max %d aircraft, %u B internal, %u B PSRAM)",
+             capacity,
+             (unsigned)(capacity * (12 * sizeof(float) + 2 * sizeof(int16_t) + 2 * sizeof(int32_t) + sizeof(uint8_t)) +
+                        ACTIVE_WORDS(capacity) * sizeof(uint32_t)),
+             (unsigned)(capacity * (sizeof(track_strings_t) + sizeof(track_history_t) +
+                                    SNAPSHOT_BUFFERS * (sizeof(tracked_aircraft_t) +
+                                                        TRACK_HISTORY_POINTS * sizeof(aircraft_trail_point_t)))));
+    return true;
+}
+
+int aircraft_store_get_capacity(void)
+{
+    return s_capacity;
 }
 
 void aircraft_store_set_home_location(float lat, float lon)
 {
     s_home_lat = lat;
     s_home_lon = lon;
+    reproject_all();
     ESP_LOGI(TAG, "Home location set to: %.6f, %.6f", lat, lon);
 }
 
 void aircraft_store_set_radar_radius(int radius_nm)
 {
+    if (radius_nm <= 0) {
+        return;
+    }
     s_radar_radius_nm = radius_nm;
+    reproject_all();
     ESP_LOGI(TAG, "Radar radius set to: %d NM", radius_nm);
 }
 
-void aircraft_store_update(const void *aircraft_data, int count)
+int aircraft_store_update(const void *aircraft_data, int count)
 {
     const adsb_aircraft_t *aircraft = (const adsb_aircraft_t *)aircraft_data;
 
     if (s_mutex == NULL) {
         ESP_LOGE(TAG, "Store not initialized!");
-        return;
+        return 0;
     }
 
+    int64_t start_us = perf_stats_now();
     xSemaphoreTake(s_mutex, portMAX_DELAY);
 
     uint32_t now = xTaskGetTickCount() * portTICK_PERIOD_MS;
     int updated = 0;
     int new_aircraft = 0;
+    int evicted = 0;
+    int dropped = 0;
+    int unchanged = 0;
+    int held = 0;
+    int touched = 0;
 
     for (int i = 0; i < count; i++) {
+        if (touched == s_capacity) {
+            // More entries than slots: project what we have before reusing the list
+            project_screen(s_touched, touched);
+            touched = 0;
+        }
         if (!aircraft[i].has_position) {
             continue;  // Skip aircraft without position
         }
 
-        // Find existing or new slot
-        int idx = find_aircraft(aircraft[i].hex);
+        uint32_t key = icao_key_from_hex(aircraft[i].hex);
+        if (key == ICAO_KEY_INVALID) {
+            continue;  // Skip malformed hex codes
+        }
+
+        // Distance is needed up front to rank against existing tracks
+        float distance_nm = distance_from_home_nm(aircraft[i].lat, aircraft[i].lon);
+
+        // Find existing or allocate new slot
+        bool inserted = false;
+        int idx = icao_index_insert(&s_index, key, &inserted);
         if (idx == -1) {
-            // Find empty slot
-            for (int j = 0; j < MAX_AIRCRAFT; j++) {
-                if (!s_aircraft[j].active) {
-                    idx = j;
-                    new_aircraft++;
-                    break;
-                }
+            // Store full: replace the lowest-priority track if this one ranks higher
+            int victim = find_eviction_victim(now, distance_nm);
+            if (victim == -1) {
+                dropped++;
+                continue;
             }
-        } else {
-            updated++;
+            icao_index_remove(&s_index, s_tracks.icao[victim]);
+            s_tracks.active_bits[victim / 32] &= ~(1u << (victim % 32));
+            evicted++;
+            idx = icao_index_insert(&s_index, key, &inserted);
         }
 
-        if (idx == -1) {
-            ESP_LOGW(TAG, "No free slots for aircraft %s", aircraft[i].hex);
+        track_strings_t *str = &s_tracks.strings[idx];
+        if (!inserted && track_unchanged(idx, &aircraft[i])) {
+            // Same report as last poll: keep it alive, but leave the fix time
+            // alone so dead reckoning carries on from the original fix
+            s_tracks.heard_ms[idx] = now;
+            unchanged++;
+            continue;
+        }
+        if (!inserted && aircraft[i].source < s_tracks.source[idx] &&
+            now - s_tracks.last_seen_ms[idx] < ADSB_SOURCE_HOLD_MS) {
+            // A higher-priority source has a fresh fix; this report only
+            // proves the aircraft is still around
+            s_tracks.heard_ms[idx] = now;
+            held++;
             continue;
         }
 
+        float err_lat = 0.0f;
+        float err_lon = 0.0f;
+        if (inserted) {
+            memset(str, 0, sizeof(*str));
+            s_tracks.history[idx].count = 0;
+            s_tracks.history[idx].head = 0;
+            new_aircraft++;
+        } else {
+            // Keep the blip where it was drawn and blend towards the new fix,
+            // unless the fix is too far off the projection to be the same path
+            project_track(idx, now);
+            err_lat = s_tracks.lat[idx] - aircraft[i].lat;
+            err_lon = s_tracks.lon[idx] - aircraft[i].lon;
+            float err_n = err_lat * NM_PER_DEG_LAT;
+            float err_e = err_lon * s_nm_per_deg_lon;
+            if (err_n * err_n + err_e * err_e > DEAD_RECKONING_SNAP_NM * DEAD_RECKONING_SNAP_NM) {
+                err_lat = 0.0f;
+                err_lon = 0.0f;
+            }
+            updated++;
+        }
+
         // Copy raw data
-        strncpy(s_aircraft[idx].hex, aircraft[i].hex, sizeof(s_aircraft[idx].hex) - 1);
-        strncpy(s_aircraft[idx].callsign, aircraft[i].callsign, sizeof(s_aircraft[idx].callsign) - 1);
-        s_aircraft[idx].lat = aircraft[i].lat;
-        s_aircraft[idx].lon = aircraft[i].lon;
-        s_aircraft[idx].altitude = aircraft[i].altitude;
-        s_aircraft[idx].speed = aircraft[i].speed;
-        s_aircraft[idx].track = aircraft[i].track;
-        s_aircraft[idx].has_position = true;
-
-        // Compute distance and bearing
-        s_aircraft[idx].distance_nm = haversine_distance_nm(
-            s_home_lat, s_home_lon,
-            aircraft[i].lat, aircraft[i].lon
-        );
-
-        s_aircraft[idx].bearing_deg = calculate_bearing(
-            s_home_lat, s_home_lon,
-            aircraft[i].lat, aircraft[i].lon
-        );
-
-        // Convert to screen coordinates
-        polar_to_screen(
-            s_aircraft[idx].distance_nm,
-            s_aircraft[idx].bearing_deg,
-            &s_aircraft[idx].screen_x,
-            &s_aircraft[idx].screen_y
-        );
+        s_tracks.icao[idx] = key;
+        strncpy(str->hex, aircraft[i].hex, sizeof(str->hex) - 1);
+        strncpy(str->callsign, aircraft[i].callsign, sizeof(str->callsign) - 1);
+        s_tracks.fix_lat[idx] = aircraft[i].lat;
+        s_tracks.fix_lon[idx] = aircraft[i].lon;
+        s_tracks.err_lat[idx] = err_lat;
+        s_tracks.err_lon[idx] = err_lon;
+        s_tracks.lat[idx] = aircraft[i].lat + err_lat;
+        s_tracks.lon[idx] = aircraft[i].lon + err_lon;
+        s_tracks.altitude[idx] = aircraft[i].altitude;
+        s_tracks.speed[idx] = aircraft[i].speed;
+        s_tracks.track[idx] = aircraft[i].track;
+        s_tracks.source[idx] = aircraft[i].source;
+        s_tracks.distance_nm[idx] = distance_nm;  // Ranks this track for eviction until projected
 
         // Update metadata
-        s_aircraft[idx].last_seen_ms = now;
-        s_aircraft[idx].active = true;
+        s_tracks.last_seen_ms[idx] = now;
+        s_tracks.heard_ms[idx] = now;
+        s_tracks.active_bits[idx / 32] |= 1u << (idx % 32);
+        history_append(idx, now);
+        s_touched[touched++] = idx;
     }
 
+    // Distance and screen position for every slot written by this batch
+    project_screen(s_touched, touched);
+
     // Update active count
-    s_active_count = 0;
-    for (int i = 0; i < MAX_AIRCRAFT; i++) {
-        if (s_aircraft[i].active) {
-            s_active_count++;
-        }
+    s_active_count = icao_index_count(&s_index);
+
+    // A batch of unchanged reports needs no new snapshot
+    if (updated > 0 || new_aircraft > 0 || evicted > 0 || s_publish_pending) {
+        publish_snapshot();
     }
 
     xSemaphoreGive(s_mutex);
-
-    ESP_LOGI(TAG, "Updated %d aircraft, %d new, %d total active",
-             updated, new_aircraft, s_active_count);
+    perf_stats_record_since(PERF_STORE_UPDATE, start_us);
+
+    // Debug level: the local feed flushes several times a second
+    ESP_LOGD(TAG, "Updated %d aircraft, %d new, %d unchanged, %d held, %d total active",
+             updated, new_aircraft, unchanged, held, s_active_count);
+    if (evicted > 0 || dropped > 0) {
+        ESP_LOGW(TAG, "Store full (%d): evicted %d lower-priority tracks, dropped %d",
+                 s_capacity, evicted, dropped);
+    }
+    return updated + new_aircraft;
 }
 
 int aircraft_store_prune(void)
@@ -155,24 +371,28 @@ int aircraft_store_prune(void)
     uint32_t now = xTaskGetTickCount() * portTICK_PERIOD_MS;
     int pruned = 0;
 
-    for (int i = 0; i < MAX_AIRCRAFT; i++) {
-        if (s_aircraft[i].active) {
-            uint32_t age_ms = now - s_aircraft[i].last_seen_ms;
+    for (int w = 0; w < ACTIVE_WORDS(s_capacity); w++) {
+        uint32_t bits = s_tracks.active_bits[w];
+        while (bits != 0) {
+            int i = w * 32 + __builtin_ctz(bits);
+            bits &= bits - 1;
+
+            uint32_t age_ms = now - s_tracks.heard_ms[i];
             if (age_ms > AIRCRAFT_TIMEOUT_MS) {
                 ESP_LOGI(TAG, "Pruning stale aircraft %s (age: %lu ms)",
-                         s_aircraft[i].hex, age_ms);
-                s_aircraft[i].active = false;
+                         s_tracks.strings[i].hex, (unsigned long)age_ms);
+                s_tracks.active_bits[w] &= ~(1u << (i % 32));
+                icao_index_remove(&s_index, s_tracks.icao[i]);
                 pruned++;
             }
         }
     }
 
     // Update active count
-    s_active_count = 0;
-    for (int i = 0; i < MAX_AIRCRAFT; i++) {
-        if (s_aircraft[i].active) {
-            s_active_count++;
-        }
+    s_active_count = icao_index_count(&s_index);
+
+    if (pruned > 0 || s_publish_pending) {
+        publish_snapshot();
     }
 
     xSemaphoreGive(s_mutex);
@@ -184,23 +404,78 @@ int aircraft_store_prune(void)
     return pruned;
 }
 
-int aircraft_store_get_all(tracked_aircraft_t *out_aircraft)
+void aircraft_store_project(void)
 {
-    if (s_mutex == NULL || out_aircraft == NULL) {
-        return 0;
+    if (s_mutex == NULL) {
+        return;
     }
 
+    int64_t start_us = perf_stats_now();
     xSemaphoreTake(s_mutex, portMAX_DELAY);
 
-    int count = 0;
-    for (int i = 0; i < MAX_AIRCRAFT; i++) {
-        if (s_aircraft[i].active) {
-            memcpy(&out_aircraft[count], &s_aircraft[i], sizeof(tracked_aircraft_t));
-            count++;
+    uint32_t now = xTaskGetTickCount() * portTICK_PERIOD_MS;
+    int touched = 0;
+    for (int w = 0; w < ACTIVE_WORDS(s_capacity); w++) {
+        uint32_t bits = s_tracks.active_bits[w];
+        while (bits != 0) {
+            int i = w * 32 + __builtin_ctz(bits);
+            bits &= bits - 1;
+            project_track(i, now);
+            s_touched[touched++] = i;
         }
     }
+    project_screen(s_touched, touched);
+
+    if (s_active_count > 0 || s_publish_pending) {
+        publish_snapshot();
+    }
 
     xSemaphoreGive(s_mutex);
+    perf_stats_record_since(PERF_STORE_PROJECT, start_us);
+}
+
+const aircraft_snapshot_t *aircraft_store_acquire_snapshot(void)
+{
+    while (true) {
+        int idx = atomic_load(&s_front);
+        atomic_fetch_add(&s_snapshots[idx].readers, 1);
+
+        // Writer may have swapped the front between the load and the pin
+        if (atomic_load(&s_front) == idx) {
+            return &s_snapshots[idx].view;
+        }
+        atomic_fetch_sub(&s_snapshots[idx].readers, 1);
+    }
+}
+
+void aircraft_store_release_snapshot(const aircraft_snapshot_t *snapshot)
+{
+    if (snapshot == NULL) {
+        return;
+    }
+    snapshot_buffer_t *buf = (snapshot_buffer_t *)snapshot;
+    atomic_fetch_sub(&buf->readers, 1);
+}
+
+uint32_t aircraft_store_get_generation(void)
+{
+    return atomic_load(&s_generation);
+}
+
+int aircraft_store_get_all(tracked_aircraft_t *out_aircraft)
+{
+    if (s_mutex == NULL || out_aircraft == NULL) {
+        return 0;
+    }
+
+    const aircraft_snapshot_t *snapshot = aircraft_store_acquire_snapshot();
+    int count = snapshot->count;
+    memcpy(out_aircraft, snapshot->aircraft, count * sizeof(tracked_aircraft_t));
+    aircraft_store_release_snapshot(snapshot);
+    for (int i = 0; i < count; i++) {
+        out_aircraft[i].trail = NULL;
+        out_aircraft[i].trail_count = 0;
+    }
 
     return count;
 }
@@ -210,50 +485,399 @@ int aircraft_store_get_count(void)
     return s_active_count;
 }
 
+float aircraft_store_bearing_deg(const tracked_aircraft_t *aircraft)
+{
+#if RADAR_PROJECTION == PROJECTION_TANGENT_PLANE
+    float east_nm, north_nm;
+    tangent_offset(aircraft->lat, aircraft->lon, &east_nm, &north_nm);
+    return fmodf(atan2f(east_nm, north_nm) / DEG_TO_RAD + 360.0f, 360.0f);
+#else
+    return calculate_bearing(aircraft->lat, aircraft->lon);
+#endif
+}
+
 // Internal functions
 
-static int find_aircraft(const char *hex)
+// Build the next generation into a free back buffer and swap it in.
+// Caller must hold s_mutex (single writer).
+static void publish_snapshot(void)
 {
-    for (int i = 0; i < MAX_AIRCRAFT; i++) {
-        if (s_aircraft[i].active && strcmp(s_aircraft[i].hex, hex) == 0) {
-            return i;
+    int front = atomic_load(&s_front);
+    int back = -1;
+    for (int i = 0; i < SNAPSHOT_BUFFERS; i++) {
+        if (i != front && atomic_load(&s_snapshots[i].readers) == 0) {
+            back = i;
+            break;
         }
     }
-    return -1;
+
+    if (back == -1) {
+        // Every spare buffer is pinned by a reader; publish on the next change
+        ESP_LOGW(TAG, "All snapshot buffers in use, deferring publish");
+        s_publish_pending = true;
+        return;
+    }
+
+    snapshot_buffer_t *buf = &s_snapshots[back];
+    int count = 0;
+    for (int w = 0; w < ACTIVE_WORDS(s_capacity); w++) {
+        uint32_t bits = s_tracks.active_bits[w];
+        while (bits != 0) {
+            int i = w * 32 + __builtin_ctz(bits);
+            bits &= bits - 1;
+
+            // The view holds only what is inside the current range; the
+            // working set keeps everything fetched for later zoom changes
+            if (s_tracks.distance_nm[i] > s_radar_radius_nm) {
+                continue;
+            }
+
+            tracked_aircraft_t *out = &buf->aircraft[count++];
+            memcpy(out->hex, s_tracks.strings[i].hex, sizeof(out->hex));
+            memcpy(out->callsign, s_tracks.strings[i].callsign, sizeof(out->callsign));
+            out->icao = s_tracks.icao[i];
+            out->lat = s_tracks.lat[i];
+            out->lon = s_tracks.lon[i];
+            out->altitude = s_tracks.altitude[i];
+            out->speed = s_tracks.speed[i];
+            out->track = s_tracks.track[i];
+            out->distance_nm = s_tracks.distance_nm[i];
+            out->screen_x = s_tracks.screen_x[i];
+            out->screen_y = s_tracks.screen_y[i];
+
+            // Trail, unrolled from the ring oldest first
+            const track_history_t *h = &s_tracks.history[i];
+            aircraft_trail_point_t *trail = &buf->trails[(count - 1) * TRACK_HISTORY_POINTS];
+            int start = (h->head + TRACK_HISTORY_POINTS - h->count) % TRACK_HISTORY_POINTS;
+            for (int p = 0; p < h->count; p++) {
+                trail[p] = h->screen[(start + p) % TRACK_HISTORY_POINTS];
+            }
+            out->trail = trail;
+            out->trail_count = h->count;
+            out->last_seen_ms = s_tracks.last_seen_ms[i];
+            out->active = true;
+            out->has_position = true;  // Only positioned aircraft are stored
+        }
+    }
+    buf->view.count = count;
+    buf->view.generation = atomic_load(&s_generation) + 1;
+
+    atomic_store(&s_front, back);
+    atomic_store(&s_generation, buf->view.generation);
+    s_publish_pending = false;
 }
 
-static float haversine_distance_nm(float lat1, float lon1, float lat2, float lon2)
+// Allocate a zeroed pool, preferring the given memory type but falling back
+// to any 8-bit capable heap (e.g. boards without PSRAM)
+static void *pool_calloc(int count, size_t size, uint32_t caps, const char *what)
 {
-    // Haversine formula for great circle distance
-    // Returns distance in nautical miles
+    void *pool = mem_budget_calloc(MEM_TAG_STORE, count, size, caps);
+    if (pool == NULL) {
+        ESP_LOGW(TAG, "Preferred memory unavailable for %s pool, falling back", what);
+        pool = mem_budget_calloc(MEM_TAG_STORE, count, size, MALLOC_CAP_8BIT);
+    }
+    if (pool == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate %s pool (%d x %u bytes)", what, count, (unsigned)size);
+    }
+    return pool;
+}
+
+// Pick the track to replace when the store is full.
+// Priority is nearest and most recently seen first; the victim is the
+// active track with the worst score, and only if it ranks below the
+// incoming aircraft (so a full store of nearer traffic is left alone).
+static int find_eviction_victim(uint32_t now, float incoming_distance_nm)
+{
+    int victim = -1;
+    float worst = incoming_distance_nm;
+
+    for (int w = 0; w < ACTIVE_WORDS(s_capacity); w++) {
+        uint32_t bits = s_tracks.active_bits[w];
+        while (bits != 0) {
+            int i = w * 32 + __builtin_ctz(bits);
+            bits &= bits - 1;
+
+            float age_s = (now - s_tracks.heard_ms[i]) / 1000.0f;
+            float score = s_tracks.distance_nm[i] + age_s * EVICTION_NM_PER_STALE_SEC;
+            if (score > worst) {
+                worst = score;
+                victim = i;
+            }
+        }
+    }
+
+    return victim;
+}
+
+// Move a track to its dead-reckoned position at `now`: the last fix advanced
+// along track at ground speed, plus the correction offset fading out over
+// DEAD_RECKONING_BLEND_MS. Extrapolation stops after DEAD_RECKONING_MAX_MS.
+// Screen coordinates are left to project_screen().
+static void project_track(int idx, uint32_t now)
+{
+    uint32_t age_ms = now - s_tracks.last_seen_ms[idx];
+    if (age_ms > DEAD_RECKONING_MAX_MS) {
+        age_ms = DEAD_RECKONING_MAX_MS;
+    }
+
+    float moved_nm = s_tracks.speed[idx] * (age_ms / 3600000.0f);
+    int track = radar_math_decideg(s_tracks.track[idx]);
+    float fix_lat = s_tracks.fix_lat[idx];
+    float dlat = moved_nm * Q16_TO_FLOAT(radar_math_cos(track)) / NM_PER_DEG_LAT;
+    float dlon = moved_nm * Q16_TO_FLOAT(radar_math_sin(track)) / s_nm_per_deg_lon;
+
+    float blend = 0.0f;
+    if (age_ms < DEAD_RECKONING_BLEND_MS) {
+        blend = 1.0f - (float)age_ms / DEAD_RECKONING_BLEND_MS;
+    }
+
+    s_tracks.lat[idx] = fix_lat + dlat + s_tracks.err_lat[idx] * blend;
+    s_tracks.lon[idx] = s_tracks.fix_lon[idx] + dlon + s_tracks.err_lon[idx] * blend;
+}
+
+// True if a report repeats the stored fix exactly (the API re-sends every
+// aircraft each poll, including ones whose position has not been refreshed)
+static bool track_unchanged(int idx, const adsb_aircraft_t *aircraft)
+{
+    return s_tracks.fix_lat[idx] == aircraft->lat &&
+           s_tracks.fix_lon[idx] == aircraft->lon &&
+           s_tracks.altitude[idx] == aircraft->altitude &&
+           s_tracks.speed[idx] == aircraft->speed &&
+           s_tracks.track[idx] == aircraft->track &&
+           strncmp(s_tracks.strings[idx].callsign, aircraft->callsign,
+                   sizeof(s_tracks.strings[idx].callsign) - 1) == 0;
+}
+
+// Recompute distance and screen position for a list of slots.
+// One pass over the lat/lon columns with the home terms hoisted; the
+// tangent-plane path is straight-line arithmetic plus one sqrtf per track,
+// with the pixel mapping done in Q16 (radar_math_project()).
+static void project_screen(const int *slots, int count)
+{
+#if RADAR_PROJECTION == PROJECTION_TANGENT_PLANE
+    const q16_t px = s_px_per_nm_q16;
+    for (int n = 0; n < count; n++) {
+        int idx = slots[n];
+        float east_nm, north_nm;
+        tangent_offset(s_tracks.lat[idx], s_tracks.lon[idx], &east_nm, &north_nm);
+        s_tracks.distance_nm[idx] = sqrtf(east_nm * east_nm + north_nm * north_nm);
+
+        int dx, dy;
+        radar_math_project(Q16_FROM_FLOAT(east_nm), Q16_FROM_FLOAT(north_nm), px, &dx, &dy);
+        s_tracks.screen_x[idx] = (int16_t)(SCREEN_CENTER_X + dx);
+        s_tracks.screen_y[idx] = (int16_t)(SCREEN_CENTER_Y + dy);
+    }
+#else
+    for (int n = 0; n < count; n++) {
+        int idx = slots[n];
+        float lat = s_tracks.lat[idx];
+        float lon = s_tracks.lon[idx];
+        s_tracks.distance_nm[idx] = haversine_distance_nm(lat, lon);
+
+        int screen_x, screen_y;
+        polar_to_screen(s_tracks.distance_nm[idx], calculate_bearing(lat, lon), &screen_x, &screen_y);
+        s_tracks.screen_x[idx] = (int16_t)screen_x;
+        s_tracks.screen_y[idx] = (int16_t)screen_y;
+    }
+#endif
+}
+
+// Allocate every column of the working set. Numeric columns go to internal
+// RAM (walked on every pass); the string table goes to PSRAM.
+static bool alloc_columns(int capacity)
+{
+    const uint32_t internal = MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT;
+
+    s_tracks.active_bits = pool_calloc(ACTIVE_WORDS(capacity), sizeof(uint32_t), internal, "active bitmap");
+    s_tracks.last_seen_ms = pool_calloc(capacity, sizeof(uint32_t), internal, "timestamps");
+    s_tracks.heard_ms = pool_calloc(capacity, sizeof(uint32_t), internal, "heard");
+    s_tracks.icao = pool_calloc(capacity, sizeof(uint32_t), internal, "icao");
+    s_tracks.lat = pool_calloc(capacity, sizeof(float), internal, "lat");
+    s_tracks.lon = pool_calloc(capacity, sizeof(float), internal, "lon");
+    s_tracks.fix_lat = pool_calloc(capacity, sizeof(float), internal, "fix_lat");
+    s_tracks.fix_lon = pool_calloc(capacity, sizeof(float), internal, "fix_lon");
+    s_tracks.err_lat = pool_calloc(capacity, sizeof(float), internal, "err_lat");
+    s_tracks.err_lon = pool_calloc(capacity, sizeof(float), internal, "err_lon");
+    s_tracks.distance_nm = pool_calloc(capacity, sizeof(float), internal, "distance");
+    s_tracks.screen_x = pool_calloc(capacity, sizeof(int16_t), internal, "screen_x");
+    s_tracks.screen_y = pool_calloc(capacity, sizeof(int16_t), internal, "screen_y");
+    s_tracks.altitude = pool_calloc(capacity, sizeof(int32_t), internal, "altitude");
+    s_tracks.speed = pool_calloc(capacity, sizeof(float), internal, "speed");
+    s_tracks.track = pool_calloc(capacity, sizeof(float), internal, "track");
+    s_tracks.source = pool_calloc(capacity, sizeof(uint8_t), internal, "source");
+    s_tracks.strings = pool_calloc(capacity, sizeof(track_strings_t), MALLOC_CAP_SPIRAM, "strings");
+    s_tracks.history = pool_calloc(capacity, sizeof(track_history_t), MALLOC_CAP_SPIRAM, "history");
+    s_touched = pool_calloc(capacity, sizeof(int), internal, "slot list");
+
+    return s_tracks.active_bits != NULL && s_tracks.last_seen_ms != NULL && s_tracks.heard_ms != NULL &&
+           s_tracks.icao != NULL && s_tracks.lat != NULL && s_tracks.lon != NULL &&
+           s_tracks.fix_lat != NULL && s_tracks.fix_lon != NULL &&
+           s_tracks.err_lat != NULL && s_tracks.err_lon != NULL &&
+           s_tracks.distance_nm != NULL && s_touched != NULL &&
+           s_tracks.screen_x != NULL && s_tracks.screen_y != NULL &&
+           s_tracks.altitude != NULL && s_tracks.speed != NULL &&
+           s_tracks.track != NULL && s_tracks.source != NULL && s_tracks.strings != NULL &&
+           s_tracks.history != NULL;
+}
 
-    const float R_NM = 3440.065f;  // Earth radius in nautical miles
+// Screen position of one point, clamped so far-off trail points can't
+// wrap int16 at small radii
+static void project_point(float lat, float lon, aircraft_trail_point_t *out)
+{
+    int x, y;
+#if RADAR_PROJECTION == PROJECTION_TANGENT_PLANE
+    float east_nm, north_nm;
+    tangent_offset(lat, lon, &east_nm, &north_nm);
+    radar_math_project(Q16_FROM_FLOAT(east_nm), Q16_FROM_FLOAT(north_nm), s_px_per_nm_q16, &x, &y);
+    x += SCREEN_CENTER_X;
+    y += SCREEN_CENTER_Y;
+#else
+    polar_to_screen(haversine_distance_nm(lat, lon), calculate_bearing(lat, lon), &x, &y);
+#endif
+    out->x = (int16_t)(x < -TRAIL_COORD_LIMIT ? -TRAIL_COORD_LIMIT : (x > TRAIL_COORD_LIMIT ? TRAIL_COORD_LIMIT : x));
+    out->y = (int16_t)(y < -TRAIL_COORD_LIMIT ? -TRAIL_COORD_LIMIT : (y > TRAIL_COORD_LIMIT ? TRAIL_COORD_LIMIT : y));
+}
+
+// Add the slot's current fix to its trail unless it is too soon or too
+// close to the last point, which bounds the trail by time and distance
+// however often reports arrive. Caller must hold s_mutex.
+static void history_append(int idx, uint32_t now)
+{
+    track_history_t *h = &s_tracks.history[idx];
+    float lat = s_tracks.fix_lat[idx];
+    float lon = s_tracks.fix_lon[idx];
+
+    if (h->count > 0) {
+        int last = (h->head + TRACK_HISTORY_POINTS - 1) % TRACK_HISTORY_POINTS;
+        if (now - h->last_ms < TRACK_HISTORY_MIN_INTERVAL_MS) {
+            return;
+        }
+        float dn = (lat - h->lat[last]) * NM_PER_DEG_LAT;
+        float de = wrap_lon_delta(lon - h->lon[last]) * s_nm_per_deg_lon;
+        if (dn * dn + de * de < TRACK_HISTORY_MIN_DIST_NM * TRACK_HISTORY_MIN_DIST_NM) {
+            return;
+        }
+    }
+
+    h->lat[h->head] = lat;
+    h->lon[h->head] = lon;
+    project_point(lat, lon, &h->screen[h->head]);
+    h->head = (uint8_t)((h->head + 1) % TRACK_HISTORY_POINTS);
+    if (h->count < TRACK_HISTORY_POINTS) {
+        h->count++;
+    }
+    h->last_ms = now;
+}
+
+// Recompute every track and trail after a home or radius change and
+// publish straight away, so a zoom step is drawn on the next frame
+// instead of after the next projection step
+static void reproject_all(void)
+{
+    if (s_mutex == NULL) {
+        update_home_terms();
+        return;  // Nothing stored yet
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    update_home_terms();
+    int touched = 0;
+    for (int w = 0; w < ACTIVE_WORDS(s_capacity); w++) {
+        uint32_t bits = s_tracks.active_bits[w];
+        while (bits != 0) {
+            int i = w * 32 + __builtin_ctz(bits);
+            bits &= bits - 1;
+            s_touched[touched++] = i;
+
+            track_history_t *h = &s_tracks.history[i];
+            for (int p = 0; p < h->count; p++) {
+                int k = (h->head + TRACK_HISTORY_POINTS - 1 - p) % TRACK_HISTORY_POINTS;
+                project_point(h->lat[k], h->lon[k], &h->screen[k]);
+            }
+        }
+    }
+    project_screen(s_touched, touched);
+    publish_snapshot();
+    xSemaphoreGive(s_mutex);
+}
+
+static void update_home_terms(void)
+{
+    float home_lat_rad = s_home_lat * DEG_TO_RAD;
+    s_home_cos_lat = cosf(home_lat_rad);
+    s_home_sin_lat = sinf(home_lat_rad);
+    s_nm_per_deg_lon = NM_PER_DEG_LAT * s_home_cos_lat;
+    s_pixels_per_nm = (float)RADAR_DISPLAY_RADIUS / (float)s_radar_radius_nm;
+    s_px_per_nm_q16 = (q16_t)(((int64_t)RADAR_DISPLAY_RADIUS << 16) / s_radar_radius_nm);
+}
+
+// Longitude difference folded into -180..180 (tracks across the antimeridian)
+static float wrap_lon_delta(float dlon)
+{
+    if (dlon > 180.0f) {
+        return dlon - 360.0f;
+    }
+    if (dlon < -180.0f) {
+        return dlon + 360.0f;
+    }
+    return dlon;
+}
+
+#if RADAR_PROJECTION == PROJECTION_TANGENT_PLANE
+// East/north offset from home in NM on the local tangent plane. The east
+// scale uses the mid latitude (first-order around home). Meridian
+// convergence is ignored, so bearings drift by up to ~0.3° (under 2 px)
+// at 50 NM, in exchange for no per-track trig.
+static void tangent_offset(float lat, float lon, float *out_east_nm, float *out_north_nm)
+{
+    float dlat = lat - s_home_lat;
+    float mid_cos = s_home_cos_lat - s_home_sin_lat * (dlat * 0.5f * DEG_TO_RAD);
+    *out_north_nm = dlat * NM_PER_DEG_LAT;
+    *out_east_nm = wrap_lon_delta(lon - s_home_lon) * NM_PER_DEG_LAT * mid_cos;
+}
+#endif
+
+static float distance_from_home_nm(float lat, float lon)
+{
+#if RADAR_PROJECTION == PROJECTION_TANGENT_PLANE
+    float east_nm, north_nm;
+    tangent_offset(lat, lon, &east_nm, &north_nm);
+    return sqrtf(east_nm * east_nm + north_nm * north_nm);
+#else
+    return haversine_distance_nm(lat, lon);
+#endif
+}
 
-    float lat1_rad = lat1 * M_PI / 180.0f;
-    float lat2_rad = lat2 * M_PI / 180.0f;
-    float dlat = (lat2 - lat1) * M_PI / 180.0f;
-    float dlon = (lon2 - lon1) * M_PI / 180.0f;
+#if RADAR_PROJECTION == PROJECTION_GREAT_CIRCLE
+static float haversine_distance_nm(float lat, float lon)
+{
+    // Haversine formula for great circle distance from home
+    // Returns distance in nautical miles
+
+    float lat_rad = lat * DEG_TO_RAD;
+    float dlat = (lat - s_home_lat) * DEG_TO_RAD;
+    float dlon = wrap_lon_delta(lon - s_home_lon) * DEG_TO_RAD;
 
     float a = sinf(dlat / 2.0f) * sinf(dlat / 2.0f) +
-              cosf(lat1_rad) * cosf(lat2_rad) *
+              s_home_cos_lat * cosf(lat_rad) *
               sinf(dlon / 2.0f) * sinf(dlon / 2.0f);
 
     float c = 2.0f * atan2f(sqrtf(a), sqrtf(1.0f - a));
 
-    return R_NM * c;
+    return EARTH_RADIUS_NM * c;
 }
 
-static float calculate_bearing(float lat1, float lon1, float lat2, float lon2)
+static float calculate_bearing(float lat, float lon)
 {
-    // Calculate true bearing (0-360 degrees, 0 = North)
+    // Calculate true bearing from home (0-360 degrees, 0 = North)
 
-    float lat1_rad = lat1 * M_PI / 180.0f;
-    float lat2_rad = lat2 * M_PI / 180.0f;
-    float dlon_rad = (lon2 - lon1) * M_PI / 180.0f;
+    float lat_rad = lat * DEG_TO_RAD;
+    float dlon_rad = wrap_lon_delta(lon - s_home_lon) * DEG_TO_RAD;
+    float cos_lat = cosf(lat_rad);
 
-    float y = sinf(dlon_rad) * cosf(lat2_rad);
-    float x = cosf(lat1_rad) * sinf(lat2_rad) -
-              sinf(lat1_rad) * cosf(lat2_rad) * cosf(dlon_rad);
+    float y = sinf(dlon_rad) * cos_lat;
+    float x = s_home_cos_lat * sinf(lat_rad) -
+              s_home_sin_lat * cos_lat * cosf(dlon_rad);
 
     float bearing_rad = atan2f(y, x);
     float bearing_deg = bearing_rad * 180.0f / M_PI;
@@ -270,21 +894,16 @@ static void polar_to_screen(float distance_nm, float bearing_deg, int *out_x, in
     // Bearing: 0° = North, increases clockwise
     // Screen: (0,0) = top-left, X right, Y down
 
-    // Pixels per nautical mile (using runtime radar radius)
-    const float pixels_per_nm = (float)RADAR_DISPLAY_RADIUS / (float)s_radar_radius_nm;
-
-    // Calculate radius in pixels
-    float radius_px = distance_nm * pixels_per_nm;
-
-    // Convert bearing to radians and adjust for screen coords
-    // Subtract 90° to rotate North to top, then negate for clockwise
-    float angle_rad = (bearing_deg - 90.0f) * M_PI / 180.0f;
+    // Calculate radius in pixels (scale cached for the runtime radar radius),
+    // capped to what Q16 holds; anything that far is off screen anyway
+    float radius_px = fminf(distance_nm * s_pixels_per_nm, 32767.0f);
 
-    // Calculate screen position relative to center
-    int dx = (int)(radius_px * cosf(angle_rad));
-    int dy = (int)(radius_px * sinf(angle_rad));
+    // Screen position relative to center from the sine table
+    int dx, dy;
+    radar_math_polar(Q16_FROM_FLOAT(radius_px), radar_math_decideg(bearing_deg), &dx, &dy);
 
     // Convert to absolute screen coordinates
     *out_x = SCREEN_CENTER_X + dx;
     *out_y = SCREEN_CENTER_Y + dy;
 }
+#endif
@@ -8,60 +8,100 @@
 #include <stdbool.h>
 #include <stdint.h>
 
-// Maximum aircraft to track
-#define MAX_AIRCRAFT 64
+// Smallest capacity accepted by aircraft_store_init()
+// (upper bound is RADAR_MAX_AIRCRAFT_LIMIT in radar_config.h)
+#define AIRCRAFT_STORE_MIN_CAPACITY 16
 
 // Aircraft timeout (60 seconds without update)
 #define AIRCRAFT_TIMEOUT_MS 60000
 
+// One past fix in screen space (see tracked_aircraft_t.trail)
+typedef struct {
+    int16_t x;
+    int16_t y;
+} aircraft_trail_point_t;
+
 // Tracked aircraft with computed radar coordinates
+// Layout of published snapshots; the store keeps its working set as
+// per-field columns internally and assembles these when publishing.
 typedef struct {
     // Raw ADSB data
     char hex[8];           // ICAO hex code
     char callsign[12];     // Flight callsign
-    float lat;             // Latitude
-    float lon;             // Longitude
+    uint32_t icao;         // ICAO address as integer key (see icao_index.h)
+    float lat;             // Latitude (dead-reckoned between fixes)
+    float lon;             // Longitude (dead-reckoned between fixes)
     int altitude;          // Altitude in feet
     float speed;           // Ground speed in knots
     float track;           // Heading in degrees
 
-    // Computed radar position
+    // Computed radar position (bearing on demand: aircraft_store_bearing_deg())
     float distance_nm;     // Distance from home in nautical miles
-    float bearing_deg;     // True bearing from home (0-360)
     int screen_x;          // Screen X coordinate (pixels)
     int screen_y;          // Screen Y coordinate (pixels)
+    const aircraft_trail_point_t *trail;  // Past fixes, oldest first (valid with the snapshot)
+    int trail_count;       // Entries in trail (0..TRACK_HISTORY_POINTS)
 
     // Metadata
-    uint32_t last_seen_ms; // Last update time (FreeRTOS ticks)
+    uint32_t last_seen_ms; // When the current fix arrived (ms since boot)
     bool active;           // Active in store
     bool has_position;     // Valid lat/lon
 } tracked_aircraft_t;
 
+// Read-only published view of the store
+// Obtained with aircraft_store_acquire_snapshot(), never blocks the writer.
+// Only tracks within the radar radius are published; the store keeps the
+// rest so zooming back out needs no new fetch.
+typedef struct {
+    uint32_t generation;                 // Increments each time a new view is published
+    int count;                           // Aircraft within the radar radius (see below)
+    const tracked_aircraft_t *aircraft;  // Active aircraft (valid until released)
+} aircraft_snapshot_t;
+
 /**
  * @brief Initialize aircraft store
+ * Hot per-track fields are allocated in internal RAM; strings and the
+ * published snapshots live in PSRAM. When the store is full, new aircraft
+ * replace the farthest / longest-unseen track instead of being dropped.
+ * @param capacity Maximum aircraft to track (clamped to
+ *                 AIRCRAFT_STORE_MIN_CAPACITY..RADAR_MAX_AIRCRAFT_LIMIT)
+ * @return true on success
  */
-void aircraft_store_init(void);
+bool aircraft_store_init(int capacity);
+
+/**
+ * @brief Get the capacity chosen at init
+ * The renderer sizes its blip pool from this so all layers share one limit.
+ * @return Maximum number of tracked aircraft (0 before init)
+ */
+int aircraft_store_get_capacity(void);
 
 /**
  * @brief Set home location for distance/bearing calculations
+ * Home-derived trig terms are cached here, not recomputed per aircraft.
  * @param lat Home latitude in decimal degrees (-90 to +90)
  * @param lon Home longitude in decimal degrees (-180 to +180)
  */
 void aircraft_store_set_home_location(float lat, float lon);
 
 /**
- * @brief Set radar radius for pixel scaling
+ * @brief Set radar radius for pixel scaling and the published view
+ * Re-projects every stored track and publishes a new snapshot at once,
+ * so the renderer can show a zoom change on its next frame.
  * @param radius_nm Radar radius in nautical miles
  */
 void aircraft_store_set_radar_radius(int radius_nm);
 
 /**
  * @brief Update aircraft from ADSB data
- * Computes distance, bearing, and screen coordinates
+ * Computes distance and screen coordinates. Reports identical to the
+ * stored fix only refresh the track's liveness: no projection, and no new
+ * snapshot if nothing else in the batch changed.
  * @param aircraft Array of ADSB aircraft
  * @param count Number of aircraft
+ * @return Tracks created or moved by this batch
  */
-void aircraft_store_update(const void *aircraft, int count);
+int aircraft_store_update(const void *aircraft, int count);
 
 /**
  * @brief Prune stale aircraft (>60s old)
@@ -70,14 +110,55 @@ void aircraft_store_update(const void *aircraft, int count);
 int aircraft_store_prune(void);
 
 /**
- * @brief Get all active aircraft for rendering
- * @param out_aircraft Output array (must hold MAX_AIRCRAFT)
+ * @brief Advance every track to its dead-reckoned position and publish
+ * Called at a fixed rate (DEAD_RECKONING_STEP_MS) between ADSB polls so
+ * blips move continuously. After a real fix arrives the blip blends from
+ * its projected position to the reported track over DEAD_RECKONING_BLEND_MS.
+ */
+void aircraft_store_project(void);
+
+/**
+ * @brief Acquire the latest published snapshot
+ * Lock-free; the snapshot stays consistent and unmodified until released.
+ * Every acquire must be paired with aircraft_store_release_snapshot().
+ * @return Snapshot (never NULL once the store is initialized)
+ */
+const aircraft_snapshot_t *aircraft_store_acquire_snapshot(void);
+
+/**
+ * @brief Release a snapshot obtained from aircraft_store_acquire_snapshot()
+ * @param snapshot Snapshot to release
+ */
+void aircraft_store_release_snapshot(const aircraft_snapshot_t *snapshot);
+
+/**
+ * @brief Get generation number of the latest published snapshot
+ * Consumers can compare against the last generation they processed
+ * and skip work when nothing changed.
+ * @return Current generation
+ */
+uint32_t aircraft_store_get_generation(void);
+
+/**
+ * @brief Get all active aircraft for rendering (copies the latest snapshot)
+ * Compatibility view for callers that want their own array-of-structs copy.
+ * Trails live in the snapshot, so copies come back without them.
+ * @param out_aircraft Output array (must hold aircraft_store_get_capacity() entries)
  * @return Number of active aircraft
  */
 int aircraft_store_get_all(tracked_aircraft_t *out_aircraft);
 
 /**
  * @brief Get number of active aircraft
- * @return Active aircraft count
+ * @return Active aircraft count (all stored tracks, not just those in view)
  */
 int aircraft_store_get_count(void);
+
+/**
+ * @brief True bearing from home to an aircraft
+ * Not kept per track; computed from the aircraft position when needed
+ * (labels, detail views) using the RADAR_PROJECTION model.
+ * @param aircraft Aircraft from a snapshot
+ * @return Bearing in degrees (0-360, 0 = North)
+ */
+float aircraft_store_bearing_deg(const tracked_aircraft_t *aircraft);
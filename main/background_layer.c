@@ -0,0 +1,282 @@
+/*
+ * Radar Background Layer Implementation
+ *
+ * Everything that only changes when the title or radius changes is drawn
+ * once into an opaque native-format canvas in PSRAM. The canvas covers the
+ * whole container, so LVGL starts each refresh from it and the container
+ * and screen backgrounds are never drawn; redrawing a dirty area costs one
+ * image copy instead of re-rendering three arcs and seventeen labels.
+ *
+ * Each zoom range gets its own baked image, allocated the first time the
+ * range is shown (RADAR_ZOOM_MAX_LEVELS at most, least recently used
+ * re-baked if PSRAM runs out), so switching range swaps the canvas
+ * buffer instead of re-baking.
+ */
+
+#include "background_layer.h"
+#include "radar_config.h"
+#include "esp_log.h"
+#include "mem_budget.h"
+#include "esp_heap_caps.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+static const char *TAG = "background_layer";
+
+#define CARDINAL_INSET 30         // Cardinal markers sit this far inside the outer ring
+#define RING_LABEL_OFFSET 12      // Ring labels sit this far outside their ring
+
+typedef struct {
+    int radius_px;                // Ring radius on screen
+    int nominal_nm;               // Distance at the default RADAR_RADIUS_NM
+    int width;
+    lv_opa_t opa;
+} ring_def_t;
+
+static const ring_def_t RINGS[3] = {
+    {RING_10NM_RADIUS, 10, 2, LV_OPA_50},
+    {RING_25NM_RADIUS, 25, 2, LV_OPA_50},
+    {RING_50NM_RADIUS, 50, 3, LV_OPA_60},
+};
+
+// One baked image per range
+typedef struct {
+    lv_draw_buf_t buf;
+    int radius_nm;                // Range baked into buf (0 = not baked)
+    bool stale;                   // Title changed since it was baked
+    uint32_t used_ms;             // Last shown
+} baked_range_t;
+
+static lv_obj_t *s_canvas = NULL;
+static baked_range_t s_cache[RADAR_ZOOM_MAX_LEVELS];
+static int s_cache_slots = 0;     // Slots with a buffer
+static baked_range_t *s_shown = NULL;
+static char s_title[32] = "";
+static int s_radius_nm = RADAR_RADIUS_NM;
+
+// Forward declarations
+static bool alloc_slot(baked_range_t *slot);
+static void show_range(int radius_nm);
+static void bake(void);
+static void draw_text(lv_layer_t *layer, lv_draw_label_dsc_t *dsc, const char *text,
+                      int32_t x, int32_t y, bool centered);
+
+bool background_layer_init(lv_obj_t *parent, const char *title, int radius_nm)
+{
+    if (parent == NULL) {
+        return false;
+    }
+
+    if (!alloc_slot(&s_cache[0])) {
+        return false;
+    }
+    s_cache_slots = 1;
+
+    s_canvas = lv_canvas_create(parent);
+    lv_canvas_set_draw_buf(s_canvas, &s_cache[0].buf);
+    s_shown = &s_cache[0];
+    lv_obj_set_pos(s_canvas, 0, 0);
+    lv_obj_clear_flag(s_canvas, LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_move_background(s_canvas);
+
+    if (title != NULL) {
+        strncpy(s_title, title, sizeof(s_title) - 1);
+        s_title[sizeof(s_title) - 1] = '\0';
+    }
+    show_range(radius_nm > 0 ? radius_nm : RADAR_RADIUS_NM);
+
+    ESP_LOGI(TAG, "Background layer created (%lu KB in PSRAM per range, up to %d ranges)",
+             (unsigned long)(s_cache[0].buf.data_size / 1024), RADAR_ZOOM_MAX_LEVELS);
+    return true;
+}
+
+void background_layer_set_title(const char *title)
+{
+    if (title == NULL || strncmp(title, s_title, sizeof(s_title) - 1) == 0) {
+        return;
+    }
+    strncpy(s_title, title, sizeof(s_title) - 1);
+    s_title[sizeof(s_title) - 1] = '\0';
+
+    // Every cached range shows the title: re-bake the visible one now and
+    // the others when they are next shown
+    for (int i = 0; i < s_cache_slots; i++) {
+        s_cache[i].stale = true;
+    }
+    if (s_canvas != NULL) {
+        show_range(s_radius_nm);
+    }
+}
+
+void background_layer_set_radius(int radius_nm)
+{
+    if (radius_nm <= 0 || radius_nm == s_radius_nm) {
+        return;
+    }
+
+    if (s_canvas != NULL) {
+        show_range(radius_nm);
+    } else {
+        s_radius_nm = radius_nm;
+    }
+}
+
+// Internal functions
+
+static bool alloc_slot(baked_range_t *slot)
+{
+    uint32_t stride = lv_draw_buf_width_to_stride(SCREEN_SIZE, LV_COLOR_FORMAT_NATIVE);
+    uint32_t size = stride * SCREEN_SIZE;
+    void *data = mem_budget_aligned_calloc(MEM_TAG_RENDER, LV_DRAW_BUF_ALIGN, 1, size, MALLOC_CAP_SPIRAM);
+    if (data == NULL) {
+        ESP_LOGW(TAG, "Failed to allocate background buffer (%lu bytes)", (unsigned long)size);
+        return false;
+    }
+    if (lv_draw_buf_init(&slot->buf, SCREEN_SIZE, SCREEN_SIZE, LV_COLOR_FORMAT_NATIVE,
+                         stride, data, size) != LV_RESULT_OK) {
+        ESP_LOGE(TAG, "Failed to initialize background buffer");
+        mem_budget_free(MEM_TAG_RENDER, data);
+        return false;
+    }
+    slot->radius_nm = 0;
+    slot->stale = false;
+    slot->used_ms = 0;
+    return true;
+}
+
+// Point the canvas at the image for a range, baking it only if this range
+// has no cached image yet or the title changed since
+static void show_range(int radius_nm)
+{
+    baked_range_t *slot = NULL;
+    for (int i = 0; i < s_cache_slots && slot == NULL; i++) {
+        if (s_cache[i].radius_nm == radius_nm) {
+            slot = &s_cache[i];
+        }
+    }
+    if (slot == NULL && s_cache_slots < RADAR_ZOOM_MAX_LEVELS && alloc_slot(&s_cache[s_cache_slots])) {
+        slot = &s_cache[s_cache_slots++];
+    }
+    if (slot == NULL) {
+        // Out of slots or memory: re-bake the least recently shown range
+        slot = &s_cache[0];
+        for (int i = 1; i < s_cache_slots; i++) {
+            if (s_cache[i].used_ms < slot->used_ms) {
+                slot = &s_cache[i];
+            }
+        }
+    }
+
+    s_radius_nm = radius_nm;
+    if (slot != s_shown) {
+        lv_canvas_set_draw_buf(s_canvas, &slot->buf);
+        s_shown = slot;
+    }
+    if (slot->radius_nm != radius_nm || slot->stale) {
+        slot->radius_nm = radius_nm;
+        slot->stale = false;
+        bake();
+    } else {
+        lv_obj_invalidate(s_canvas);
+    }
+    slot->used_ms = esp_log_timestamp();
+}
+
+// Bake the title and s_radius_nm into the canvas's current buffer
+static void bake(void)
+{
+    uint32_t start = esp_log_timestamp();
+
+    lv_canvas_fill_bg(s_canvas,
+                      lv_color_make(COLOR_BACKGROUND_R, COLOR_BACKGROUND_G, COLOR_BACKGROUND_B),
+                      LV_OPA_COVER);
+
+    lv_layer_t layer;
+    lv_canvas_init_layer(s_canvas, &layer);
+
+    // Distance rings
+    lv_draw_arc_dsc_t arc_dsc;
+    lv_draw_arc_dsc_init(&arc_dsc);
+    arc_dsc.color = lv_color_make(COLOR_RING_R, COLOR_RING_G, COLOR_RING_B);
+    arc_dsc.center.x = SCREEN_CENTER_X;
+    arc_dsc.center.y = SCREEN_CENTER_Y;
+    arc_dsc.start_angle = 0;
+    arc_dsc.end_angle = 360;
+    for (int ring = 0; ring < 3; ring++) {
+        arc_dsc.radius = RINGS[ring].radius_px;
+        arc_dsc.width = RINGS[ring].width;
+        arc_dsc.opa = RINGS[ring].opa;
+        lv_draw_arc(&layer, &arc_dsc);
+    }
+
+    lv_draw_label_dsc_t label_dsc;
+    lv_draw_label_dsc_init(&label_dsc);
+    label_dsc.color = lv_color_make(0xAA, 0xAA, 0xAA);
+    label_dsc.text_local = 1;
+
+    // Ring labels on the diagonals, scaled to the current radius
+    static const float LABEL_BEARINGS[4] = {45.0f, 135.0f, 225.0f, 315.0f};
+    label_dsc.font = &lv_font_montserrat_12;
+    for (int ring = 0; ring < 3; ring++) {
+        float nm = (float)RINGS[ring].nominal_nm * s_radius_nm / RADAR_RADIUS_NM;
+        char text[12];
+        if (fabsf(nm - roundf(nm)) < 0.05f) {
+            snprintf(text, sizeof(text), "%dnm", (int)roundf(nm));
+        } else {
+            snprintf(text, sizeof(text), "%.1fnm", nm);
+        }
+
+        int label_radius = RINGS[ring].radius_px + RING_LABEL_OFFSET;
+        for (int pos = 0; pos < 4; pos++) {
+            float rad = LABEL_BEARINGS[pos] * (float)M_PI / 180.0f;
+            int x = SCREEN_CENTER_X + (int)(label_radius * sinf(rad));
+            int y = SCREEN_CENTER_Y - (int)(label_radius * cosf(rad));
+            draw_text(&layer, &label_dsc, text, x, y, true);
+        }
+    }
+
+    // Cardinal markers just inside the outer ring
+    static const char *CARDINALS[4] = {"N", "E", "S", "W"};
+    const int cardinal_radius = RING_50NM_RADIUS - CARDINAL_INSET;
+    label_dsc.font = &lv_font_montserrat_16;
+    for (int i = 0; i < 4; i++) {
+        float rad = (float)(i * 90) * (float)M_PI / 180.0f;
+        int x = SCREEN_CENTER_X + (int)(cardinal_radius * sinf(rad));
+        int y = SCREEN_CENTER_Y - (int)(cardinal_radius * cosf(rad));
+        draw_text(&layer, &label_dsc, CARDINALS[i], x - 8, y - 8, false);
+    }
+
+    // Title at the top
+    label_dsc.color = lv_color_make(COLOR_SWEEP_R, COLOR_SWEEP_G, COLOR_SWEEP_B);
+    lv_point_t size;
+    lv_text_get_size(&size, s_title, label_dsc.font, 0, 0, LV_COORD_MAX, LV_TEXT_FLAG_NONE);
+    draw_text(&layer, &label_dsc, s_title, (SCREEN_SIZE - size.x) / 2, 20, false);
+
+    lv_canvas_finish_layer(s_canvas, &layer);
+    lv_obj_invalidate(s_canvas);
+
+    ESP_LOGI(TAG, "Background baked (\"%s\", %d NM) in %lu ms",
+             s_title, s_radius_nm, (unsigned long)(esp_log_timestamp() - start));
+}
+
+// Draw text with its top-left corner (or centre) at x, y
+static void draw_text(lv_layer_t *layer, lv_draw_label_dsc_t *dsc, const char *text,
+                      int32_t x, int32_t y, bool centered)
+{
+    if (text[0] == '\0') {
+        return;
+    }
+
+    lv_point_t size;
+    lv_text_get_size(&size, text, dsc->font, 0, 0, LV_COORD_MAX, LV_TEXT_FLAG_NONE);
+    if (centered) {
+        x -= size.x / 2;
+        y -= size.y / 2;
+    }
+
+    lv_area_t area;
+    lv_area_set(&area, x, y, x + size.x - 1, y + size.y - 1);
+    dsc->text = text;
+    lv_draw_label(layer, dsc, &area);
+}
@@ -0,0 +1,36 @@
+/*
+ * Radar Background Layer
+ * Bakes the static scope (rings, ring labels, cardinal markers, title)
+ * into one cached image that is blitted under the dynamic layers
+ */
+
+#pragma once
+
+#include "lvgl.h"
+#include <stdbool.h>
+
+/**
+ * @brief Create the background image and bake it once
+ * Must be the first child of the radar container so it is drawn first.
+ * @param parent Radar container
+ * @param title Title text shown at the top
+ * @param radius_nm Radar radius used for the ring labels
+ * @return true on success
+ */
+bool background_layer_init(lv_obj_t *parent, const char *title, int radius_nm);
+
+/**
+ * @brief Change the title text (re-bakes if it changed)
+ * Must be called with the LVGL lock held.
+ * @param title Title text
+ */
+void background_layer_set_title(const char *title);
+
+/**
+ * @brief Change the radar radius shown on the ring labels
+ * Shows the image baked earlier for this radius if there is one, so a
+ * zoom step costs a single redraw; bakes it otherwise.
+ * Must be called with the LVGL lock held.
+ * @param radius_nm Radar radius in nautical miles
+ */
+void background_layer_set_radius(int radius_nm);
@@ -0,0 +1,424 @@
+/*
+ * Benchmark Mode Implementation
+ *
+ * Each phase reseeds the generator, spawns its aircraft count around home
+ * and feeds the store in parser-sized batches at a fixed interval. After a
+ * warm-up the perf_stats histograms are reset and the phase is measured;
+ * the same seed and count always produce the same traffic, so results from
+ * different firmware builds are directly comparable.
+ */
+
+#include "benchmark.h"
+#include "sdkconfig.h"
+
+#ifdef CONFIG_RADAR_BENCHMARK
+
+#include "adsb_client.h"
+#include "aircraft_store.h"
+#include "mem_budget.h"
+#include "perf_stats.h"
+#include "radar_config.h"
+#include "task_layout.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "benchmark";
+
+#define BENCHMARK_BATCH_SIZE 32         // Same batch size the streaming parser emits
+#define BENCHMARK_WARMUP_MS 5000        // Discarded at the start of each phase
+#define BENCHMARK_MAX_PHASES 8
+#define BENCHMARK_GROUND_PERCENT 5      // Share of tracks spawned on the ground
+#define BENCHMARK_MAX_ALTITUDE 40000
+#define BENCHMARK_ICAO_BASE 0xB00000    // First synthetic ICAO address of a phase
+
+#define NM_PER_DEG_LAT 60.0f
+#define DEG_TO_RAD (3.14159265f / 180.0f)
+
+// Synthetic track (generator state, not the store's copy)
+typedef struct {
+    float lat;
+    float lon;
+    float speed;           // Knots
+    float track;           // Degrees
+    float turn_dps;        // Degrees per second, signed
+    int altitude;
+    uint32_t serial;       // Becomes the ICAO address
+} synth_track_t;
+
+typedef struct {
+    int count;
+    int stored;            // Active tracks in the store at the end of the phase
+    float fps;
+    perf_summary_t refresh;
+    perf_summary_t interval;
+    perf_summary_t apply;
+    perf_summary_t store;
+    int cpu_percent[portNUM_PROCESSORS];  // -1 without FreeRTOS run time stats
+    uint32_t internal_peak_kb;
+    uint32_t psram_peak_kb;
+    uint32_t stack_free;
+} phase_result_t;
+
+static int s_phase_counts[BENCHMARK_MAX_PHASES];
+static int s_phase_total = 0;
+static phase_result_t s_results[BENCHMARK_MAX_PHASES];
+
+static synth_track_t *s_tracks = NULL;
+static int s_track_count = 0;
+static uint32_t s_next_serial = 0;
+static float s_churn_due = 0.0f;
+static uint32_t s_rng = 1;
+
+static float s_home_lat = HOME_LAT;
+static float s_home_lon = HOME_LON;
+static int s_radius_nm = RADAR_RADIUS_NM;
+
+static adsb_aircraft_t s_batch[BENCHMARK_BATCH_SIZE];
+
+// Forward declarations
+static void parse_counts(void);
+static int max_count(void);
+static float rand_unit(void);
+static float rand_range(float lo, float hi);
+static void spawn(synth_track_t *t);
+static void step(float dt_s);
+static void feed(void);
+static void run_for(uint32_t duration_ms, TickType_t *last_wake);
+static void run_phase(int phase, TickType_t *last_wake);
+static void log_phase(const phase_result_t *r);
+static void log_summary(void);
+static void benchmark_task(void *arg);
+
+bool benchmark_enabled(void)
+{
+    return true;
+}
+
+int benchmark_store_capacity(void)
+{
+    parse_counts();
+
+    // Churned-out tracks stay in the store until they time out
+    int largest = max_count();
+    int stale = (int)ceilf(largest * CONFIG_RADAR_BENCHMARK_CHURN_PERCENT / 100.0f *
+                           (AIRCRAFT_TIMEOUT_MS / 60000.0f));
+    int capacity = largest + stale;
+    return capacity < RADAR_MAX_AIRCRAFT_LIMIT ? capacity : RADAR_MAX_AIRCRAFT_LIMIT;
+}
+
+bool benchmark_start(float home_lat, float home_lon, int radius_nm)
+{
+    parse_counts();
+    if (s_phase_total == 0) {
+        ESP_LOGE(TAG, "No valid aircraft counts in \"%s\"", CONFIG_RADAR_BENCHMARK_COUNTS);
+        return false;
+    }
+
+    s_home_lat = home_lat;
+    s_home_lon = home_lon;
+    s_radius_nm = radius_nm;
+
+    // Counted under adsb: the synthetic feed stands in for the API client
+    s_tracks = mem_budget_calloc(MEM_TAG_ADSB, max_count(), sizeof(synth_track_t), MALLOC_CAP_SPIRAM);
+    if (s_tracks == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate %d synthetic tracks", max_count());
+        return false;
+    }
+
+    // Per-track store logs would otherwise land in the measurement
+    esp_log_level_set("aircraft_store", ESP_LOG_WARN);
+
+    if (!task_layout_create(&TASK_LAYOUT_POLL, benchmark_task, NULL, NULL)) {
+        mem_budget_free(MEM_TAG_ADSB, s_tracks);
+        s_tracks = NULL;
+        return false;
+    }
+
+    ESP_LOGI(TAG, "Benchmark: counts \"%s\", %d s per phase, seed %d, feed every %d ms, churn %d%%/min",
+             CONFIG_RADAR_BENCHMARK_COUNTS, CONFIG_RADAR_BENCHMARK_PHASE_S,
+             CONFIG_RADAR_BENCHMARK_SEED, CONFIG_RADAR_BENCHMARK_UPDATE_MS,
+             CONFIG_RADAR_BENCHMARK_CHURN_PERCENT);
+    return true;
+}
+
+// Internal functions
+
+static void parse_counts(void)
+{
+    if (s_phase_total > 0) {
+        return;
+    }
+
+    const char *p = CONFIG_RADAR_BENCHMARK_COUNTS;
+    while (*p != '\0' && s_phase_total < BENCHMARK_MAX_PHASES) {
+        char *end;
+        long value = strtol(p, &end, 10);
+        if (end == p) {
+            p++;  // Skip separators
+            continue;
+        }
+        if (value > 0) {
+            s_phase_counts[s_phase_total++] = value < RADAR_MAX_AIRCRAFT_LIMIT ?
+                                              (int)value : RADAR_MAX_AIRCRAFT_LIMIT;
+        }
+        p = end;
+    }
+}
+
+static int max_count(void)
+{
+    int largest = 0;
+    for (int i = 0; i < s_phase_total; i++) {
+        if (s_phase_counts[i] > largest) {
+            largest = s_phase_counts[i];
+        }
+    }
+    return largest;
+}
+
+static float rand_unit(void)
+{
+    // xorshift32: small, fast and identical on every build
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 17;
+    s_rng ^= s_rng << 5;
+    return (s_rng >> 8) / 16777216.0f;
+}
+
+static float rand_range(float lo, float hi)
+{
+    return lo + (hi - lo) * rand_unit();
+}
+
+static void spawn(synth_track_t *t)
+{
+    // Uniform over the scope disc
+    float r = s_radius_nm * sqrtf(rand_unit());
+    float theta = rand_range(0.0f, 360.0f) * DEG_TO_RAD;
+    t->lat = s_home_lat + r * cosf(theta) / NM_PER_DEG_LAT;
+    t->lon = s_home_lon + r * sinf(theta) / (NM_PER_DEG_LAT * cosf(s_home_lat * DEG_TO_RAD));
+
+    t->speed = rand_range(CONFIG_RADAR_BENCHMARK_SPEED_MIN_KT, CONFIG_RADAR_BENCHMARK_SPEED_MAX_KT);
+    t->track = rand_range(0.0f, 360.0f);
+    t->turn_dps = rand_range(-CONFIG_RADAR_BENCHMARK_TURN_RATE_DPS, CONFIG_RADAR_BENCHMARK_TURN_RATE_DPS);
+    t->altitude = (rand_unit() * 100.0f < BENCHMARK_GROUND_PERCENT) ?
+                  0 : (int)rand_range(1000.0f, BENCHMARK_MAX_ALTITUDE);
+    t->serial = s_next_serial++;
+
+    if (t->altitude == 0) {
+        t->speed = rand_range(0.0f, 25.0f);  // Taxiing
+    }
+}
+
+static void step(float dt_s)
+{
+    float cos_home = cosf(s_home_lat * DEG_TO_RAD);
+    float turn_back_nm = s_radius_nm * 1.1f;
+
+    for (int i = 0; i < s_track_count; i++) {
+        synth_track_t *t = &s_tracks[i];
+
+        t->track = fmodf(t->track + t->turn_dps * dt_s + 360.0f, 360.0f);
+        float dist_nm = t->speed * dt_s / 3600.0f;
+        t->lat += dist_nm * cosf(t->track * DEG_TO_RAD) / NM_PER_DEG_LAT;
+        t->lon += dist_nm * sinf(t->track * DEG_TO_RAD) / (NM_PER_DEG_LAT * cos_home);
+
+        // Turn back towards home shortly after leaving the scope
+        float north_nm = (t->lat - s_home_lat) * NM_PER_DEG_LAT;
+        float east_nm = (t->lon - s_home_lon) * NM_PER_DEG_LAT * cos_home;
+        if (north_nm * north_nm + east_nm * east_nm > turn_back_nm * turn_back_nm) {
+            float inbound = atan2f(-east_nm, -north_nm) / DEG_TO_RAD;
+            t->track = fmodf(inbound + rand_range(-30.0f, 30.0f) + 360.0f, 360.0f);
+        }
+    }
+
+    // Churn: replace tracks with new ICAO addresses at a steady rate
+    s_churn_due += s_track_count * CONFIG_RADAR_BENCHMARK_CHURN_PERCENT / 100.0f * dt_s / 60.0f;
+    while (s_churn_due >= 1.0f && s_track_count > 0) {
+        spawn(&s_tracks[(int)(rand_unit() * s_track_count) % s_track_count]);
+        s_churn_due -= 1.0f;
+    }
+}
+
+static void feed(void)
+{
+    int n = 0;
+    for (int i = 0; i < s_track_count; i++) {
+        const synth_track_t *t = &s_tracks[i];
+        adsb_aircraft_t *a = &s_batch[n++];
+
+        snprintf(a->hex, sizeof(a->hex), "%06lx", (unsigned long)(t->serial & 0xFFFFFF));
+        snprintf(a->callsign, sizeof(a->callsign), "BNCH%04lu", (unsigned long)(t->serial % 10000));
+        a->lat = t->lat;
+        a->lon = t->lon;
+        a->altitude = t->altitude;
+        a->speed = t->speed;
+        a->track = t->track;
+        a->has_position = true;
+
+        if (n == BENCHMARK_BATCH_SIZE) {
+            aircraft_store_update(s_batch, n);
+            n = 0;
+        }
+    }
+    if (n > 0) {
+        aircraft_store_update(s_batch, n);
+    }
+    aircraft_store_prune();
+}
+
+static void run_for(uint32_t duration_ms, TickType_t *last_wake)
+{
+    int64_t end_us = esp_timer_get_time() + (int64_t)duration_ms * 1000;
+    while (esp_timer_get_time() < end_us) {
+        vTaskDelayUntil(last_wake, pdMS_TO_TICKS(CONFIG_RADAR_BENCHMARK_UPDATE_MS));
+        step(CONFIG_RADAR_BENCHMARK_UPDATE_MS / 1000.0f);
+        feed();
+    }
+}
+
+static void run_phase(int phase, TickType_t *last_wake)
+{
+    phase_result_t *r = &s_results[phase];
+    memset(r, 0, sizeof(*r));
+    r->count = s_phase_counts[phase];
+
+    // Identical traffic for a given seed and count on every build
+    s_rng = (uint32_t)CONFIG_RADAR_BENCHMARK_SEED ^ 0x9E3779B9u;
+    s_next_serial = BENCHMARK_ICAO_BASE;
+    s_churn_due = 0.0f;
+    s_track_count = r->count;
+    for (int i = 0; i < s_track_count; i++) {
+        spawn(&s_tracks[i]);
+    }
+
+    ESP_LOGI(TAG, "Phase %d/%d: %d aircraft (warm-up %d ms)", phase + 1, s_phase_total,
+             r->count, BENCHMARK_WARMUP_MS);
+    run_for(BENCHMARK_WARMUP_MS, last_wake);
+
+    perf_stats_reset();
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+    configRUN_TIME_COUNTER_TYPE idle_start[portNUM_PROCESSORS];
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        idle_start[core] = ulTaskGetRunTimeCounter(xTaskGetIdleTaskHandleForCore(core));
+    }
+    configRUN_TIME_COUNTER_TYPE total_start = portGET_RUN_TIME_COUNTER_VALUE();
+#endif
+    int64_t start_us = esp_timer_get_time();
+
+    run_for(CONFIG_RADAR_BENCHMARK_PHASE_S * 1000, last_wake);
+
+    float elapsed_s = (esp_timer_get_time() - start_us) / 1e6f;
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+    configRUN_TIME_COUNTER_TYPE total = portGET_RUN_TIME_COUNTER_VALUE() - total_start;
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        configRUN_TIME_COUNTER_TYPE idle =
+            ulTaskGetRunTimeCounter(xTaskGetIdleTaskHandleForCore(core)) - idle_start[core];
+        r->cpu_percent[core] = total > 0 ? 100 - (int)((uint64_t)idle * 100 / total) : 0;
+        if (r->cpu_percent[core] < 0) {
+            r->cpu_percent[core] = 0;
+        }
+    }
+#else
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        r->cpu_percent[core] = -1;
+    }
+#endif
+
+    perf_stats_get(PERF_LVGL_REFRESH, &r->refresh);
+    perf_stats_get(PERF_FRAME_INTERVAL, &r->interval);
+    perf_stats_get(PERF_RENDER_APPLY, &r->apply);
+    perf_stats_get(PERF_STORE_UPDATE, &r->store);
+    r->fps = elapsed_s > 0.0f ? r->refresh.count / elapsed_s : 0.0f;
+    r->stored = aircraft_store_get_count();
+
+    // Peak use since boot (heaps never report a per-phase high-water mark)
+    r->internal_peak_kb = (heap_caps_get_total_size(MALLOC_CAP_INTERNAL) -
+                           heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL)) / 1024;
+    r->psram_peak_kb = (heap_caps_get_total_size(MALLOC_CAP_SPIRAM) -
+                        heap_caps_get_minimum_free_size(MALLOC_CAP_SPIRAM)) / 1024;
+    r->stack_free = uxTaskGetStackHighWaterMark(NULL);
+
+    log_phase(r);
+}
+
+static void log_phase(const phase_result_t *r)
+{
+    ESP_LOGI(TAG, "=== %d aircraft (%d in store): %.1f FPS ===", r->count, r->stored, r->fps);
+    ESP_LOGI(TAG, "  Frame time p50/p95/p99/max: %.1f / %.1f / %.1f / %.1f ms",
+             r->refresh.p50 / 1000.0f, r->refresh.p95 / 1000.0f,
+             r->refresh.p99 / 1000.0f, r->refresh.max / 1000.0f);
+    ESP_LOGI(TAG, "  Frame interval p99: %.1f ms, render apply p95: %lu us, store update p95: %lu us",
+             r->interval.p99 / 1000.0f, (unsigned long)r->apply.p95, (unsigned long)r->store.p95);
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        if (r->cpu_percent[core] < 0) {
+            ESP_LOGI(TAG, "  CPU core %d: n/a (enable FreeRTOS run time stats)", core);
+        } else {
+            ESP_LOGI(TAG, "  CPU core %d: %d%%", core, r->cpu_percent[core]);
+        }
+    }
+    ESP_LOGI(TAG, "  Peak heap use: internal %lu KB, PSRAM %lu KB; generator stack free %lu B",
+             (unsigned long)r->internal_peak_kb, (unsigned long)r->psram_peak_kb,
+             (unsigned long)r->stack_free);
+}
+
+static void log_summary(void)
+{
+    ESP_LOGI(TAG, "=== Benchmark summary (seed %d, %d s per phase) ===",
+             CONFIG_RADAR_BENCHMARK_SEED, CONFIG_RADAR_BENCHMARK_PHASE_S);
+    ESP_LOGI(TAG, "  count    fps  p50ms  p95ms  p99ms  cpu0  cpu1  int_KB  psram_KB");
+    for (int i = 0; i < s_phase_total; i++) {
+        const phase_result_t *r = &s_results[i];
+        ESP_LOGI(TAG, "  %5d  %5.1f  %5.1f  %5.1f  %5.1f  %3d%%  %3d%%  %6lu  %8lu",
+                 r->count, r->fps, r->refresh.p50 / 1000.0f, r->refresh.p95 / 1000.0f,
+                 r->refresh.p99 / 1000.0f, r->cpu_percent[0],
+                 portNUM_PROCESSORS > 1 ? r->cpu_percent[portNUM_PROCESSORS - 1] : -1,
+                 (unsigned long)r->internal_peak_kb, (unsigned long)r->psram_peak_kb);
+    }
+}
+
+static void benchmark_task(void *arg)
+{
+    (void)arg;
+    TickType_t last_wake = xTaskGetTickCount();
+
+    for (int phase = 0; phase < s_phase_total; phase++) {
+        run_phase(phase, &last_wake);
+    }
+    log_summary();
+
+    // Keep the last phase on screen
+    ESP_LOGI(TAG, "Benchmark complete, holding %d aircraft", s_track_count);
+    while (1) {
+        run_for(60000, &last_wake);
+    }
+}
+
+#else  // CONFIG_RADAR_BENCHMARK
+
+bool benchmark_enabled(void)
+{
+    return false;
+}
+
+int benchmark_store_capacity(void)
+{
+    return 0;
+}
+
+bool benchmark_start(float home_lat, float home_lon, int radius_nm)
+{
+    (void)home_lat;
+    (void)home_lon;
+    (void)radius_nm;
+    return false;
+}
+
+#endif  // CONFIG_RADAR_BENCHMARK
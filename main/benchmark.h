@@ -0,0 +1,34 @@
+/*
+ * Benchmark Mode
+ * Deterministic synthetic traffic fed through the normal store and render
+ * path, with per-phase FPS, frame-time, heap and CPU reports. Enabled in
+ * menuconfig under "ADSB Radar Benchmark"; runs without Wi-Fi.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+
+/**
+ * @brief Check whether this build boots into benchmark mode
+ * @return true if CONFIG_RADAR_BENCHMARK is set
+ */
+bool benchmark_enabled(void);
+
+/**
+ * @brief Largest aircraft count of any benchmark phase
+ * Pass to aircraft_store_init() so no phase is limited by the store size
+ * (includes headroom for churned tracks that have not timed out yet).
+ * @return Store capacity needed by the benchmark
+ */
+int benchmark_store_capacity(void);
+
+/**
+ * @brief Start the synthetic traffic generator and phase runner
+ * Call after the renderer is running and the store has its home location.
+ * @param home_lat Home latitude (traffic is generated around it)
+ * @param home_lon Home longitude
+ * @param radius_nm Radar radius (traffic stays mostly inside it)
+ * @return true if the benchmark task started
+ */
+bool benchmark_start(float home_lat, float home_lon, int radius_nm);
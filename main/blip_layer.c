@@ -0,0 +1,657 @@
+/*
+ * Batched Blip Layer Implementation
+ *
+ * The renderer fills a plain draw list each update and the layer's
+ * LV_EVENT_DRAW_MAIN callback turns it into lv_draw_* calls, so the
+ * number of LVGL objects no longer depends on the number of aircraft and
+ * nothing is allocated or freed per aircraft.
+ *
+ * Two lists are kept: the front list is what gets drawn, the back list is
+ * filled by the renderer. On commit the two are diffed by ICAO key and
+ * only the areas of items that changed are invalidated. Trails have
+ * their own bounds: they only change when a new fix is added, so a blip
+ * that moves between fixes doesn't redraw its whole trail.
+ *
+ * Blips live in a spatial grid keyed by a slot that stays with the
+ * aircraft while it is listed, so a commit only relinks blips that
+ * crossed a cell. Label placement uses a second grid of the labels
+ * placed so far; with bounded density each label checks a few cells,
+ * keeping the pass linear in the number of aircraft.
+ */
+
+#include "blip_layer.h"
+#include "icao_index.h"
+#include "spatial_grid.h"
+#include "radar_config.h"
+#include "esp_log.h"
+#include "mem_budget.h"
+#include "esp_heap_caps.h"
+#include <string.h>
+
+static const char *TAG = "blip_layer";
+
+// Geometry (matches the widget renderer)
+#define BLIP_HALF_SIZE (AIRCRAFT_BLIP_SIZE / 2)
+#define LABEL_OFFSET_X 6
+#define LABEL_CS_OFFSET_Y (-14)
+#define LABEL_ALT_OFFSET_Y 4
+#define SELECT_RING_HALF (BLIP_HALF_SIZE + 4)
+
+// Label spots tried around a blip (blip_draw_item_t.label_pos)
+typedef enum {
+    LABEL_RIGHT,         // Beside the blip, callsign above altitude (default)
+    LABEL_LEFT,
+    LABEL_ABOVE_RIGHT,
+    LABEL_BELOW_RIGHT,
+    LABEL_ABOVE_LEFT,
+    LABEL_BELOW_LEFT,
+    LABEL_SPOT_COUNT
+} label_spot_t;
+
+// Candidate label area being tested by label_spot_free()
+typedef struct {
+    const blip_draw_item_t *items;
+    int self;
+    lv_area_t area;
+} overlap_query_t;
+
+static lv_obj_t *s_layer = NULL;
+static const lv_font_t *s_font = &lv_font_montserrat_12;
+static int32_t s_line_height = 0;
+static int32_t s_label_height = 0;  // Top of callsign to bottom of altitude
+
+// Draw lists (front = drawn, back = being filled)
+static blip_draw_item_t *s_lists[2] = {NULL, NULL};
+static int s_counts[2] = {0, 0};
+static int s_front = 0;
+static int s_capacity = 0;
+static int s_trail_points = 0;
+static blip_point_t *s_trail_pools[2] = {NULL, NULL};
+
+// Diff support: ICAO -> position in the front list
+static icao_index_t s_front_index;
+static int16_t *s_slot_to_item = NULL;
+static bool *s_item_seen = NULL;
+static int16_t *s_prev_item = NULL;  // Back item -> matching front item (-1 = new)
+
+// Blips on screen; grid ids come from s_grid_index and stay with the aircraft
+static spatial_grid_t s_blip_grid;
+static icao_index_t s_grid_index;
+static int16_t *s_grid_item = NULL;  // Grid id -> position in the front list
+
+// Labels placed by the current commit, keyed by position in the list
+static spatial_grid_t s_label_grid;
+static int32_t s_max_label_width = 0;
+
+static uint32_t s_selected_icao = ICAO_KEY_INVALID;
+
+// Forward declarations
+static void layer_draw_cb(lv_event_t *e);
+static void measure_labels(blip_draw_item_t *item);
+static void compute_bounds(blip_draw_item_t *item);
+static void place_labels(blip_draw_item_t *items, int count, const blip_draw_item_t *prev);
+static uint8_t find_label_spot(const blip_draw_item_t *items, int self, uint8_t preferred);
+static bool label_spot_free(const blip_draw_item_t *items, int self, int spot);
+static bool blip_overlap_visit(int id, void *ctx);
+static bool label_overlap_visit(int id, void *ctx);
+static void label_area(const blip_draw_item_t *item, int spot, lv_area_t *area);
+static bool label_on_left(int spot);
+static bool items_equal(const blip_draw_item_t *a, const blip_draw_item_t *b);
+static bool trails_equal(const blip_draw_item_t *a, const blip_draw_item_t *b);
+static void *alloc_list(int count, size_t size, uint32_t caps);
+
+bool blip_layer_init(lv_obj_t *parent, int capacity, int trail_points)
+{
+    if (parent == NULL || capacity <= 0) {
+        return false;
+    }
+
+    for (int i = 0; i < 2; i++) {
+        s_lists[i] = alloc_list(capacity, sizeof(blip_draw_item_t), MALLOC_CAP_SPIRAM);
+        s_counts[i] = 0;
+        if (trail_points > 0) {
+            s_trail_pools[i] = alloc_list(capacity * trail_points, sizeof(blip_point_t), MALLOC_CAP_SPIRAM);
+            if (s_trail_pools[i] == NULL) {
+                ESP_LOGW(TAG, "No memory for trails, drawing without");
+                trail_points = 0;
+            }
+        }
+    }
+    if (s_lists[0] != NULL && s_lists[1] != NULL) {
+        for (int i = 0; i < 2; i++) {
+            for (int j = 0; j < capacity; j++) {
+                s_lists[i][j].trail = trail_points > 0 ? &s_trail_pools[i][j * trail_points] : NULL;
+            }
+        }
+    }
+    s_trail_points = trail_points;
+    s_slot_to_item = alloc_list(capacity, sizeof(int16_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    s_item_seen = alloc_list(capacity, sizeof(bool), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    s_prev_item = alloc_list(capacity, sizeof(int16_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    s_grid_item = alloc_list(capacity, sizeof(int16_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (s_lists[0] == NULL || s_lists[1] == NULL || s_slot_to_item == NULL || s_item_seen == NULL ||
+        s_prev_item == NULL || s_grid_item == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate draw lists (%d items)", capacity);
+        return false;
+    }
+    if (!icao_index_init(&s_front_index, capacity, MEM_TAG_RENDER) || !icao_index_init(&s_grid_index, capacity, MEM_TAG_RENDER)) {
+        ESP_LOGE(TAG, "Failed to allocate diff index");
+        return false;
+    }
+    if (!spatial_grid_init(&s_blip_grid, SCREEN_SIZE, SCREEN_SIZE, SPATIAL_GRID_CELL_PX, capacity, MEM_TAG_RENDER) ||
+        !spatial_grid_init(&s_label_grid, SCREEN_SIZE, SCREEN_SIZE, SPATIAL_GRID_CELL_PX, capacity, MEM_TAG_RENDER)) {
+        ESP_LOGE(TAG, "Failed to allocate spatial grids");
+        return false;
+    }
+    s_capacity = capacity;
+    s_front = 0;
+    s_line_height = lv_font_get_line_height(s_font);
+    s_label_height = LABEL_ALT_OFFSET_Y - LABEL_CS_OFFSET_Y + s_line_height;
+
+    s_layer = lv_obj_create(parent);
+    lv_obj_remove_style_all(s_layer);
+    lv_obj_set_size(s_layer, SCREEN_SIZE, SCREEN_SIZE);
+    lv_obj_set_pos(s_layer, 0, 0);
+    lv_obj_clear_flag(s_layer, LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_clear_flag(s_layer, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_add_event_cb(s_layer, layer_draw_cb, LV_EVENT_DRAW_MAIN, NULL);
+
+    ESP_LOGI(TAG, "Blip layer created (%d items, %d-point trails)", capacity, trail_points);
+    return true;
+}
+
+blip_draw_item_t *blip_layer_begin(int *out_capacity)
+{
+    if (out_capacity != NULL) {
+        *out_capacity = s_capacity;
+    }
+    return s_lists[1 - s_front];
+}
+
+void blip_layer_commit(int count)
+{
+    if (s_layer == NULL) {
+        return;
+    }
+    if (count > s_capacity) {
+        count = s_capacity;
+    }
+
+    blip_draw_item_t *prev = s_lists[s_front];
+    int prev_count = s_counts[s_front];
+    blip_draw_item_t *next = s_lists[1 - s_front];
+
+    // Index the list currently on screen
+    icao_index_clear(&s_front_index);
+    for (int j = 0; j < prev_count; j++) {
+        int slot = icao_index_insert(&s_front_index, prev[j].icao, NULL);
+        if (slot != -1) {
+            s_slot_to_item[slot] = (int16_t)j;
+        }
+        s_item_seen[j] = false;
+    }
+
+    // Match against the screen and measure labels
+    s_max_label_width = 0;
+    for (int i = 0; i < count; i++) {
+        if (next[i].trail_count > s_trail_points) {
+            next[i].trail_count = (uint8_t)s_trail_points;
+        }
+        next[i].selected = next[i].icao == s_selected_icao;
+        measure_labels(&next[i]);
+        s_max_label_width = LV_MAX(s_max_label_width, LV_MAX(next[i].cs_width, next[i].alt_width));
+
+        int slot = icao_index_find(&s_front_index, next[i].icao);
+        s_prev_item[i] = -1;
+        if (slot != -1) {
+            s_prev_item[i] = s_slot_to_item[slot];
+            s_item_seen[s_prev_item[i]] = true;
+        }
+    }
+
+    // Update the blip grid: drop departed aircraft first so their grid
+    // ids are free for arrivals, then move the rest
+    for (int j = 0; j < prev_count; j++) {
+        if (!s_item_seen[j]) {
+            spatial_grid_remove(&s_blip_grid, icao_index_remove(&s_grid_index, prev[j].icao));
+        }
+    }
+    for (int i = 0; i < count; i++) {
+        int id = icao_index_insert(&s_grid_index, next[i].icao, NULL);
+        if (id != -1) {
+            spatial_grid_move(&s_blip_grid, id, next[i].x, next[i].y);
+            s_grid_item[id] = (int16_t)i;
+        }
+    }
+
+    place_labels(next, count, prev);
+
+    // Invalidate new/moved/changed items (old and new position)
+    for (int i = 0; i < count; i++) {
+        compute_bounds(&next[i]);
+
+        int j = s_prev_item[i];
+        if (j != -1) {
+            if (!trails_equal(&prev[j], &next[i]) || prev[j].opa != next[i].opa) {
+                if (prev[j].trail_count > 1) {
+                    lv_obj_invalidate_area(s_layer, &prev[j].trail_bounds);
+                }
+                if (next[i].trail_count > 1) {
+                    lv_obj_invalidate_area(s_layer, &next[i].trail_bounds);
+                }
+            }
+            if (items_equal(&prev[j], &next[i])) {
+                continue;
+            }
+            lv_obj_invalidate_area(s_layer, &prev[j].bounds);
+        } else if (next[i].trail_count > 1) {
+            lv_obj_invalidate_area(s_layer, &next[i].trail_bounds);
+        }
+        lv_obj_invalidate_area(s_layer, &next[i].bounds);
+    }
+
+    // Invalidate items that disappeared
+    for (int j = 0; j < prev_count; j++) {
+        if (!s_item_seen[j]) {
+            lv_obj_invalidate_area(s_layer, &prev[j].bounds);
+            if (prev[j].trail_count > 1) {
+                lv_obj_invalidate_area(s_layer, &prev[j].trail_bounds);
+            }
+        }
+    }
+
+    s_counts[1 - s_front] = count;
+    s_front = 1 - s_front;
+}
+
+void blip_layer_clear(void)
+{
+    blip_layer_begin(NULL);
+    blip_layer_commit(0);
+}
+
+void blip_layer_set_visible(bool visible)
+{
+    if (s_layer == NULL) {
+        return;
+    }
+    if (visible) {
+        lv_obj_clear_flag(s_layer, LV_OBJ_FLAG_HIDDEN);
+    } else {
+        lv_obj_add_flag(s_layer, LV_OBJ_FLAG_HIDDEN);
+    }
+}
+
+int blip_layer_get_count(void)
+{
+    return s_counts[s_front];
+}
+
+const blip_draw_item_t *blip_layer_items(int *out_count)
+{
+    *out_count = s_counts[s_front];
+    return s_lists[s_front];
+}
+
+const blip_draw_item_t *blip_layer_find(uint32_t icao)
+{
+    if (s_layer == NULL) {
+        return NULL;
+    }
+    int id = icao_index_find(&s_grid_index, icao);
+    return id != -1 ? &s_lists[s_front][s_grid_item[id]] : NULL;
+}
+
+uint32_t blip_layer_hit_test(int32_t x, int32_t y)
+{
+    if (s_layer == NULL) {
+        return ICAO_KEY_INVALID;
+    }
+    int id = spatial_grid_nearest(&s_blip_grid, x, y, TOUCH_SELECT_RADIUS_PX);
+    return id != -1 ? s_lists[s_front][s_grid_item[id]].icao : ICAO_KEY_INVALID;
+}
+
+void blip_layer_select(uint32_t icao)
+{
+    s_selected_icao = icao;
+}
+
+// Internal functions
+
+static void layer_draw_cb(lv_event_t *e)
+{
+    lv_layer_t *layer = lv_event_get_layer(e);
+    const blip_draw_item_t *items = s_lists[s_front];
+    int count = s_counts[s_front];
+
+    lv_draw_rect_dsc_t blip_dsc;
+    lv_draw_rect_dsc_init(&blip_dsc);
+    blip_dsc.radius = LV_RADIUS_CIRCLE;
+
+    lv_draw_line_dsc_t vec_dsc;
+    lv_draw_line_dsc_init(&vec_dsc);
+    vec_dsc.color = lv_color_make(0x80, 0x80, 0x80);  // Light grey
+    vec_dsc.width = 1;
+
+    lv_draw_label_dsc_t label_dsc;
+    lv_draw_label_dsc_init(&label_dsc);
+    label_dsc.font = s_font;
+    label_dsc.text_local = 1;  // Draw tasks may outlive this callback
+
+    lv_draw_rect_dsc_t ring_dsc;
+    lv_draw_rect_dsc_init(&ring_dsc);
+    ring_dsc.radius = LV_RADIUS_CIRCLE;
+    ring_dsc.bg_opa = LV_OPA_TRANSP;
+    ring_dsc.border_width = 1;
+
+    lv_draw_line_dsc_t trail_dsc;
+    lv_draw_line_dsc_init(&trail_dsc);
+    trail_dsc.width = 1;
+
+    for (int i = 0; i < count; i++) {
+        const blip_draw_item_t *item = &items[i];
+
+        // Trail polyline, under everything else
+        trail_dsc.opa = LV_OPA_MIX2(LV_OPA_40, item->opa);
+        if (item->trail_count > 1 && lv_area_is_on(&item->trail_bounds, &layer->_clip_area)) {
+            trail_dsc.color = item->color;
+            for (int k = 1; k < item->trail_count; k++) {
+                trail_dsc.p1.x = item->trail[k - 1].x;
+                trail_dsc.p1.y = item->trail[k - 1].y;
+                trail_dsc.p2.x = item->trail[k].x;
+                trail_dsc.p2.y = item->trail[k].y;
+                lv_draw_line(layer, &trail_dsc);
+            }
+        }
+
+        // Skip items outside the area being redrawn
+        if (!lv_area_is_on(&item->bounds, &layer->_clip_area)) {
+            continue;
+        }
+
+        // Newest trail point to the (dead-reckoned) blip
+        if (item->trail_count > 0) {
+            const blip_point_t *last = &item->trail[item->trail_count - 1];
+            trail_dsc.color = item->color;
+            trail_dsc.p1.x = last->x;
+            trail_dsc.p1.y = last->y;
+            trail_dsc.p2.x = item->x;
+            trail_dsc.p2.y = item->y;
+            lv_draw_line(layer, &trail_dsc);
+        }
+
+        if (item->has_vector) {
+            vec_dsc.opa = LV_OPA_MIX2(LV_OPA_70, item->opa);
+            vec_dsc.p1.x = item->x;
+            vec_dsc.p1.y = item->y;
+            vec_dsc.p2.x = item->vec_x;
+            vec_dsc.p2.y = item->vec_y;
+            lv_draw_line(layer, &vec_dsc);
+        }
+
+        lv_area_t blip_area;
+        lv_area_set(&blip_area,
+                    item->x - BLIP_HALF_SIZE, item->y - BLIP_HALF_SIZE,
+                    item->x + BLIP_HALF_SIZE - 1, item->y + BLIP_HALF_SIZE - 1);
+        blip_dsc.bg_color = item->color;
+        blip_dsc.bg_opa = item->opa;
+        lv_draw_rect(layer, &blip_dsc, &blip_area);
+
+        if (item->selected) {
+            lv_area_t ring_area;
+            lv_area_set(&ring_area,
+                        item->x - SELECT_RING_HALF, item->y - SELECT_RING_HALF,
+                        item->x + SELECT_RING_HALF - 1, item->y + SELECT_RING_HALF - 1);
+            ring_dsc.border_color = item->color;
+            ring_dsc.border_opa = item->opa;
+            lv_draw_rect(layer, &ring_dsc, &ring_area);
+        }
+
+        if (item->label_pos == BLIP_LABEL_HIDDEN) {
+            continue;
+        }
+
+        // Labels on the left of the blip are right-aligned against it
+        lv_area_t block;
+        label_area(item, item->label_pos, &block);
+        bool right_align = label_on_left(item->label_pos);
+
+        label_dsc.color = item->color;
+        label_dsc.opa = item->opa;
+        if (item->callsign[0] != '\0') {
+            int32_t x1 = right_align ? block.x2 + 1 - item->cs_width : block.x1;
+            lv_area_t area;
+            lv_area_set(&area, x1, block.y1, x1 + item->cs_width - 1, block.y1 + s_line_height - 1);
+            label_dsc.text = item->callsign;
+            lv_draw_label(layer, &label_dsc, &area);
+        }
+        if (item->alt[0] != '\0') {
+            int32_t x1 = right_align ? block.x2 + 1 - item->alt_width : block.x1;
+            int32_t y1 = block.y1 + LABEL_ALT_OFFSET_Y - LABEL_CS_OFFSET_Y;
+            lv_area_t area;
+            lv_area_set(&area, x1, y1, x1 + item->alt_width - 1, y1 + s_line_height - 1);
+            label_dsc.text = item->alt;
+            lv_draw_label(layer, &label_dsc, &area);
+        }
+    }
+}
+
+// Measure labels once per update
+static void measure_labels(blip_draw_item_t *item)
+{
+    lv_point_t size;
+
+    item->cs_width = 0;
+    item->alt_width = 0;
+    if (item->callsign[0] != '\0') {
+        lv_text_get_size(&size, item->callsign, s_font, 0, 0, LV_COORD_MAX, LV_TEXT_FLAG_NONE);
+        item->cs_width = (int16_t)size.x;
+    }
+    if (item->alt[0] != '\0') {
+        lv_text_get_size(&size, item->alt, s_font, 0, 0, LV_COORD_MAX, LV_TEXT_FLAG_NONE);
+        item->alt_width = (int16_t)size.x;
+    }
+}
+
+// Drawn extent of the item, with its labels where place_labels() put them
+static void compute_bounds(blip_draw_item_t *item)
+{
+    int32_t x1 = item->x - BLIP_HALF_SIZE;
+    int32_t y1 = item->y - BLIP_HALF_SIZE;
+    int32_t x2 = item->x + BLIP_HALF_SIZE;
+    int32_t y2 = item->y + BLIP_HALF_SIZE;
+
+    if (item->has_vector) {
+        x1 = LV_MIN(x1, item->vec_x - 1);
+        y1 = LV_MIN(y1, item->vec_y - 1);
+        x2 = LV_MAX(x2, item->vec_x + 1);
+        y2 = LV_MAX(y2, item->vec_y + 1);
+    }
+
+    if (item->trail_count > 0) {
+        // Segment from the newest trail point moves with the blip
+        const blip_point_t *last = &item->trail[item->trail_count - 1];
+        x1 = LV_MIN(x1, last->x - 1);
+        y1 = LV_MIN(y1, last->y - 1);
+        x2 = LV_MAX(x2, last->x + 1);
+        y2 = LV_MAX(y2, last->y + 1);
+
+        int32_t tx1 = last->x, ty1 = last->y, tx2 = last->x, ty2 = last->y;
+        for (int k = 0; k < item->trail_count - 1; k++) {
+            tx1 = LV_MIN(tx1, item->trail[k].x);
+            ty1 = LV_MIN(ty1, item->trail[k].y);
+            tx2 = LV_MAX(tx2, item->trail[k].x);
+            ty2 = LV_MAX(ty2, item->trail[k].y);
+        }
+        lv_area_set(&item->trail_bounds, tx1 - 1, ty1 - 1, tx2 + 1, ty2 + 1);
+    }
+
+    if (item->selected) {
+        x1 = LV_MIN(x1, item->x - SELECT_RING_HALF);
+        y1 = LV_MIN(y1, item->y - SELECT_RING_HALF);
+        x2 = LV_MAX(x2, item->x + SELECT_RING_HALF);
+        y2 = LV_MAX(y2, item->y + SELECT_RING_HALF);
+    }
+
+    if (item->label_pos != BLIP_LABEL_HIDDEN) {
+        lv_area_t block;
+        label_area(item, item->label_pos, &block);
+        x1 = LV_MIN(x1, block.x1);
+        y1 = LV_MIN(y1, block.y1);
+        x2 = LV_MAX(x2, block.x2);
+        y2 = LV_MAX(y2, block.y2);
+    }
+
+    lv_area_set(&item->bounds, x1, y1, x2, y2);
+}
+
+// Greedy placement: selected aircraft, then labels already on screen
+// (trying their current spot first so they don't jump), then new labels
+static void place_labels(blip_draw_item_t *items, int count, const blip_draw_item_t *prev)
+{
+    spatial_grid_clear(&s_label_grid);
+
+    for (int i = 0; i < count; i++) {
+        bool has_label = items[i].cs_width > 0 || items[i].alt_width > 0;
+        items[i].label_pos = (has_label && !LABEL_DECLUTTER) ? LABEL_RIGHT : BLIP_LABEL_HIDDEN;
+    }
+    if (!LABEL_DECLUTTER) {
+        return;
+    }
+
+    for (int pass = 0; pass < 3; pass++) {
+        for (int i = 0; i < count; i++) {
+            blip_draw_item_t *item = &items[i];
+            if (item->cs_width == 0 && item->alt_width == 0) {
+                continue;
+            }
+            int j = s_prev_item[i];
+            uint8_t last = j != -1 ? prev[j].label_pos : BLIP_LABEL_HIDDEN;
+            int item_pass = item->selected ? 0 : (last != BLIP_LABEL_HIDDEN ? 1 : 2);
+            if (item_pass != pass) {
+                continue;
+            }
+
+            item->label_pos = find_label_spot(items, i, last);
+            if (item->label_pos == BLIP_LABEL_HIDDEN && item->selected) {
+                item->label_pos = LABEL_RIGHT;  // The selected label is always shown
+            }
+            if (item->label_pos != BLIP_LABEL_HIDDEN) {
+                lv_area_t area;
+                label_area(item, item->label_pos, &area);
+                spatial_grid_move(&s_label_grid, i, (area.x1 + area.x2) / 2, (area.y1 + area.y2) / 2);
+            }
+        }
+    }
+}
+
+static uint8_t find_label_spot(const blip_draw_item_t *items, int self, uint8_t preferred)
+{
+    if (preferred != BLIP_LABEL_HIDDEN && label_spot_free(items, self, preferred)) {
+        return preferred;
+    }
+    for (int spot = 0; spot < LABEL_SPOT_COUNT; spot++) {
+        if (spot != preferred && label_spot_free(items, self, spot)) {
+            return (uint8_t)spot;
+        }
+    }
+    return BLIP_LABEL_HIDDEN;
+}
+
+// A spot is free if it is on screen and covers no other blip or placed label
+static bool label_spot_free(const blip_draw_item_t *items, int self, int spot)
+{
+    overlap_query_t q = {.items = items, .self = self};
+    label_area(&items[self], spot, &q.area);
+    if (q.area.x1 < 0 || q.area.y1 < 0 || q.area.x2 >= SCREEN_SIZE || q.area.y2 >= SCREEN_SIZE) {
+        return false;
+    }
+
+    if (!spatial_grid_query(&s_blip_grid,
+                            q.area.x1 - BLIP_HALF_SIZE, q.area.y1 - BLIP_HALF_SIZE,
+                            q.area.x2 + BLIP_HALF_SIZE, q.area.y2 + BLIP_HALF_SIZE,
+                            blip_overlap_visit, &q)) {
+        return false;
+    }
+
+    // Labels are filed by centre: widen by half the widest label
+    int32_t reach_x = s_max_label_width / 2 + 1;
+    int32_t reach_y = s_label_height / 2 + 1;
+    return spatial_grid_query(&s_label_grid,
+                              q.area.x1 - reach_x, q.area.y1 - reach_y,
+                              q.area.x2 + reach_x, q.area.y2 + reach_y,
+                              label_overlap_visit, &q);
+}
+
+static bool blip_overlap_visit(int id, void *ctx)
+{
+    const overlap_query_t *q = ctx;
+    return s_grid_item[id] == q->self;  // Stop at any other blip
+}
+
+static bool label_overlap_visit(int id, void *ctx)
+{
+    const overlap_query_t *q = ctx;
+    const blip_draw_item_t *other = &q->items[id];
+    lv_area_t area;
+    label_area(other, other->label_pos, &area);
+    return !lv_area_is_on(&area, &q->area);
+}
+
+// Area covered by both label lines at a spot
+static void label_area(const blip_draw_item_t *item, int spot, lv_area_t *area)
+{
+    int32_t width = LV_MAX(item->cs_width, item->alt_width);
+    int32_t x1 = label_on_left(spot) ? item->x - LABEL_OFFSET_X - width : item->x + LABEL_OFFSET_X;
+    int32_t y1;
+    switch (spot) {
+        case LABEL_ABOVE_RIGHT:
+        case LABEL_ABOVE_LEFT:
+            y1 = item->y - BLIP_HALF_SIZE - s_label_height;
+            break;
+        case LABEL_BELOW_RIGHT:
+        case LABEL_BELOW_LEFT:
+            y1 = item->y + BLIP_HALF_SIZE;
+            break;
+        default:
+            y1 = item->y + LABEL_CS_OFFSET_Y;
+            break;
+    }
+    lv_area_set(area, x1, y1, x1 + width - 1, y1 + s_label_height - 1);
+}
+
+static bool label_on_left(int spot)
+{
+    return spot == LABEL_LEFT || spot == LABEL_ABOVE_LEFT || spot == LABEL_BELOW_LEFT;
+}
+
+static bool items_equal(const blip_draw_item_t *a, const blip_draw_item_t *b)
+{
+    return a->x == b->x && a->y == b->y &&
+           a->has_vector == b->has_vector &&
+           (!a->has_vector || (a->vec_x == b->vec_x && a->vec_y == b->vec_y)) &&
+           lv_color_eq(a->color, b->color) &&
+           a->opa == b->opa &&
+           strcmp(a->callsign, b->callsign) == 0 &&
+           strcmp(a->alt, b->alt) == 0 &&
+           a->label_pos == b->label_pos &&
+           a->selected == b->selected &&
+           a->trail_count == b->trail_count &&
+           (a->trail_count == 0 || memcmp(&a->trail[a->trail_count - 1], &b->trail[b->trail_count - 1],
+                                          sizeof(blip_point_t)) == 0);
+}
+
+static bool trails_equal(const blip_draw_item_t *a, const blip_draw_item_t *b)
+{
+    return a->trail_count == b->trail_count &&
+           memcmp(a->trail, b->trail, a->trail_count * sizeof(blip_point_t)) == 0;
+}
+
+static void *alloc_list(int count, size_t size, uint32_t caps)
+{
+    void *list = mem_budget_calloc(MEM_TAG_RENDER, count, size, caps);
+    if (list == NULL) {
+        list = mem_budget_calloc(MEM_TAG_RENDER, count, size, MALLOC_CAP_8BIT);
+    }
+    return list;
+}
@@ -0,0 +1,131 @@
+/*
+ * Batched Blip Layer
+ * Draws every aircraft blip, velocity vector and label from one custom
+ * LVGL draw callback instead of four LVGL objects per aircraft, with
+ * each aircraft's trail drawn as a polyline from the same callback.
+ * Blips are also kept in a spatial grid, used for tap hit-testing and to
+ * place labels where they don't overlap other labels or blips.
+ */
+
+#pragma once
+
+#include "lvgl.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// blip_draw_item_t.label_pos when no free spot was found for the label
+#define BLIP_LABEL_HIDDEN 0xFF
+
+// One trail vertex (screen pixels)
+typedef struct {
+    int16_t x;
+    int16_t y;
+} blip_point_t;
+
+// One aircraft in the draw list (filled by the renderer each update)
+typedef struct {
+    uint32_t icao;         // Aircraft key (used to diff against the last list)
+    int16_t x;             // Blip centre (screen pixels)
+    int16_t y;
+    int16_t vec_x;         // Velocity vector end point
+    int16_t vec_y;
+    bool has_vector;       // Draw velocity vector
+    lv_color_t color;      // Altitude colour
+    char callsign[12];     // Callsign label ("" = hidden)
+    char alt[8];           // Altitude label in hundreds of feet ("" = hidden)
+    blip_point_t *trail;   // Past positions, oldest first; storage is owned by
+                           // the layer (trail_points entries), fill but never reassign
+    uint8_t trail_count;   // Trail vertices in use (0 = no trail)
+    lv_opa_t opa;          // Overall opacity (PPI decay; LV_OPA_COVER otherwise)
+    uint8_t sector;        // PPI sector the item was painted in
+
+    // Filled in by blip_layer_commit()
+    int16_t cs_width;      // Measured label widths
+    int16_t alt_width;
+    lv_area_t bounds;      // Blip, labels, vector and the segment to the trail
+    lv_area_t trail_bounds;  // Trail polyline (invalidated only when it changes)
+    uint8_t label_pos;     // Label spot around the blip (BLIP_LABEL_HIDDEN = decluttered)
+    bool selected;         // Drawn with a selection ring (see blip_layer_select())
+} blip_draw_item_t;
+
+/**
+ * @brief Create the blip layer object
+ * A transparent, non-clickable full-screen child of the radar container.
+ * @param parent Radar container
+ * @param capacity Maximum number of items (store capacity)
+ * @param trail_points Trail vertices per item (0 = no trails)
+ * @return true on success
+ */
+bool blip_layer_init(lv_obj_t *parent, int capacity, int trail_points);
+
+/**
+ * @brief Get the draw list to fill for the next frame
+ * Entries [0, count) passed to blip_layer_commit() are drawn.
+ * Must be called with the LVGL lock held.
+ * @param out_capacity Number of entries available
+ * @return Writable draw list
+ */
+blip_draw_item_t *blip_layer_begin(int *out_capacity);
+
+/**
+ * @brief Publish the draw list and invalidate only what changed
+ * Items that moved, changed or disappeared invalidate their old and new
+ * bounds; unchanged items cause no redraw. Labels are placed greedily here:
+ * the selected aircraft first, then labels already on screen (keeping
+ * their spot if still free), then new ones. A label with no free spot
+ * is hidden rather than drawn over another.
+ * Must be called with the LVGL lock held.
+ * @param count Number of entries filled since blip_layer_begin()
+ */
+void blip_layer_commit(int count);
+
+/**
+ * @brief Remove all blips (e.g. when switching render mode)
+ */
+void blip_layer_clear(void);
+
+/**
+ * @brief Show or hide the layer
+ * @param visible true to draw the layer
+ */
+void blip_layer_set_visible(bool visible);
+
+/**
+ * @brief Get number of blips in the current draw list
+ * @return Item count
+ */
+int blip_layer_get_count(void);
+
+/**
+ * @brief Get the list on screen
+ * Must be called with the LVGL lock held.
+ * @param out_count Number of items
+ * @return Items as last committed
+ */
+const blip_draw_item_t *blip_layer_items(int *out_count);
+
+/**
+ * @brief Look up an aircraft in the list on screen
+ * Lets the renderer hold an item unchanged (e.g. reduced update rates).
+ * Must be called with the LVGL lock held.
+ * @param icao ICAO key
+ * @return Item as last committed, or NULL if not on screen
+ */
+const blip_draw_item_t *blip_layer_find(uint32_t icao);
+
+/**
+ * @brief Find the blip under a touch point
+ * Must be called with the LVGL lock held.
+ * @param x Screen X in pixels
+ * @param y Screen Y in pixels
+ * @return ICAO key of the nearest blip within TOUCH_SELECT_RADIUS_PX,
+ *         or ICAO_KEY_INVALID
+ */
+uint32_t blip_layer_hit_test(int32_t x, int32_t y);
+
+/**
+ * @brief Select an aircraft (ring around its blip, label always shown)
+ * Takes effect at the next blip_layer_commit().
+ * @param icao ICAO key, or ICAO_KEY_INVALID to clear the selection
+ */
+void blip_layer_select(uint32_t icao);
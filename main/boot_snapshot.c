@@ -0,0 +1,166 @@
+/*
+ * Boot Snapshot Implementation
+ */
+
+#include "boot_snapshot.h"
+#include "aircraft_store.h"
+#include "adsb_client.h"
+#include "icao_index.h"
+#include "persist.h"
+#include "radar_config.h"
+#include "esp_log.h"
+#include "mem_budget.h"
+#include "esp_heap_caps.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "boot_snapshot";
+
+// NVS location (own namespace so config reads never touch it)
+#define SNAPSHOT_NAMESPACE "radar_cache"
+#define SNAPSHOT_KEY       "tracks"
+
+#define SNAPSHOT_MAGIC   0x50414e53u  // "SNAP"
+#define SNAPSHOT_VERSION 1
+#define SNAPSHOT_HOME_TOLERANCE_DEG 0.01f  // ~0.6 nm: same home
+
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint8_t version;
+    uint8_t count;
+    uint16_t record_size;  // Guards against layout changes without a version bump
+    float home_lat;
+    float home_lon;
+} snapshot_header_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t icao;         // icao_index key
+    float lat;
+    float lon;
+    int32_t altitude;
+    char callsign[8];      // Not NUL-terminated when 8 characters long
+} snapshot_record_t;
+
+_Static_assert(sizeof(snapshot_record_t) == 24, "snapshot record layout changed");
+_Static_assert(BOOT_SNAPSHOT_MAX_TRACKS <= 255, "count is stored in one byte");
+
+#define SNAPSHOT_BLOB_SIZE (sizeof(snapshot_header_t) + BOOT_SNAPSHOT_MAX_TRACKS * sizeof(snapshot_record_t))
+
+// Forward declarations
+static int compare_distance(const void *a, const void *b);
+
+int boot_snapshot_restore(float home_lat, float home_lon)
+{
+    uint8_t *blob = mem_budget_malloc(MEM_TAG_PERSIST, SNAPSHOT_BLOB_SIZE, MALLOC_CAP_8BIT);
+    adsb_aircraft_t *aircraft = mem_budget_calloc(MEM_TAG_PERSIST, BOOT_SNAPSHOT_MAX_TRACKS, sizeof(adsb_aircraft_t), MALLOC_CAP_8BIT);
+    if (blob == NULL || aircraft == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate restore buffers");
+        mem_budget_free(MEM_TAG_PERSIST, blob);
+        mem_budget_free(MEM_TAG_PERSIST, aircraft);
+        return 0;
+    }
+
+    size_t len = SNAPSHOT_BLOB_SIZE;
+    esp_err_t ret = persist_read(SNAPSHOT_NAMESPACE, SNAPSHOT_KEY, blob, &len);
+
+    int count = 0;
+    const snapshot_header_t *hdr = (const snapshot_header_t *)blob;
+    if (ret != ESP_OK) {
+        ESP_LOGI(TAG, "No boot snapshot (%s)", esp_err_to_name(ret));
+    } else if (len < sizeof(*hdr) || hdr->magic != SNAPSHOT_MAGIC || hdr->version != SNAPSHOT_VERSION ||
+               hdr->record_size != sizeof(snapshot_record_t) ||
+               len != sizeof(*hdr) + hdr->count * sizeof(snapshot_record_t)) {
+        ESP_LOGW(TAG, "Ignoring incompatible boot snapshot (%u bytes)", (unsigned)len);
+    } else if (fabsf(hdr->home_lat - home_lat) > SNAPSHOT_HOME_TOLERANCE_DEG ||
+               fabsf(hdr->home_lon - home_lon) > SNAPSHOT_HOME_TOLERANCE_DEG) {
+        ESP_LOGI(TAG, "Boot snapshot is for another home position, ignoring");
+    } else {
+        const snapshot_record_t *rec = (const snapshot_record_t *)(blob + sizeof(*hdr));
+        for (int i = 0; i < hdr->count; i++) {
+            adsb_aircraft_t *a = &aircraft[count];
+            bool non_icao = (rec[i].icao & ICAO_KEY_NON_ICAO_FLAG) != 0;
+            snprintf(a->hex, sizeof(a->hex), "%s%06lx", non_icao ? "~" : "",
+                     (unsigned long)(rec[i].icao & 0xFFFFFFu));
+            memcpy(a->callsign, rec[i].callsign, sizeof(rec[i].callsign));
+            a->lat = rec[i].lat;
+            a->lon = rec[i].lon;
+            a->altitude = rec[i].altitude;
+            a->has_position = true;
+            a->source = ADSB_SOURCE_API;
+            count++;
+        }
+        aircraft_store_update(aircraft, count);
+        ESP_LOGI(TAG, "Restored %d tracks from boot snapshot", count);
+    }
+
+    mem_budget_free(MEM_TAG_PERSIST, blob);
+    mem_budget_free(MEM_TAG_PERSIST, aircraft);
+    return count;
+}
+
+bool boot_snapshot_save(float home_lat, float home_lon)
+{
+    const aircraft_snapshot_t *snapshot = aircraft_store_acquire_snapshot();
+    int total = snapshot->count;
+    if (total == 0) {
+        aircraft_store_release_snapshot(snapshot);
+        return false;
+    }
+
+    // Keep the nearest tracks: those are the ones on screen
+    const tracked_aircraft_t **order = mem_budget_malloc(MEM_TAG_PERSIST, total * sizeof(*order), MALLOC_CAP_8BIT);
+    uint8_t *blob = mem_budget_calloc(MEM_TAG_PERSIST, 1, SNAPSHOT_BLOB_SIZE, MALLOC_CAP_8BIT);
+    if (order == NULL || blob == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate snapshot buffers");
+        mem_budget_free(MEM_TAG_PERSIST, order);
+        mem_budget_free(MEM_TAG_PERSIST, blob);
+        aircraft_store_release_snapshot(snapshot);
+        return false;
+    }
+    for (int i = 0; i < total; i++) {
+        order[i] = &snapshot->aircraft[i];
+    }
+    qsort(order, total, sizeof(*order), compare_distance);
+
+    int count = total < BOOT_SNAPSHOT_MAX_TRACKS ? total : BOOT_SNAPSHOT_MAX_TRACKS;
+    snapshot_header_t *hdr = (snapshot_header_t *)blob;
+    hdr->magic = SNAPSHOT_MAGIC;
+    hdr->version = SNAPSHOT_VERSION;
+    hdr->count = (uint8_t)count;
+    hdr->record_size = sizeof(snapshot_record_t);
+    hdr->home_lat = home_lat;
+    hdr->home_lon = home_lon;
+
+    snapshot_record_t *rec = (snapshot_record_t *)(blob + sizeof(*hdr));
+    for (int i = 0; i < count; i++) {
+        rec[i].icao = order[i]->icao;
+        rec[i].lat = order[i]->lat;
+        rec[i].lon = order[i]->lon;
+        rec[i].altitude = order[i]->altitude;
+        strncpy(rec[i].callsign, order[i]->callsign, sizeof(rec[i].callsign));
+    }
+    aircraft_store_release_snapshot(snapshot);
+    mem_budget_free(MEM_TAG_PERSIST, order);
+
+    size_t len = sizeof(*hdr) + count * sizeof(snapshot_record_t);
+    esp_err_t ret = persist_write(SNAPSHOT_NAMESPACE, SNAPSHOT_KEY, blob, len);
+    mem_budget_free(MEM_TAG_PERSIST, blob);
+
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to save boot snapshot: %s", esp_err_to_name(ret));
+        return false;
+    }
+    ESP_LOGI(TAG, "Queued boot snapshot (%d of %d tracks, %u bytes)", count, total, (unsigned)len);
+    return true;
+}
+
+// Internal functions
+
+static int compare_distance(const void *a, const void *b)
+{
+    float da = (*(const tracked_aircraft_t *const *)a)->distance_nm;
+    float db = (*(const tracked_aircraft_t *const *)b)->distance_nm;
+    return (da > db) - (da < db);
+}
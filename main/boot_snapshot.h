@@ -0,0 +1,32 @@
+/*
+ * Boot Snapshot
+ * Keeps the nearest tracks in NVS so the next boot can draw last-known
+ * traffic before Wi-Fi, NTP and the first poll have finished.
+ *
+ * The blob is a small header (magic, version, home position) followed by
+ * fixed 24-byte records: ICAO key, lat/lon, altitude and callsign.
+ * Restored tracks carry no speed, so dead reckoning leaves them where
+ * they were; live reports replace them and the rest age out as usual.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+
+/**
+ * @brief Load the saved snapshot into the aircraft store
+ * Snapshots saved for a different home position are ignored.
+ * @param home_lat Current home latitude
+ * @param home_lon Current home longitude
+ * @return Number of tracks restored (0 if none or invalid)
+ */
+int boot_snapshot_restore(float home_lat, float home_lon);
+
+/**
+ * @brief Save the nearest BOOT_SNAPSHOT_MAX_TRACKS tracks to NVS
+ * Queues the blob on the persist task; the flash write happens there.
+ * @param home_lat Current home latitude (stored for validation)
+ * @param home_lon Current home longitude
+ * @return true if a snapshot was written
+ */
+bool boot_snapshot_save(float home_lat, float home_lon);
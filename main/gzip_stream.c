@@ -0,0 +1,130 @@
+/*
+ * Streaming gzip Decoder Implementation
+ */
+
+#include "gzip_stream.h"
+#include "esp_log.h"
+#include "mem_budget.h"
+#include "esp_heap_caps.h"
+#include "zlib.h"
+#include <string.h>
+
+static const char *TAG = "gzip_stream";
+
+// Forward declarations
+static voidpf zalloc_psram(voidpf opaque, uInt items, uInt size);
+static void zfree_psram(voidpf opaque, voidpf address);
+
+bool gzip_stream_begin(gzip_stream_t *gz, gzip_stream_sink_t sink, void *user_ctx)
+{
+    memset(gz, 0, sizeof(*gz));
+    gz->sink = sink;
+    gz->user_ctx = user_ctx;
+
+    z_stream *zs = mem_budget_calloc(MEM_TAG_ADSB, 1, sizeof(z_stream), MALLOC_CAP_8BIT);
+    gz->out = mem_budget_malloc(MEM_TAG_ADSB, GZIP_STREAM_OUT_CHUNK, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (zs == NULL || gz->out == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate decoder");
+        mem_budget_free(MEM_TAG_ADSB, zs);
+        mem_budget_free(MEM_TAG_ADSB, gz->out);
+        gz->out = NULL;
+        gz->error = true;
+        return false;
+    }
+
+    zs->zalloc = zalloc_psram;
+    zs->zfree = zfree_psram;
+
+    // 16 + MAX_WBITS: expect a gzip header and trailer, not raw zlib
+    int ret = inflateInit2(zs, 16 + MAX_WBITS);
+    if (ret != Z_OK) {
+        ESP_LOGE(TAG, "inflateInit2 failed: %d", ret);
+        mem_budget_free(MEM_TAG_ADSB, zs);
+        mem_budget_free(MEM_TAG_ADSB, gz->out);
+        gz->out = NULL;
+        gz->error = true;
+        return false;
+    }
+
+    gz->zs = zs;
+    return true;
+}
+
+bool gzip_stream_feed(gzip_stream_t *gz, const char *data, int len)
+{
+    if (gz->error || gz->zs == NULL) {
+        return false;
+    }
+    if (gz->finished || len <= 0) {
+        return true;
+    }
+
+    z_stream *zs = (z_stream *)gz->zs;
+    zs->next_in = (Bytef *)data;
+    zs->avail_in = (uInt)len;
+    gz->bytes_in += len;
+
+    // Keep going while input remains or the last call filled the output
+    // buffer (zlib may still hold decoded bytes)
+    do {
+        zs->next_out = (Bytef *)gz->out;
+        zs->avail_out = GZIP_STREAM_OUT_CHUNK;
+
+        int ret = inflate(zs, Z_NO_FLUSH);
+        if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR) {
+            ESP_LOGE(TAG, "inflate failed: %d (%s)", ret, zs->msg ? zs->msg : "?");
+            gz->error = true;
+            return false;
+        }
+
+        int produced = GZIP_STREAM_OUT_CHUNK - (int)zs->avail_out;
+        if (produced > 0) {
+            gz->bytes_out += produced;
+            gz->sink(gz->out, produced, gz->user_ctx);
+        }
+
+        if (ret == Z_STREAM_END) {
+            gz->finished = true;
+        } else if (ret == Z_BUF_ERROR && produced == 0) {
+            break;  // Needs more input
+        }
+    } while (!gz->finished && (zs->avail_in > 0 || zs->avail_out == 0));
+    return true;
+}
+
+bool gzip_stream_end(gzip_stream_t *gz)
+{
+    if (gz->zs != NULL) {
+        inflateEnd((z_stream *)gz->zs);
+        mem_budget_free(MEM_TAG_ADSB, gz->zs);
+        gz->zs = NULL;
+    }
+    mem_budget_free(MEM_TAG_ADSB, gz->out);
+    gz->out = NULL;
+
+    if (!gz->error && !gz->finished && gz->bytes_in > 0) {
+        ESP_LOGW(TAG, "Truncated gzip body (%lu B in, %lu B out)",
+                 (unsigned long)gz->bytes_in, (unsigned long)gz->bytes_out);
+    }
+    return !gz->error && gz->finished;
+}
+
+// Internal functions
+
+// The 32 KB window is touched once per output byte; PSRAM keeps it out of
+// scarce internal RAM at a small speed cost
+static voidpf zalloc_psram(voidpf opaque, uInt items, uInt size)
+{
+    (void)opaque;
+    void *p = mem_budget_calloc(MEM_TAG_ADSB, items, size, MALLOC_CAP_SPIRAM);
+    if (p == NULL) {
+        p = mem_budget_calloc(MEM_TAG_ADSB, items, size, MALLOC_CAP_8BIT);
+    }
+    return p;
+}
+
+static void zfree_psram(voidpf opaque, voidpf address)
+{
+    (void)opaque;
+    mem_budget_free(MEM_TAG_ADSB, address);
+}
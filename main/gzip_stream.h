@@ -0,0 +1,58 @@
+/*
+ * Streaming gzip Decoder
+ * Inflates a gzip-encoded HTTP body chunk by chunk and forwards the
+ * decompressed bytes to a sink (the streaming JSON parser), so compressed
+ * responses never need to be held in memory either.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Decompressed bytes are delivered in chunks of at most this size
+#define GZIP_STREAM_OUT_CHUNK 2048
+
+// Callback for each chunk of decompressed data
+typedef void (*gzip_stream_sink_t)(const char *data, int len, void *user_ctx);
+
+// Decoder state (allocate statically; the inflate state itself is heap)
+typedef struct {
+    void *zs;                       // z_stream, allocated by gzip_stream_begin()
+    char *out;                      // GZIP_STREAM_OUT_CHUNK output buffer
+    gzip_stream_sink_t sink;
+    void *user_ctx;
+    bool finished;                  // End of gzip member reached
+    bool error;                     // Corrupt or truncated data
+    uint32_t bytes_in;
+    uint32_t bytes_out;
+} gzip_stream_t;
+
+/**
+ * @brief Start decoding a new gzip body
+ * Allocates the inflate state and 32 KB window (PSRAM preferred).
+ * @param gz Decoder state
+ * @param sink Callback for decompressed data
+ * @param user_ctx Opaque pointer passed to the sink
+ * @return true on success
+ */
+bool gzip_stream_begin(gzip_stream_t *gz, gzip_stream_sink_t sink, void *user_ctx);
+
+/**
+ * @brief Feed a chunk of compressed data
+ * Arbitrary chunk boundaries are fine. Data after the end of the gzip
+ * member and data fed after an error are ignored.
+ * @param gz Decoder state
+ * @param data Compressed bytes
+ * @param len Length in bytes
+ * @return false once the stream is corrupt
+ */
+bool gzip_stream_feed(gzip_stream_t *gz, const char *data, int len);
+
+/**
+ * @brief Release the inflate state
+ * Safe to call more than once and on a decoder that failed to begin.
+ * @param gz Decoder state
+ * @return true if the whole gzip member was decoded without error
+ */
+bool gzip_stream_end(gzip_stream_t *gz);
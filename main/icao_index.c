@@ -0,0 +1,194 @@
+/*
+ * ICAO Address Index Implementation
+ *
+ * Linear probing with backward-shift deletion (no tombstones), so the table
+ * never degrades as aircraft come and go. The table is sized to at least
+ * twice the slot capacity to keep probe sequences short.
+ */
+
+#include "icao_index.h"
+#include "mem_budget.h"
+#include "esp_heap_caps.h"
+#include <string.h>
+
+static inline uint32_t bucket_for(const icao_index_t *index, uint32_t key)
+{
+    // Fibonacci hashing: spreads sequential ICAO blocks across the table
+    return (key * 2654435761u) >> index->shift;
+}
+
+uint32_t icao_key_from_hex(const char *hex)
+{
+    if (hex == NULL) {
+        return ICAO_KEY_INVALID;
+    }
+
+    uint32_t flags = 0;
+    if (*hex == '~') {
+        flags = ICAO_KEY_NON_ICAO_FLAG;
+        hex++;
+    }
+
+    uint32_t value = 0;
+    int digits = 0;
+    for (; *hex != '\0'; hex++) {
+        char c = *hex;
+        uint32_t nibble;
+        if (c >= '0' && c <= '9') {
+            nibble = c - '0';
+        } else if (c >= 'a' && c <= 'f') {
+            nibble = c - 'a' + 10;
+        } else if (c >= 'A' && c <= 'F') {
+            nibble = c - 'A' + 10;
+        } else {
+            return ICAO_KEY_INVALID;
+        }
+        if (++digits > 6) {
+            return ICAO_KEY_INVALID;
+        }
+        value = (value << 4) | nibble;
+    }
+
+    return (digits > 0) ? (value | flags) : ICAO_KEY_INVALID;
+}
+
+bool icao_index_init(icao_index_t *index, int capacity, mem_tag_t tag)
+{
+    memset(index, 0, sizeof(*index));
+    index->tag = tag;
+
+    uint32_t table_size = 16;
+    int bits = 4;
+    while (table_size < (uint32_t)capacity * 2) {
+        table_size <<= 1;
+        bits++;
+    }
+
+    // Small, hot tables: keep them in internal RAM
+    const uint32_t caps = MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT;
+    index->keys = mem_budget_malloc(index->tag, table_size * sizeof(uint32_t), caps);
+    index->slots = mem_budget_malloc(index->tag, table_size * sizeof(int16_t), caps);
+    index->free_list = mem_budget_malloc(index->tag, capacity * sizeof(int16_t), caps);
+    if (index->keys == NULL || index->slots == NULL || index->free_list == NULL) {
+        icao_index_deinit(index);
+        return false;
+    }
+
+    index->mask = table_size - 1;
+    index->shift = 32 - bits;
+    index->capacity = capacity;
+    icao_index_clear(index);
+    return true;
+}
+
+void icao_index_deinit(icao_index_t *index)
+{
+    mem_budget_free(index->tag, index->keys);
+    mem_budget_free(index->tag, index->slots);
+    mem_budget_free(index->tag, index->free_list);
+    mem_tag_t tag = index->tag;
+    memset(index, 0, sizeof(*index));
+    index->tag = tag;
+}
+
+void icao_index_clear(icao_index_t *index)
+{
+    memset(index->keys, 0xFF, (index->mask + 1) * sizeof(uint32_t));
+
+    // Hand out low slot numbers first
+    index->free_count = index->capacity;
+    for (int i = 0; i < index->capacity; i++) {
+        index->free_list[i] = (int16_t)(index->capacity - 1 - i);
+    }
+}
+
+int icao_index_find(const icao_index_t *index, uint32_t key)
+{
+    if (index->keys == NULL || key == ICAO_KEY_INVALID) {
+        return -1;
+    }
+
+    uint32_t pos = bucket_for(index, key);
+    while (index->keys[pos] != ICAO_KEY_INVALID) {
+        if (index->keys[pos] == key) {
+            return index->slots[pos];
+        }
+        pos = (pos + 1) & index->mask;
+    }
+    return -1;
+}
+
+int icao_index_insert(icao_index_t *index, uint32_t key, bool *out_inserted)
+{
+    if (out_inserted != NULL) {
+        *out_inserted = false;
+    }
+    if (index->keys == NULL || key == ICAO_KEY_INVALID) {
+        return -1;
+    }
+
+    uint32_t pos = bucket_for(index, key);
+    while (index->keys[pos] != ICAO_KEY_INVALID) {
+        if (index->keys[pos] == key) {
+            return index->slots[pos];
+        }
+        pos = (pos + 1) & index->mask;
+    }
+
+    if (index->free_count == 0) {
+        return -1;
+    }
+
+    int slot = index->free_list[--index->free_count];
+    index->keys[pos] = key;
+    index->slots[pos] = (int16_t)slot;
+    if (out_inserted != NULL) {
+        *out_inserted = true;
+    }
+    return slot;
+}
+
+int icao_index_remove(icao_index_t *index, uint32_t key)
+{
+    if (index->keys == NULL || key == ICAO_KEY_INVALID) {
+        return -1;
+    }
+
+    uint32_t pos = bucket_for(index, key);
+    while (index->keys[pos] != key) {
+        if (index->keys[pos] == ICAO_KEY_INVALID) {
+            return -1;
+        }
+        pos = (pos + 1) & index->mask;
+    }
+
+    int slot = index->slots[pos];
+    index->free_list[index->free_count++] = (int16_t)slot;
+
+    // Backward-shift deletion: pull later entries of the probe run into the hole
+    uint32_t hole = pos;
+    uint32_t next = pos;
+    while (true) {
+        next = (next + 1) & index->mask;
+        if (index->keys[next] == ICAO_KEY_INVALID) {
+            break;
+        }
+        uint32_t home = bucket_for(index, index->keys[next]);
+        // Entry stays if its home bucket lies cyclically in (hole, next]
+        bool stays = (hole <= next) ? (home > hole && home <= next)
+                                    : (home > hole || home <= next);
+        if (!stays) {
+            index->keys[hole] = index->keys[next];
+            index->slots[hole] = index->slots[next];
+            hole = next;
+        }
+    }
+    index->keys[hole] = ICAO_KEY_INVALID;
+
+    return slot;
+}
+
+int icao_index_count(const icao_index_t *index)
+{
+    return index->capacity - index->free_count;
+}
@@ -0,0 +1,89 @@
+/*
+ * ICAO Address Index
+ * Open-addressing hash index from 24-bit ICAO address to a fixed slot,
+ * with a free-list of slots. Shared by the aircraft store and the
+ * renderer's blip table so lookups and insertions stay O(1).
+ */
+
+#pragma once
+
+#include "mem_budget.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Marker for "no key" (valid keys use at most 25 bits)
+#define ICAO_KEY_INVALID 0xFFFFFFFFu
+
+// Set on keys parsed from "~xxxxxx" hex codes (non-ICAO / TIS-B addresses)
+#define ICAO_KEY_NON_ICAO_FLAG (1u << 24)
+
+typedef struct {
+    uint32_t *keys;       // Hash table keys (ICAO_KEY_INVALID = empty bucket)
+    int16_t *slots;       // Slot number stored alongside each key
+    uint32_t mask;        // Table size - 1 (table size is a power of two)
+    int shift;            // 32 - log2(table size), for multiplicative hashing
+    int16_t *free_list;   // Stack of unused slot numbers
+    int free_count;
+    int capacity;         // Number of slots managed
+    mem_tag_t tag;        // Owner the tables are charged to
+} icao_index_t;
+
+/**
+ * @brief Parse ICAO hex string (e.g. "7c6b2d" or "~7c6b2d") into an integer key
+ * @param hex Hex code from the ADSB feed
+ * @return Key, or ICAO_KEY_INVALID if the string is not a valid address
+ */
+uint32_t icao_key_from_hex(const char *hex);
+
+/**
+ * @brief Allocate index tables for a number of slots
+ * @param index Index to initialize
+ * @param capacity Number of slots (0..capacity-1)
+ * @param tag Subsystem the tables are charged to
+ * @return true on success
+ */
+bool icao_index_init(icao_index_t *index, int capacity, mem_tag_t tag);
+
+/**
+ * @brief Free index tables
+ * @param index Index to release
+ */
+void icao_index_deinit(icao_index_t *index);
+
+/**
+ * @brief Remove all keys and return every slot to the free-list
+ * @param index Index
+ */
+void icao_index_clear(icao_index_t *index);
+
+/**
+ * @brief Look up the slot for a key
+ * @param index Index
+ * @param key ICAO key
+ * @return Slot number, or -1 if not present
+ */
+int icao_index_find(const icao_index_t *index, uint32_t key);
+
+/**
+ * @brief Find the slot for a key, allocating a free slot if absent
+ * @param index Index
+ * @param key ICAO key
+ * @param out_inserted Set to true if a new slot was allocated (may be NULL)
+ * @return Slot number, or -1 if the key is new and no slot is free
+ */
+int icao_index_insert(icao_index_t *index, uint32_t key, bool *out_inserted);
+
+/**
+ * @brief Remove a key and return its slot to the free-list
+ * @param index Index
+ * @param key ICAO key
+ * @return Slot number that was freed, or -1 if not present
+ */
+int icao_index_remove(icao_index_t *index, uint32_t key);
+
+/**
+ * @brief Get number of slots in use
+ * @param index Index
+ * @return Used slot count
+ */
+int icao_index_count(const icao_index_t *index);
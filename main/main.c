@@ -13,11 +13,21 @@
 
 #include "radar_config.h"
 #include "nvsconfig.h"
+#include "persist.h"
 #include "settings_panel.h"
 #include "wifi.h"
 #include "radar_renderer.h"
 #include "adsb_client.h"
+#include "sbs_client.h"
+#include "poll_scheduler.h"
 #include "aircraft_store.h"
+#include "task_layout.h"
+#include "perf_stats.h"
+#include "mem_budget.h"
+#include "render_lod.h"
+#include "benchmark.h"
+#include "boot_snapshot.h"
+#include "esp_timer.h"
 
 static const char *TAG = "main";
 
@@ -27,6 +37,13 @@ static lv_display_t *s_display = NULL;
 // Current configuration
 static radar_config_t s_current_config;
 
+// Boot timing (µs since boot, 0 = not yet)
+static int64_t s_first_frame_us = 0;
+static int64_t s_first_live_us = 0;
+static volatile bool s_live_since_save = false;
+
+#define NETWORK_START_STACK 6144
+
 // Log heap memory stats for debugging
 static void log_heap_stats(const char *label)
 {
@@ -37,6 +54,56 @@ static void log_heap_stats(const char *label)
     ESP_LOGI(TAG, "  SPIRAM free: %lu KB (min: %lu KB)",
              heap_caps_get_free_size(MALLOC_CAP_SPIRAM) / 1024,
              heap_caps_get_minimum_free_size(MALLOC_CAP_SPIRAM) / 1024);
+    ESP_LOGI(TAG, "  Internal largest free block: %lu KB",
+             heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL) / 1024);
+}
+
+// Start the display with the configured backend, falling back to the
+// full-screen PSRAM buffer if the partial DMA buffers cannot be allocated
+static lv_display_t *start_display(void)
+{
+    bsp_display_cfg_t cfg = {
+        .lvgl_port_cfg = ESP_LVGL_PORT_INIT_CONFIG(),
+        .buffer_size = SCREEN_SIZE * SCREEN_SIZE,  // Full screen buffer
+        .double_buffer = false,
+        .flags = {
+            .buff_dma = false,
+            .buff_spiram = true,  // CRITICAL: Use SPIRAM for large buffer
+        }
+    };
+    task_layout_apply_lvgl(&cfg.lvgl_port_cfg);
+
+#if RADAR_DISPLAY_BACKEND == DISPLAY_BACKEND_DMA_PARTIAL
+    // Partial render into two small internal buffers: LVGL draws the next
+    // dirty area while the previous one is copied to the DPI frame buffer
+    // by DMA2D, and the CPU renderer works out of internal RAM
+    bsp_display_cfg_t dma_cfg = cfg;
+    dma_cfg.buffer_size = SCREEN_SIZE * DISPLAY_PARTIAL_LINES;
+    dma_cfg.double_buffer = true;
+    dma_cfg.flags.buff_dma = true;
+    dma_cfg.flags.buff_spiram = false;
+
+    // Check first: a failed start leaves the panel half-initialized
+    const uint32_t dma_caps = MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL;
+    size_t needed = 2 * dma_cfg.buffer_size * sizeof(uint16_t);  // RGB565
+    if (heap_caps_get_free_size(dma_caps) >= needed &&
+        heap_caps_get_largest_free_block(dma_caps) >= needed / 2) {
+        lv_display_t *display = bsp_display_start_with_config(&dma_cfg);
+        if (display != NULL) {
+            ESP_LOGI(TAG, "Display backend: partial DMA (2 x %d lines, %u KB internal)",
+                     DISPLAY_PARTIAL_LINES, (unsigned)(needed / 1024));
+            return display;
+        }
+    }
+    ESP_LOGW(TAG, "Partial DMA buffers unavailable (%u KB), using PSRAM full-screen buffer",
+             (unsigned)(needed / 1024));
+#endif
+
+    lv_display_t *display = bsp_display_start_with_config(&cfg);
+    if (display != NULL) {
+        ESP_LOGI(TAG, "Display backend: PSRAM full-screen buffer");
+    }
+    return display;
 }
 
 // WiFi status callback
@@ -57,43 +124,118 @@ static void wifi_status_callback(wifi_status_t status)
     }
 }
 
-// ADSB data callback
+// Dead-reckoning task: moves blips between ADSB polls at a fixed rate
+static void projection_task(void *arg)
+{
+    TickType_t last_wake = xTaskGetTickCount();
+    while (1) {
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(DEAD_RECKONING_STEP_MS));
+        aircraft_store_project();
+    }
+}
+
+// First render after the radar UI exists (LVGL task)
+static void first_frame_event_cb(lv_event_t *e)
+{
+    (void)e;
+    if (s_first_frame_us == 0) {
+        s_first_frame_us = esp_timer_get_time();
+        ESP_LOGI(TAG, "Boot: first frame at %lld ms", s_first_frame_us / 1000);
+    }
+}
+
+// Called with every batch of live data (API or local feed)
+static void mark_live_data(void)
+{
+    s_live_since_save = true;
+    if (s_first_live_us != 0) {
+        return;
+    }
+    s_first_live_us = esp_timer_get_time();
+    radar_renderer_set_stale(false);
+    ESP_LOGI(TAG, "Boot: first live data at %lld ms (first frame at %lld ms)",
+             s_first_live_us / 1000, s_first_frame_us / 1000);
+}
+
+// ADSB data callback (once per parser batch; the client logs each poll)
 static void adsb_data_callback(const adsb_aircraft_t *aircraft, int count)
 {
-    ESP_LOGI(TAG, "=== Received %d aircraft from ADSB API ===", count);
+    static int64_t last_prune_us = 0;
+
+    // Update aircraft store (computes distance, bearing, screen coords);
+    // the tracks it moved drive the adaptive poll interval
+    int changed = aircraft_store_update(aircraft, count);
+    poll_scheduler_note_changes(changed);
+    mark_live_data();
+
+    // Prune stale aircraft (>60s old). A poll arrives as many batches
+    // within a second, so this runs once per poll.
+    int64_t now_us = esp_timer_get_time();
+    if (now_us - last_prune_us >= 1000000) {
+        aircraft_store_prune();
+        last_prune_us = now_us;
+    }
+
+    // The renderer picks up the new snapshot on its own LVGL timer
+}
+
+// Local feed callback (every ADSB_FEED_FLUSH_MS, so no per-batch logging)
+static void feed_data_callback(const adsb_aircraft_t *aircraft, int count)
+{
+    static int64_t last_prune_us = 0;
 
-    // Update aircraft store (computes distance, bearing, screen coords)
     aircraft_store_update(aircraft, count);
 
-    // Prune stale aircraft (>60s old)
-    aircraft_store_prune();
-
-    // Get all active aircraft for rendering
-    static tracked_aircraft_t display_aircraft[MAX_AIRCRAFT];
-    int active_count = aircraft_store_get_all(display_aircraft);
-
-    // Update radar display
-    radar_renderer_update_aircraft(display_aircraft, active_count);
-
-    // Log first 3 aircraft for debugging
-    for (int i = 0; i < count && i < 3; i++) {
-        if (aircraft[i].has_position) {
-            ESP_LOGI(TAG, "  [%d] %s %-8s @ (%.4f, %.4f) alt=%d ft",
-                     i,
-                     aircraft[i].hex,
-                     aircraft[i].callsign[0] ? aircraft[i].callsign : "N/A",
-                     aircraft[i].lat,
-                     aircraft[i].lon,
-                     aircraft[i].altitude);
-        }
+    // Pruning walks every track; once a second is plenty for a 60 s timeout
+    int64_t now_us = esp_timer_get_time();
+    if (now_us - last_prune_us >= 1000000) {
+        aircraft_store_prune();
+        last_prune_us = now_us;
     }
+    mark_live_data();
+}
 
-    if (count > 3) {
-        ESP_LOGI(TAG, "  ... and %d more aircraft (%d active in store)",
-                 count - 3, active_count);
+// Wi-Fi, SNTP, ADSB client and local feed
+static void start_network(void)
+{
+    // Initialize WiFi with loaded configuration
+    ESP_LOGI(TAG, "Initializing WiFi with saved credentials...");
+    if (!wifi_init(s_current_config.wifi_ssid, s_current_config.wifi_password, wifi_status_callback)) {
+        ESP_LOGE(TAG, "Failed to initialize WiFi!");
+        return;
+    }
+    ESP_LOGI(TAG, "WiFi initialization started");
+    log_heap_stats("after_wifi");
+
+    // Initialize and start ADSB client
+    ESP_LOGI(TAG, "Initializing ADSB client...");
+    adsb_client_init(adsb_data_callback);
+    adsb_client_set_radar_params(s_current_config.home_lat, s_current_config.home_lon, s_current_config.radar_radius_nm);
+    poll_scheduler_set_phase_source(radar_renderer_get_sweep_timing);
+    adsb_client_start();
+    ESP_LOGI(TAG, "ADSB client started (adaptive %d-%d s polls)",
+             ADSB_POLL_MIN_MS / 1000, ADSB_POLL_IDLE_MS / 1000);
+    log_heap_stats("after_adsb");
+
+    // Optional local receiver, merged with the API by source priority
+    if (strlen(ADSB_FEED_HOST) > 0 &&
+        sbs_client_init(feed_data_callback, aircraft_store_get_capacity())) {
+        sbs_client_start();
+        log_heap_stats("after_feed");
     }
 }
 
+#if BOOT_FAST_START
+// Runs the network bring-up while app_main builds the UI
+static void network_start_task(void *arg)
+{
+    (void)arg;
+    start_network();
+    ESP_LOGI(TAG, "Network bring-up done at %lld ms", esp_timer_get_time() / 1000);
+    vTaskDelete(NULL);
+}
+#endif
+
 // Config button callback - open settings panel
 static void config_button_callback(void)
 {
@@ -109,10 +251,9 @@ static void on_settings_saved(const radar_config_t *new_cfg)
 {
     ESP_LOGI(TAG, "Configuration updated via settings panel");
 
-    // Save to NVS
+    // Queue for NVS (written by the persist task, not on the LVGL task)
     esp_err_t ret = nvsconfig_write_config(new_cfg);
     if (ret == ESP_OK) {
-        ESP_LOGI(TAG, "Configuration persisted to NVS");
         nvsconfig_mark_first_boot_done();
     } else {
         ESP_LOGE(TAG, "Failed to save config to NVS: %s", esp_err_to_name(ret));
@@ -121,16 +262,24 @@ static void on_settings_saved(const radar_config_t *new_cfg)
     // Apply changes immediately
     bsp_display_lock(0);
     radar_renderer_set_label(new_cfg->display_label);
+    radar_renderer_set_radius(new_cfg->radar_radius_nm);
     radar_renderer_set_show_labels(new_cfg->show_aircraft_labels);
     radar_renderer_set_timezone(new_cfg->timezone_offset_hours);
+    radar_renderer_set_render_mode(new_cfg->render_mode);
     bsp_display_unlock();
 
+    // Radius reaches the store through the renderer (it owns the zoom level)
     aircraft_store_set_home_location(new_cfg->home_lat, new_cfg->home_lon);
-    aircraft_store_set_radar_radius(new_cfg->radar_radius_nm);
 
     // Update ADSB client radar parameters
     adsb_client_set_radar_params(new_cfg->home_lat, new_cfg->home_lon, new_cfg->radar_radius_nm);
 
+    // Capacity sizes the store and blip pools, so it only applies on restart
+    if (new_cfg->max_aircraft != aircraft_store_get_capacity()) {
+        ESP_LOGI(TAG, "Max aircraft changed to %d (takes effect after restart)",
+                 new_cfg->max_aircraft);
+    }
+
     // If WiFi credentials changed, reconnect
     bool wifi_changed = (strcmp(new_cfg->wifi_ssid, s_current_config.wifi_ssid) != 0 ||
                          strcmp(new_cfg->wifi_password, s_current_config.wifi_password) != 0);
@@ -149,6 +298,8 @@ void app_main(void)
 {
     ESP_LOGI(TAG, "=== ESP32-P4 ADSB Radar Display Starting ===");
     log_heap_stats("startup");
+    ESP_LOGI(TAG, "Task layout:");
+    task_layout_log();
 
     // Initialize NVS (required for WiFi)
     ESP_LOGI(TAG, "Initializing NVS...");
@@ -161,55 +312,12 @@ void app_main(void)
     ESP_LOGI(TAG, "NVS initialized");
     log_heap_stats("after_nvs");
 
-    // Initialize display
-    ESP_LOGI(TAG, "Initializing display...");
-    bsp_display_cfg_t cfg = {
-        .lvgl_port_cfg = ESP_LVGL_PORT_INIT_CONFIG(),
-        .buffer_size = SCREEN_SIZE * SCREEN_SIZE,  // Full screen buffer
-        .flags = {
-            .buff_dma = false,
-            .buff_spiram = true,  // CRITICAL: Use SPIRAM for large buffer
-        }
-    };
-    s_display = bsp_display_start_with_config(&cfg);
-    if (s_display == NULL) {
-        ESP_LOGE(TAG, "Failed to initialize display!");
-        return;
-    }
-    ESP_LOGI(TAG, "Display initialized");
-    log_heap_stats("after_display");
-
-    // Set display backlight to full
-    bsp_display_brightness_set(100);
-
-    // Create radar display
-    ESP_LOGI(TAG, "Creating radar display...");
-    bsp_display_lock(0);
-
-    lv_obj_t *scr = lv_scr_act();
-    lv_obj_set_style_bg_color(scr, lv_color_make(COLOR_BACKGROUND_R,
-                                                  COLOR_BACKGROUND_G,
-                                                  COLOR_BACKGROUND_B), 0);
-    lv_obj_set_style_bg_opa(scr, LV_OPA_COVER, 0);
-    lv_obj_clear_flag(scr, LV_OBJ_FLAG_SCROLLABLE);
-
-    // Initialize radar renderer with distance rings
-    if (!radar_renderer_init(scr)) {
-        ESP_LOGE(TAG, "Failed to initialize radar renderer!");
-        bsp_display_unlock();
+    // Background writer for config and snapshot blobs
+    if (!persist_init()) {
+        ESP_LOGE(TAG, "Failed to start persistence task!");
         return;
     }
 
-    bsp_display_unlock();
-    ESP_LOGI(TAG, "Radar display created");
-    log_heap_stats("after_radar");
-
-    // Initialize aircraft store
-    ESP_LOGI(TAG, "Initializing aircraft store...");
-    aircraft_store_init();
-    ESP_LOGI(TAG, "Aircraft store initialized");
-    log_heap_stats("after_store");
-
     // Initialize NVS configuration module
     ESP_LOGI(TAG, "Initializing NVS configuration...");
     ret = nvsconfig_init();
@@ -243,9 +351,97 @@ void app_main(void)
     ESP_LOGI(TAG, "  Radius: %d NM", s_current_config.radar_radius_nm);
     ESP_LOGI(TAG, "  Show Labels: %s", s_current_config.show_aircraft_labels ? "Yes" : "No");
     ESP_LOGI(TAG, "  Label: %s", s_current_config.display_label);
-    ESP_LOGI(TAG, "  Sweep: synced to API poll interval (%.1f sec)", ADSB_POLL_INTERVAL_MS / 1000.0f);
+    ESP_LOGI(TAG, "  Max Aircraft: %d", s_current_config.max_aircraft);
+    ESP_LOGI(TAG, "  Render Mode: %s",
+             s_current_config.render_mode == RENDER_MODE_BATCHED ? "Batched" : "Widgets");
+    ESP_LOGI(TAG, "  Sweep: %.1f sec, polls %s", ADSB_POLL_INTERVAL_MS / 1000.0f,
+             ADSB_POLL_ALIGN_SWEEP ? "aligned to North crossing" : "free-running");
     log_heap_stats("after_config");
 
+    // Initialize aircraft store (capacity is fixed for this boot; the
+    // renderer sizes its blip pool from it)
+    ESP_LOGI(TAG, "Initializing aircraft store...");
+    int store_capacity = s_current_config.max_aircraft;
+    if (benchmark_enabled()) {
+        store_capacity = benchmark_store_capacity();
+        ESP_LOGW(TAG, "Benchmark mode: synthetic traffic, store capacity %d", store_capacity);
+    }
+    if (!aircraft_store_init(store_capacity)) {
+        ESP_LOGE(TAG, "Failed to initialize aircraft store!");
+        return;
+    }
+    ESP_LOGI(TAG, "Aircraft store initialized");
+    log_heap_stats("after_store");
+
+    // Apply configuration to aircraft store (before any tracks arrive)
+    aircraft_store_set_home_location(s_current_config.home_lat, s_current_config.home_lon);
+    aircraft_store_set_radar_radius(s_current_config.radar_radius_nm);
+
+    // Fast start: last-known traffic goes into the store and the network
+    // comes up on its own task while the display and UI are created
+    bool network_started = false;
+#if BOOT_FAST_START
+    if (!benchmark_enabled() && strlen(s_current_config.wifi_ssid) > 0) {
+        if (boot_snapshot_restore(s_current_config.home_lat, s_current_config.home_lon) > 0) {
+            radar_renderer_set_stale(true);
+        }
+        network_started = xTaskCreate(network_start_task, "net_start", NETWORK_START_STACK,
+                                      NULL, 5, NULL) == pdPASS;
+        if (!network_started) {
+            ESP_LOGW(TAG, "Failed to create net_start task, starting network after the UI");
+        }
+    }
+#endif
+
+    // Initialize display
+    ESP_LOGI(TAG, "Initializing display...");
+    s_display = start_display();
+    if (s_display == NULL) {
+        ESP_LOGE(TAG, "Failed to initialize display!");
+        return;
+    }
+    ESP_LOGI(TAG, "Display initialized");
+    log_heap_stats("after_display");
+
+    bsp_display_lock(0);
+    perf_stats_attach_display(s_display);
+    render_lod_attach_display(s_display);
+    bsp_display_unlock();
+
+    // Set display backlight to full
+    bsp_display_brightness_set(100);
+
+    // Create radar display
+    ESP_LOGI(TAG, "Creating radar display...");
+    bsp_display_lock(0);
+
+    lv_obj_t *scr = lv_scr_act();
+    lv_obj_set_style_bg_color(scr, lv_color_make(COLOR_BACKGROUND_R,
+                                                  COLOR_BACKGROUND_G,
+                                                  COLOR_BACKGROUND_B), 0);
+    lv_obj_set_style_bg_opa(scr, LV_OPA_COVER, 0);
+    lv_obj_clear_flag(scr, LV_OBJ_FLAG_SCROLLABLE);
+
+    // Initialize radar renderer with distance rings (label and radius are
+    // baked into the background, so set them first)
+    radar_renderer_set_render_mode(s_current_config.render_mode);
+    radar_renderer_set_label(s_current_config.display_label);
+    radar_renderer_set_radius(s_current_config.radar_radius_nm);
+    if (!radar_renderer_init(scr)) {
+        ESP_LOGE(TAG, "Failed to initialize radar renderer!");
+        bsp_display_unlock();
+        return;
+    }
+    lv_display_add_event_cb(s_display, first_frame_event_cb, LV_EVENT_RENDER_READY, NULL);
+
+    bsp_display_unlock();
+    ESP_LOGI(TAG, "Radar display created");
+    log_heap_stats("after_radar");
+
+    // Start dead reckoning (blips move smoothly between polls)
+    task_layout_create(&TASK_LAYOUT_PROJECTION, projection_task, NULL, NULL);
+    ESP_LOGI(TAG, "Dead reckoning started (%d ms step)", DEAD_RECKONING_STEP_MS);
+
     // Register settings panel callback
     settings_panel_set_save_callback(on_settings_saved);
 
@@ -254,8 +450,8 @@ void app_main(void)
 
     // Apply configuration to radar display
     bsp_display_lock(0);
-    radar_renderer_set_label(s_current_config.display_label);
-    // Sync sweep with API poll interval (10 seconds)
+    // Sweep at the nominal poll interval; the poll scheduler lands
+    // responses on its North crossing
     radar_renderer_set_sweep_rate(ADSB_POLL_INTERVAL_MS / 1000.0f);
     radar_renderer_set_show_labels(s_current_config.show_aircraft_labels);
     radar_renderer_set_timezone(s_current_config.timezone_offset_hours);
@@ -265,38 +461,32 @@ void app_main(void)
     radar_renderer_start_sweep();
     ESP_LOGI(TAG, "Radar sweep started (%.1f sec per rotation)", ADSB_POLL_INTERVAL_MS / 1000.0f);
 
+    // Redraw aircraft whenever the store publishes a new snapshot
+    radar_renderer_start_aircraft_updates();
+
     // Start the clock display
     radar_renderer_start_clock();
     ESP_LOGI(TAG, "Clock display started");
 
-    // Apply configuration to aircraft store
-    aircraft_store_set_home_location(s_current_config.home_lat, s_current_config.home_lon);
-    aircraft_store_set_radar_radius(s_current_config.radar_radius_nm);
+    // Serial console: "perf" prints pipeline timings, "perf overlay on" shows them on screen
+    perf_stats_start_console(radar_renderer_debug_overlay);
 
-    // Check if WiFi credentials exist
-    if (strlen(s_current_config.wifi_ssid) == 0) {
+    if (benchmark_enabled()) {
+        // Synthetic traffic replaces Wi-Fi and the ADSB client
+        if (!benchmark_start(s_current_config.home_lat, s_current_config.home_lon,
+                             s_current_config.radar_radius_nm)) {
+            ESP_LOGE(TAG, "Failed to start benchmark!");
+            return;
+        }
+    } else if (strlen(s_current_config.wifi_ssid) == 0) {
+        // No WiFi credentials yet
         ESP_LOGW(TAG, "No WiFi credentials - opening settings panel for first-time setup");
         bsp_display_lock(0);
         settings_panel_create(lv_scr_act(), &s_current_config);
         bsp_display_unlock();
         ESP_LOGI(TAG, "Waiting for user to configure WiFi via settings panel...");
-    } else {
-        // Initialize WiFi with loaded configuration
-        ESP_LOGI(TAG, "Initializing WiFi with saved credentials...");
-        if (!wifi_init(s_current_config.wifi_ssid, s_current_config.wifi_password, wifi_status_callback)) {
-            ESP_LOGE(TAG, "Failed to initialize WiFi!");
-            return;
-        }
-        ESP_LOGI(TAG, "WiFi initialization started");
-        log_heap_stats("after_wifi");
-
-        // Initialize and start ADSB client
-        ESP_LOGI(TAG, "Initializing ADSB client...");
-        adsb_client_init(adsb_data_callback);
-        adsb_client_set_radar_params(s_current_config.home_lat, s_current_config.home_lon, s_current_config.radar_radius_nm);
-        adsb_client_start();
-        ESP_LOGI(TAG, "ADSB client started (polling every 10 seconds)");
-        log_heap_stats("after_adsb");
+    } else if (!network_started) {
+        start_network();
     }
 
     ESP_LOGI(TAG, "=== Phase 7: Aircraft Rendering Complete ===");
@@ -314,5 +504,22 @@ void app_main(void)
                      wifi_is_time_synced() ? "Yes" : "No");
             log_heap_stats("periodic");
         }
+
+        // Log pipeline timings and per-subsystem heap every minute
+        if (loop_count % 60 == 0) {
+            perf_stats_log();
+            mem_budget_log();
+        }
+        if (loop_count % MEM_BUDGET_LEAK_WINDOW_S == 0) {
+            mem_budget_check_leaks();
+        }
+
+#if BOOT_FAST_START
+        // Refresh the boot snapshot, but only with live traffic
+        if (loop_count % (BOOT_SNAPSHOT_INTERVAL_MS / 1000) == 0 && s_live_since_save) {
+            s_live_since_save = false;
+            boot_snapshot_save(s_current_config.home_lat, s_current_config.home_lon);
+        }
+#endif
     }
 }
@@ -0,0 +1,327 @@
+/*
+ * Memory Budget Accounting Implementation
+ *
+ * Sizes come from the heap itself (the usable size of each block), so
+ * frees need no header or lookup table and the bytes charged match what
+ * the heap actually spent. Counters are atomics: allocations happen on
+ * every task, including LVGL and the TLS stack inside esp_http_client.
+ */
+
+#include "mem_budget.h"
+#include "radar_config.h"
+#include "sdkconfig.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if CONFIG_IDF_TARGET_LINUX
+#include <malloc.h>
+#endif
+
+#if CONFIG_LV_USE_CUSTOM_MALLOC
+#include "lvgl.h"
+#endif
+
+static const char *TAG = "mem_budget";
+
+typedef struct {
+    atomic_size_t live;
+    atomic_size_t peak;
+    atomic_size_t floor;     // Lowest live since the leak window opened
+    atomic_uint allocs;
+} tag_state_t;
+
+static const char *TAG_NAMES[MEM_TAG_COUNT] = {
+    [MEM_TAG_ADSB] = "adsb",
+    [MEM_TAG_FEED] = "feed",
+    [MEM_TAG_STORE] = "store",
+    [MEM_TAG_RENDER] = "render",
+    [MEM_TAG_LVGL] = "lvgl",
+    [MEM_TAG_TLS] = "tls",
+    [MEM_TAG_PERSIST] = "persist",
+};
+
+static tag_state_t s_tags[MEM_TAG_COUNT];
+
+// Leak watch (mem_budget_check_leaks only)
+static size_t s_last_floor[MEM_TAG_COUNT];
+static int s_rising[MEM_TAG_COUNT];
+static bool s_window_open = false;
+
+// Forward declarations
+static size_t block_size(void *ptr);
+static void charge(mem_tag_t tag, void *ptr);
+static void discharge(mem_tag_t tag, void *ptr);
+static int format_heap(char *buf, size_t len, const char *name, uint32_t caps);
+
+void *mem_budget_malloc(mem_tag_t tag, size_t size, uint32_t caps)
+{
+    void *ptr = heap_caps_malloc(size, caps);
+    charge(tag, ptr);
+    return ptr;
+}
+
+void *mem_budget_calloc(mem_tag_t tag, size_t count, size_t size, uint32_t caps)
+{
+    void *ptr = heap_caps_calloc(count, size, caps);
+    charge(tag, ptr);
+    return ptr;
+}
+
+void *mem_budget_aligned_calloc(mem_tag_t tag, size_t alignment, size_t count, size_t size, uint32_t caps)
+{
+    void *ptr = heap_caps_aligned_calloc(alignment, count, size, caps);
+    charge(tag, ptr);
+    return ptr;
+}
+
+void *mem_budget_realloc(mem_tag_t tag, void *ptr, size_t size, uint32_t caps)
+{
+    if (size == 0) {
+        mem_budget_free(tag, ptr);
+        return NULL;
+    }
+    size_t old_size = block_size(ptr);
+    void *grown = heap_caps_realloc(ptr, size, caps);
+    if (grown == NULL) {
+        return NULL;  // Old block untouched
+    }
+    if (ptr != NULL) {
+        atomic_fetch_sub(&s_tags[tag].live, old_size);
+        atomic_fetch_sub(&s_tags[tag].allocs, 1);
+    }
+    charge(tag, grown);
+    return grown;
+}
+
+void mem_budget_free(mem_tag_t tag, void *ptr)
+{
+    if (ptr == NULL) {
+        return;
+    }
+    discharge(tag, ptr);
+    heap_caps_free(ptr);
+}
+
+void mem_budget_get(mem_tag_t tag, mem_budget_usage_t *out)
+{
+    out->live = atomic_load(&s_tags[tag].live);
+    out->peak = atomic_load(&s_tags[tag].peak);
+    out->allocs = atomic_load(&s_tags[tag].allocs);
+}
+
+const char *mem_budget_name(mem_tag_t tag)
+{
+    return tag < MEM_TAG_COUNT ? TAG_NAMES[tag] : "?";
+}
+
+int mem_budget_format(char *buf, size_t len)
+{
+    int pos = snprintf(buf, len, "%-8s %7s %7s %6s\n", "mem KB", "live", "peak", "allocs");
+    for (int i = 0; i < MEM_TAG_COUNT && pos < (int)len; i++) {
+        mem_budget_usage_t u;
+        mem_budget_get((mem_tag_t)i, &u);
+        pos += snprintf(buf + pos, len - pos, "%-8s %7u %7u %6lu%s\n", TAG_NAMES[i],
+                        (unsigned)(u.live / 1024), (unsigned)(u.peak / 1024),
+                        (unsigned long)u.allocs, s_rising[i] >= MEM_BUDGET_LEAK_WINDOWS ? " LEAK?" : "");
+    }
+    if (pos < (int)len) {
+        pos += format_heap(buf + pos, len - pos, "internal", MALLOC_CAP_INTERNAL);
+    }
+    if (pos < (int)len) {
+        pos += format_heap(buf + pos, len - pos, "psram", MALLOC_CAP_SPIRAM);
+    }
+    return pos < (int)len ? pos : (int)len - 1;
+}
+
+void mem_budget_log(void)
+{
+    static char table[MEM_TAG_COUNT * 48 + 192];
+    mem_budget_format(table, sizeof(table));
+
+    // One log line per table row
+    char *line = table;
+    while (*line != '\0') {
+        char *end = strchr(line, '\n');
+        if (end != NULL) {
+            *end = '\0';
+        }
+        ESP_LOGI(TAG, "%s", line);
+        if (end == NULL) {
+            break;
+        }
+        line = end + 1;
+    }
+}
+
+int mem_budget_check_leaks(void)
+{
+    int flagged = 0;
+    for (int i = 0; i < MEM_TAG_COUNT; i++) {
+        tag_state_t *t = &s_tags[i];
+        size_t live = atomic_load(&t->live);
+        size_t floor = atomic_exchange(&t->floor, live);  // Next window starts here
+        if (!s_window_open) {
+            s_last_floor[i] = live;
+            continue;
+        }
+
+        // Transient peaks don't count: only a rising floor means memory
+        // that is never given back
+        s_rising[i] = floor > s_last_floor[i] ? s_rising[i] + 1 : 0;
+        if (s_rising[i] >= MEM_BUDGET_LEAK_WINDOWS) {
+            ESP_LOGW(TAG, "Possible leak in %s: floor rose %d windows in a row (%u B, now %u KB live)",
+                     TAG_NAMES[i], s_rising[i], (unsigned)(floor - s_last_floor[i]),
+                     (unsigned)(live / 1024));
+            flagged++;
+        }
+        s_last_floor[i] = floor;
+    }
+    s_window_open = true;
+    return flagged;
+}
+
+// Internal functions
+
+static size_t block_size(void *ptr)
+{
+    if (ptr == NULL) {
+        return 0;
+    }
+#if CONFIG_IDF_TARGET_LINUX
+    return malloc_usable_size(ptr);
+#else
+    return heap_caps_get_allocated_size(ptr);
+#endif
+}
+
+static void charge(mem_tag_t tag, void *ptr)
+{
+    if (ptr == NULL) {
+        return;
+    }
+    tag_state_t *t = &s_tags[tag];
+    size_t size = block_size(ptr);
+    size_t live = atomic_fetch_add(&t->live, size) + size;
+    atomic_fetch_add(&t->allocs, 1);
+
+    size_t peak = atomic_load(&t->peak);
+    while (live > peak && !atomic_compare_exchange_weak(&t->peak, &peak, live)) {
+    }
+}
+
+static void discharge(mem_tag_t tag, void *ptr)
+{
+    tag_state_t *t = &s_tags[tag];
+    size_t size = block_size(ptr);
+    size_t live = atomic_fetch_sub(&t->live, size) - size;
+    atomic_fetch_sub(&t->allocs, 1);
+
+    size_t floor = atomic_load(&t->floor);
+    while (live < floor && !atomic_compare_exchange_weak(&t->floor, &floor, live)) {
+    }
+}
+
+// "internal free 210 min 150 big 120 frag 43%"
+static int format_heap(char *buf, size_t len, const char *name, uint32_t caps)
+{
+#if CONFIG_IDF_TARGET_LINUX
+    (void)caps;
+    return snprintf(buf, len, "%s: n/a\n", name);
+#else
+    size_t free_bytes = heap_caps_get_free_size(caps);
+    size_t largest = heap_caps_get_largest_free_block(caps);
+    unsigned frag = free_bytes > 0 ? (unsigned)(100 - (uint64_t)largest * 100 / free_bytes) : 0;
+    return snprintf(buf, len, "%s free %u min %u big %u frag %u%%\n", name,
+                    (unsigned)(free_bytes / 1024),
+                    (unsigned)(heap_caps_get_minimum_free_size(caps) / 1024),
+                    (unsigned)(largest / 1024), frag);
+#endif
+}
+
+#if CONFIG_LV_USE_CUSTOM_MALLOC
+// LVGL stdlib hooks (LV_STDLIB_CUSTOM): the system heap, charged to
+// MEM_TAG_LVGL. malloc() keeps the SPIRAM_MALLOC_ALWAYSINTERNAL split
+// the CLIB allocator had.
+
+void lv_mem_init(void)
+{
+}
+
+void lv_mem_deinit(void)
+{
+}
+
+lv_mem_pool_t lv_mem_add_pool(void *mem, size_t bytes)
+{
+    (void)mem;
+    (void)bytes;
+    return NULL;
+}
+
+void lv_mem_remove_pool(lv_mem_pool_t pool)
+{
+    (void)pool;
+}
+
+void *lv_malloc_core(size_t size)
+{
+    void *ptr = malloc(size);
+    charge(MEM_TAG_LVGL, ptr);
+    return ptr;
+}
+
+void *lv_realloc_core(void *p, size_t new_size)
+{
+    size_t old_size = block_size(p);
+    void *grown = realloc(p, new_size);
+    if (grown == NULL) {
+        return NULL;
+    }
+    if (p != NULL) {
+        atomic_fetch_sub(&s_tags[MEM_TAG_LVGL].live, old_size);
+        atomic_fetch_sub(&s_tags[MEM_TAG_LVGL].allocs, 1);
+    }
+    charge(MEM_TAG_LVGL, grown);
+    return grown;
+}
+
+void lv_free_core(void *p)
+{
+    if (p == NULL) {
+        return;
+    }
+    discharge(MEM_TAG_LVGL, p);
+    free(p);
+}
+
+void lv_mem_monitor_core(lv_mem_monitor_t *mon_p)
+{
+    mem_budget_usage_t u;
+    mem_budget_get(MEM_TAG_LVGL, &u);
+    mon_p->used_cnt = u.allocs;
+    mon_p->max_used = u.peak;
+}
+
+lv_result_t lv_mem_test_core(void)
+{
+    return LV_RESULT_OK;
+}
+#endif
+
+#if CONFIG_MBEDTLS_CUSTOM_MEM_ALLOC
+// mbedTLS allocator hooks: internal RAM, as with MBEDTLS_INTERNAL_MEM_ALLOC
+
+void *esp_mbedtls_mem_calloc(size_t n, size_t size)
+{
+    return mem_budget_calloc(MEM_TAG_TLS, n, size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+}
+
+void esp_mbedtls_mem_free(void *ptr)
+{
+    mem_budget_free(MEM_TAG_TLS, ptr);
+}
+#endif
@@ -0,0 +1,105 @@
+/*
+ * Memory Budget Accounting
+ * Tagged wrappers around heap_caps_* that keep live bytes, a high-water
+ * mark and the live allocation count per subsystem. LVGL
+ * (CONFIG_LV_USE_CUSTOM_MALLOC) and mbedTLS (CONFIG_MBEDTLS_CUSTOM_MEM_ALLOC)
+ * allocate through the same wrappers, so their heaps show up as their own
+ * tags. A leak watch flags tags whose low-water mark keeps rising.
+ *
+ * The accounting has no LVGL dependency, so modules that build for the
+ * linux target can use it; the allocator hooks are device-only.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Subsystems
+typedef enum {
+    MEM_TAG_ADSB = 0,    // API client: gzip inflate, parser
+    MEM_TAG_FEED,        // Local receiver merge table
+    MEM_TAG_STORE,       // Aircraft store, snapshots, history, index
+    MEM_TAG_RENDER,      // Renderer, layers, grid, cached backgrounds
+    MEM_TAG_LVGL,        // LVGL heap (objects, styles, draw buffers)
+    MEM_TAG_TLS,         // mbedTLS contexts and record buffers
+    MEM_TAG_PERSIST,     // NVS writer queue, boot snapshot
+    MEM_TAG_COUNT
+} mem_tag_t;
+
+// Usage of one tag
+typedef struct {
+    size_t live;         // Bytes currently allocated
+    size_t peak;         // High-water mark of live
+    uint32_t allocs;     // Allocations currently live
+} mem_budget_usage_t;
+
+/**
+ * @brief heap_caps_malloc() charged to a tag
+ * @param tag Subsystem
+ * @param size Bytes
+ * @param caps MALLOC_CAP_* flags
+ * @return Allocation, or NULL
+ */
+void *mem_budget_malloc(mem_tag_t tag, size_t size, uint32_t caps);
+
+/**
+ * @brief heap_caps_calloc() charged to a tag
+ */
+void *mem_budget_calloc(mem_tag_t tag, size_t count, size_t size, uint32_t caps);
+
+/**
+ * @brief heap_caps_aligned_calloc() charged to a tag
+ */
+void *mem_budget_aligned_calloc(mem_tag_t tag, size_t alignment, size_t count, size_t size, uint32_t caps);
+
+/**
+ * @brief heap_caps_realloc() charged to a tag
+ * ptr must have been allocated with the same tag (or be NULL).
+ */
+void *mem_budget_realloc(mem_tag_t tag, void *ptr, size_t size, uint32_t caps);
+
+/**
+ * @brief Free an allocation made with the same tag (NULL is a no-op)
+ * @param tag Subsystem the allocation was charged to
+ * @param ptr Allocation
+ */
+void mem_budget_free(mem_tag_t tag, void *ptr);
+
+/**
+ * @brief Get a tag's usage
+ * @param tag Subsystem
+ * @param out Usage
+ */
+void mem_budget_get(mem_tag_t tag, mem_budget_usage_t *out);
+
+/**
+ * @brief Get a tag's short name
+ * @param tag Subsystem
+ * @return Name
+ */
+const char *mem_budget_name(mem_tag_t tag);
+
+/**
+ * @brief Format per-tag usage and heap fragmentation as a short table
+ * @param buf Output buffer
+ * @param len Buffer size
+ * @return Characters written (excluding terminator)
+ */
+int mem_budget_format(char *buf, size_t len);
+
+/**
+ * @brief Log the table
+ */
+void mem_budget_log(void);
+
+/**
+ * @brief Close a leak-watch window
+ * Each tag's lowest live value in the window is compared with the last
+ * window's; a warning is logged once a tag's floor has risen for
+ * MEM_BUDGET_LEAK_WINDOWS windows in a row. Call every
+ * MEM_BUDGET_LEAK_WINDOW_S.
+ * @return Number of tags currently flagged
+ */
+int mem_budget_check_leaks(void);
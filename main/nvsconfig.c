@@ -1,9 +1,15 @@
 /*
  * NVS Configuration Storage Implementation
  * Persistent storage for radar_config_t using ESP-IDF NVS
+ *
+ * The config and the first-boot marker are blobs written through
+ * persist.h (double-slot, CRC checked, off the caller's task). Firmware
+ * before that wrote a plain config blob and a u8 marker; both are still
+ * read.
  */
 
 #include "nvsconfig.h"
+#include "persist.h"
 #include "esp_log.h"
 #include "nvs_flash.h"
 #include "nvs.h"
@@ -15,8 +21,11 @@ static const char *TAG = "nvsconfig";
 #define NVS_NAMESPACE "radar"
 
 // NVS keys
-#define NVS_KEY_CONFIG     "config"
-#define NVS_KEY_FIRST_BOOT "first_boot"
+#define NVS_KEY_CONFIG     "config"      // Plain blob (older firmware) and persist slot base
+#define NVS_KEY_FIRST_BOOT "first_boot"  // Plain u8 (older firmware) and persist slot base
+
+// Forward declarations
+static esp_err_t read_legacy_config(radar_config_t *cfg);
 
 /**
  * Open NVS handle
@@ -57,40 +66,33 @@ bool nvsconfig_is_first_boot(void)
         return true;  // Assume first boot on error
     }
 
+    // Older firmware stored the marker as a plain u8
     uint8_t first_boot = 1;
     ret = nvs_get_u8(handle, NVS_KEY_FIRST_BOOT, &first_boot);
     nvs_close(handle);
+    if (ret == ESP_OK) {
+        return first_boot != 0;
+    }
 
+    size_t len = sizeof(first_boot);
+    ret = persist_read(NVS_NAMESPACE, NVS_KEY_FIRST_BOOT, &first_boot, &len);
     if (ret == ESP_ERR_NVS_NOT_FOUND) {
         ESP_LOGI(TAG, "First boot detected (no first_boot marker in NVS)");
         return true;
     }
 
-    return first_boot != 0;
+    return ret != ESP_OK || first_boot != 0;
 }
 
 esp_err_t nvsconfig_mark_first_boot_done(void)
 {
-    nvs_handle_t handle;
-    esp_err_t ret = open_nvs_handle(&handle);
+    // Queued after the config blob, so the persist task writes it after
+    // the config in the same pass. Repeat saves are skipped as unchanged.
+    uint8_t first_boot = 0;
+    esp_err_t ret = persist_write(NVS_NAMESPACE, NVS_KEY_FIRST_BOOT, &first_boot, sizeof(first_boot));
     if (ret != ESP_OK) {
-        return ret;
+        ESP_LOGE(TAG, "Failed to queue first boot marker: %s", esp_err_to_name(ret));
     }
-
-    ret = nvs_set_u8(handle, NVS_KEY_FIRST_BOOT, 0);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to mark first boot done: %s", esp_err_to_name(ret));
-        nvs_close(handle);
-        return ret;
-    }
-
-    ret = nvs_commit(handle);
-    nvs_close(handle);
-
-    if (ret == ESP_OK) {
-        ESP_LOGI(TAG, "First boot marker set in NVS");
-    }
-
     return ret;
 }
 
@@ -100,29 +102,13 @@ esp_err_t nvsconfig_write_config(const radar_config_t *cfg)
         return ESP_ERR_INVALID_ARG;
     }
 
-    nvs_handle_t handle;
-    esp_err_t ret = open_nvs_handle(&handle);
-    if (ret != ESP_OK) {
-        return ret;
-    }
-
-    // Write entire config structure as binary blob
-    ret = nvs_set_blob(handle, NVS_KEY_CONFIG, (void *)cfg, sizeof(radar_config_t));
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to write config blob: %s", esp_err_to_name(ret));
-        nvs_close(handle);
-        return ret;
-    }
-
-    // Commit changes to flash
-    ret = nvs_commit(handle);
-    nvs_close(handle);
-
+    // Whole struct as one blob; the persist task skips it if unchanged
+    esp_err_t ret = persist_write(NVS_NAMESPACE, NVS_KEY_CONFIG, cfg, sizeof(radar_config_t));
     if (ret == ESP_OK) {
-        ESP_LOGI(TAG, "Configuration written to NVS (%u bytes)",
-                 sizeof(radar_config_t));
+        ESP_LOGI(TAG, "Configuration queued for NVS (%u bytes)",
+                 (unsigned)sizeof(radar_config_t));
     } else {
-        ESP_LOGE(TAG, "Failed to commit config to NVS: %s", esp_err_to_name(ret));
+        ESP_LOGE(TAG, "Failed to queue config for NVS: %s", esp_err_to_name(ret));
     }
 
     return ret;
@@ -134,31 +120,36 @@ esp_err_t nvsconfig_read_config(radar_config_t *cfg)
         return ESP_ERR_INVALID_ARG;
     }
 
-    nvs_handle_t handle;
-    esp_err_t ret = open_nvs_handle(&handle);
-    if (ret != ESP_OK) {
-        return ret;
+    // Blobs written by older firmware are a prefix of the current struct
+    // (fields are only ever appended), so start from defaults and overlay
+    memcpy(cfg, &DEFAULT_CONFIG, sizeof(radar_config_t));
+    size_t stored_size = sizeof(radar_config_t);
+    esp_err_t ret = persist_read(NVS_NAMESPACE, NVS_KEY_CONFIG, cfg, &stored_size);
+    if (ret == ESP_ERR_NVS_NOT_FOUND) {
+        return read_legacy_config(cfg);
     }
 
-    // Read config blob
-    size_t required_size = sizeof(radar_config_t);
-    ret = nvs_get_blob(handle, NVS_KEY_CONFIG, (void *)cfg, &required_size);
-    nvs_close(handle);
-
     if (ret == ESP_OK) {
-        ESP_LOGI(TAG, "Configuration read from NVS");
-        return ESP_OK;
-    } else if (ret == ESP_ERR_NVS_NOT_FOUND) {
-        ESP_LOGW(TAG, "Configuration not found in NVS");
-        return ESP_ERR_NVS_NOT_FOUND;
+        if (stored_size < sizeof(radar_config_t)) {
+            ESP_LOGI(TAG, "Configuration read from NVS (upgraded from %u bytes)",
+                     (unsigned)stored_size);
+        } else {
+            ESP_LOGI(TAG, "Configuration read from NVS");
+        }
+    } else if (ret == ESP_ERR_NVS_INVALID_LENGTH) {
+        ESP_LOGE(TAG, "Stored config is larger than expected (%u > %u bytes)",
+                 (unsigned)stored_size, (unsigned)sizeof(radar_config_t));
     } else {
         ESP_LOGE(TAG, "Error reading config: %s", esp_err_to_name(ret));
-        return ret;
     }
+    return ret;
 }
 
 esp_err_t nvsconfig_erase_all(void)
 {
+    // Drop queued writes first so none land after the erase
+    persist_discard(NVS_NAMESPACE);
+
     nvs_handle_t handle;
     esp_err_t ret = open_nvs_handle(&handle);
     if (ret != ESP_OK) {
@@ -181,3 +172,43 @@ esp_err_t nvsconfig_erase_all(void)
 
     return ret;
 }
+
+// Internal functions
+
+// Plain blob from firmware before persist.h
+static esp_err_t read_legacy_config(radar_config_t *cfg)
+{
+    nvs_handle_t handle;
+    esp_err_t ret = open_nvs_handle(&handle);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    size_t stored_size = 0;
+    ret = nvs_get_blob(handle, NVS_KEY_CONFIG, NULL, &stored_size);
+    if (ret == ESP_OK && stored_size > sizeof(radar_config_t)) {
+        ESP_LOGE(TAG, "Stored config is larger than expected (%u > %u bytes)",
+                 (unsigned)stored_size, (unsigned)sizeof(radar_config_t));
+        nvs_close(handle);
+        return ESP_ERR_NVS_INVALID_LENGTH;
+    }
+
+    // Read config blob
+    if (ret == ESP_OK) {
+        memcpy(cfg, &DEFAULT_CONFIG, sizeof(radar_config_t));
+        ret = nvs_get_blob(handle, NVS_KEY_CONFIG, (void *)cfg, &stored_size);
+    }
+    nvs_close(handle);
+
+    if (ret == ESP_OK) {
+        ESP_LOGI(TAG, "Configuration read from NVS (pre-slot format, %u bytes)",
+                 (unsigned)stored_size);
+        return ESP_OK;
+    } else if (ret == ESP_ERR_NVS_NOT_FOUND) {
+        ESP_LOGW(TAG, "Configuration not found in NVS");
+        return ESP_ERR_NVS_NOT_FOUND;
+    } else {
+        ESP_LOGE(TAG, "Error reading config: %s", esp_err_to_name(ret));
+        return ret;
+    }
+}
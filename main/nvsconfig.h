@@ -31,10 +31,13 @@ esp_err_t nvsconfig_init(void);
 bool nvsconfig_is_first_boot(void);
 
 /**
- * @brief Write configuration to NVS
+ * @brief Queue configuration for writing to NVS
+ *
+ * Returns without touching flash; the persist task writes the blob in
+ * the background (see persist.h). Safe to call from the LVGL task.
  *
  * @param cfg Pointer to radar_config_t structure
- * @return ESP_OK on success
+ * @return ESP_OK once queued
  */
 esp_err_t nvsconfig_write_config(const radar_config_t *cfg);
 
@@ -49,6 +52,10 @@ esp_err_t nvsconfig_read_config(radar_config_t *cfg);
 /**
  * @brief Mark first boot as complete
  *
+ * Queues the marker through persist.h like the config, so it never
+ * touches flash on the caller's task. Call after nvsconfig_write_config():
+ * the marker then reaches flash after the config blob.
+ *
  * @return ESP_OK on success
  */
 esp_err_t nvsconfig_mark_first_boot_done(void);
@@ -0,0 +1,105 @@
+/*
+ * Pipeline Performance Statistics
+ * Fixed-size per-stage histograms of timings (µs) and sizes, recorded with
+ * esp_timer timestamps and readable from the overlay or the serial console.
+ * The recording API has no LVGL dependency so the parser and store still
+ * build for the linux target (display and console hooks are device-only).
+ */
+
+#pragma once
+
+#include "sdkconfig.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Instrumented stages
+typedef enum {
+    PERF_HTTP_CONNECT = 0,   // TCP + TLS connect (new connections only)
+    PERF_HTTP_REQUEST,       // Whole request, connect to last byte
+    PERF_DOWNLOAD_BYTES,     // Response body size on the wire (bytes, not µs)
+    PERF_PARSE,              // Inflate + streaming JSON parse per response (excl. store)
+    PERF_STORE_UPDATE,       // aircraft_store_update() per batch
+    PERF_STORE_PROJECT,      // aircraft_store_project() per step
+    PERF_RENDER_APPLY,       // Snapshot -> blips/draw list on the LVGL task
+    PERF_LVGL_RENDER,        // LVGL render of the dirty areas
+    PERF_LVGL_REFRESH,       // LVGL refresh incl. flush wait
+    PERF_FRAME_INTERVAL,     // Start-to-start time between refreshes (jitter)
+    PERF_STAGE_COUNT
+} perf_stage_t;
+
+// Summary of one stage
+typedef struct {
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint32_t mean;
+    uint32_t p50;            // Percentiles are histogram bucket upper bounds
+    uint32_t p95;
+    uint32_t p99;
+} perf_summary_t;
+
+/**
+ * @brief Current timestamp for interval measurements
+ * @return esp_timer time in µs
+ */
+int64_t perf_stats_now(void);
+
+/**
+ * @brief Record one sample (safe from any task)
+ * @param stage Stage
+ * @param value Duration in µs (bytes for PERF_DOWNLOAD_BYTES)
+ */
+void perf_stats_record(perf_stage_t stage, uint32_t value);
+
+/**
+ * @brief Record the time elapsed since a perf_stats_now() timestamp
+ * @param stage Stage
+ * @param start_us Start timestamp
+ */
+void perf_stats_record_since(perf_stage_t stage, int64_t start_us);
+
+/**
+ * @brief Summarise a stage
+ * @param stage Stage
+ * @param out Summary (zeroed if the stage has no samples)
+ */
+void perf_stats_get(perf_stage_t stage, perf_summary_t *out);
+
+/**
+ * @brief Clear every histogram
+ */
+void perf_stats_reset(void);
+
+/**
+ * @brief Format all stages as a short table (one line per stage)
+ * @param buf Output buffer
+ * @param len Buffer size
+ * @return Characters written (excluding terminator)
+ */
+int perf_stats_format(char *buf, size_t len);
+
+/**
+ * @brief Print all stages to the log
+ */
+void perf_stats_log(void);
+
+#if !CONFIG_IDF_TARGET_LINUX
+#include "lvgl.h"
+
+/**
+ * @brief Time LVGL render, refresh and frame interval on a display
+ * Must be called with the LVGL lock held.
+ * @param display Display to instrument
+ */
+void perf_stats_attach_display(lv_display_t *display);
+
+/**
+ * @brief Start a serial console with the "perf" command
+ * perf          print the table
+ * perf reset    clear all histograms
+ * perf overlay on|off
+ * @param set_overlay Called for "perf overlay" (may be NULL)
+ */
+void perf_stats_start_console(void (*set_overlay)(bool enable));
+#endif
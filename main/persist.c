@@ -0,0 +1,473 @@
+/*
+ * Background Persistence Implementation
+ *
+ * persist_write() only copies into a pending entry under a mutex. The
+ * task takes a copy of every dirty entry, drops the mutex and then does
+ * the flash I/O, so writers never wait on flash. A write that fails is
+ * queued again (unless a newer one arrived) and retried after
+ * PERSIST_RETRY_MS. Slot state (which slot is newest, its sequence
+ * number and CRC) is owned by the task and read back from flash the
+ * first time a key is written.
+ */
+
+#include "persist.h"
+#include "task_layout.h"
+#include "radar_config.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "mem_budget.h"
+#include "esp_heap_caps.h"
+#include "esp_rom_crc.h"
+#include "nvs.h"
+#include <stdio.h>
+#include <string.h>
+
+static const char *TAG = "persist";
+
+#define PERSIST_MAGIC  0x54535250u  // "PRST"
+#define PERSIST_FORMAT 1
+
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint8_t format;
+    uint8_t reserved[3];
+    uint32_t seq;      // Higher = newer
+    uint32_t len;      // Payload bytes
+    uint32_t crc;      // CRC32 of seq + payload
+} slot_header_t;
+
+typedef struct {
+    char ns[NVS_NS_NAME_MAX_SIZE];
+    char key[PERSIST_KEY_MAX + 1];   // Empty = entry unused
+    uint8_t *data;                   // Latest queued contents
+    size_t len;
+    size_t cap;
+    bool dirty;
+    bool reset;                      // Slot state must be re-read (namespace erased)
+
+    // Task-owned slot state
+    bool loaded;
+    int newest_slot;                 // -1 = no valid slot
+    uint32_t newest_seq;
+    uint32_t newest_crc;
+    uint32_t newest_len;
+} persist_entry_t;
+
+static persist_entry_t s_entries[PERSIST_MAX_ENTRIES];
+static SemaphoreHandle_t s_mutex = NULL;
+static TaskHandle_t s_task = NULL;
+
+// Task buffers (one blob at a time)
+static uint8_t *s_work = NULL;   // Header + payload
+static size_t s_work_cap = 0;
+
+// Forward declarations
+static void persist_task(void *arg);
+static bool write_pass(void);
+static int commit_namespace(nvs_handle_t handle, bool *in_commit);
+static void requeue(persist_entry_t *e);
+static esp_err_t write_entry(nvs_handle_t handle, persist_entry_t *e, const uint8_t *payload, size_t len);
+static void load_slots(nvs_handle_t handle, persist_entry_t *e);
+static int read_newest(nvs_handle_t handle, const char *key, uint8_t **out_blob, slot_header_t *out_hdr);
+static bool read_slot(nvs_handle_t handle, const char *key, int slot, uint8_t **out_blob, slot_header_t *out_hdr);
+static void slot_key(char *out, size_t size, const char *key, int slot);
+static uint32_t payload_crc(uint32_t seq, const uint8_t *payload, size_t len);
+static persist_entry_t *find_entry(const char *ns, const char *key);
+static bool reserve(uint8_t **buf, size_t *cap, size_t len);
+
+bool persist_init(void)
+{
+    if (s_task != NULL) {
+        return true;
+    }
+    s_mutex = xSemaphoreCreateMutex();
+    if (s_mutex == NULL) {
+        ESP_LOGE(TAG, "Failed to create mutex");
+        return false;
+    }
+    if (!task_layout_create(&TASK_LAYOUT_PERSIST, persist_task, NULL, &s_task)) {
+        return false;
+    }
+    ESP_LOGI(TAG, "Persistence task started (%d keys, %d ms coalescing)",
+             PERSIST_MAX_ENTRIES, PERSIST_COALESCE_MS);
+    return true;
+}
+
+esp_err_t persist_write(const char *ns, const char *key, const void *data, size_t len)
+{
+    if (ns == NULL || key == NULL || data == NULL || len == 0 ||
+        strlen(ns) >= NVS_NS_NAME_MAX_SIZE || strlen(key) > PERSIST_KEY_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_mutex == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    persist_entry_t *e = find_entry(ns, key);
+    if (e == NULL) {
+        for (int i = 0; i < PERSIST_MAX_ENTRIES && e == NULL; i++) {
+            if (s_entries[i].key[0] == '\0') {
+                e = &s_entries[i];
+                strcpy(e->ns, ns);
+                strcpy(e->key, key);
+                e->newest_slot = -1;
+            }
+        }
+    }
+    if (e == NULL || !reserve(&e->data, &e->cap, len)) {
+        xSemaphoreGive(s_mutex);
+        ESP_LOGE(TAG, "Cannot queue %s/%s (%u bytes)", ns, key, (unsigned)len);
+        return ESP_ERR_NO_MEM;
+    }
+    memcpy(e->data, data, len);
+    e->len = len;
+    e->dirty = true;
+    xSemaphoreGive(s_mutex);
+
+    xTaskNotifyGive(s_task);
+    return ESP_OK;
+}
+
+esp_err_t persist_read(const char *ns, const char *key, void *data, size_t *len)
+{
+    if (ns == NULL || key == NULL || data == NULL || len == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // Read-your-writes: a queued blob is newer than anything in flash
+    if (s_mutex != NULL) {
+        xSemaphoreTake(s_mutex, portMAX_DELAY);
+        persist_entry_t *e = find_entry(ns, key);
+        if (e != NULL && e->dirty) {
+            esp_err_t ret = ESP_OK;
+            if (e->len > *len) {
+                ret = ESP_ERR_NVS_INVALID_LENGTH;
+            } else {
+                memcpy(data, e->data, e->len);
+            }
+            *len = e->len;
+            xSemaphoreGive(s_mutex);
+            return ret;
+        }
+        xSemaphoreGive(s_mutex);
+    }
+
+    nvs_handle_t handle;
+    esp_err_t ret = nvs_open(ns, NVS_READONLY, &handle);
+    if (ret != ESP_OK) {
+        return ret;  // ESP_ERR_NVS_NOT_FOUND if the namespace was never written
+    }
+
+    uint8_t *blob = NULL;
+    slot_header_t hdr;
+    int slot = read_newest(handle, key, &blob, &hdr);
+    nvs_close(handle);
+    if (slot < 0) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+
+    ret = ESP_OK;
+    if (hdr.len > *len) {
+        ret = ESP_ERR_NVS_INVALID_LENGTH;
+    } else {
+        memcpy(data, blob + sizeof(hdr), hdr.len);
+    }
+    *len = hdr.len;
+    mem_budget_free(MEM_TAG_PERSIST, blob);
+    return ret;
+}
+
+void persist_discard(const char *ns)
+{
+    if (s_mutex == NULL || ns == NULL) {
+        return;
+    }
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    for (int i = 0; i < PERSIST_MAX_ENTRIES; i++) {
+        if (s_entries[i].key[0] != '\0' && strcmp(s_entries[i].ns, ns) == 0) {
+            s_entries[i].dirty = false;
+            s_entries[i].reset = true;
+        }
+    }
+    xSemaphoreGive(s_mutex);
+}
+
+// Internal functions
+
+static void persist_task(void *arg)
+{
+    (void)arg;
+    bool retry = false;
+    while (true) {
+        // After a failed write, run again even if nothing new is queued
+        ulTaskNotifyTake(pdTRUE, retry ? pdMS_TO_TICKS(PERSIST_RETRY_MS) : portMAX_DELAY);
+
+        // Let a burst of saves (slider drags, several modules saving at
+        // once) settle into one write per key
+        vTaskDelay(pdMS_TO_TICKS(PERSIST_COALESCE_MS));
+        retry = !write_pass();
+    }
+}
+
+// Write every dirty entry, one open/commit per namespace. Returns false
+// if anything failed and was queued again.
+static bool write_pass(void)
+{
+    nvs_handle_t handle = 0;
+    char open_ns[NVS_NS_NAME_MAX_SIZE] = "";
+    bool in_commit[PERSIST_MAX_ENTRIES] = {false};  // Written since the last commit
+    int written = 0;
+    int skipped = 0;
+    int failed = 0;
+    uint8_t *payload = NULL;
+    size_t payload_cap = 0;
+
+    for (int i = 0; i < PERSIST_MAX_ENTRIES; i++) {
+        persist_entry_t *e = &s_entries[i];
+
+        // Take the queued contents; later writes re-mark the entry dirty
+        xSemaphoreTake(s_mutex, portMAX_DELAY);
+        if (e->reset) {
+            e->reset = false;
+            e->loaded = false;
+        }
+        if (!e->dirty) {
+            xSemaphoreGive(s_mutex);
+            continue;
+        }
+        if (!reserve(&payload, &payload_cap, e->len)) {
+            xSemaphoreGive(s_mutex);
+            failed++;  // Still dirty; retried next pass
+            continue;
+        }
+        size_t len = e->len;
+        memcpy(payload, e->data, len);
+        e->dirty = false;
+        xSemaphoreGive(s_mutex);
+
+        if (strcmp(open_ns, e->ns) != 0) {
+            if (open_ns[0] != '\0') {
+                int requeued = commit_namespace(handle, in_commit);
+                written -= requeued;
+                failed += requeued;
+                open_ns[0] = '\0';
+            }
+            esp_err_t ret = nvs_open(e->ns, NVS_READWRITE, &handle);
+            if (ret != ESP_OK) {
+                ESP_LOGE(TAG, "Error opening namespace '%s': %s", e->ns, esp_err_to_name(ret));
+                requeue(e);
+                failed++;
+                continue;
+            }
+            strcpy(open_ns, e->ns);
+        }
+
+        esp_err_t ret = write_entry(handle, e, payload, len);
+        if (ret == ESP_OK) {
+            in_commit[i] = true;
+            written++;
+        } else if (ret == ESP_ERR_INVALID_STATE) {
+            skipped++;
+        } else {
+            ESP_LOGE(TAG, "Failed to write %s/%s: %s", e->ns, e->key, esp_err_to_name(ret));
+            requeue(e);
+            failed++;
+        }
+    }
+    if (open_ns[0] != '\0') {
+        int requeued = commit_namespace(handle, in_commit);
+        written -= requeued;
+        failed += requeued;
+    }
+
+    mem_budget_free(MEM_TAG_PERSIST, payload);
+    if (written > 0 || skipped > 0 || failed > 0) {
+        ESP_LOGI(TAG, "Write pass: %d written, %d unchanged, %d to retry", written, skipped, failed);
+    }
+    return failed == 0;
+}
+
+// Commit and close a namespace. If the commit fails, the entries written
+// since the last commit are queued again; returns how many.
+static int commit_namespace(nvs_handle_t handle, bool *in_commit)
+{
+    esp_err_t ret = nvs_commit(handle);
+    nvs_close(handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Commit failed: %s", esp_err_to_name(ret));
+    }
+
+    int requeued = 0;
+    for (int i = 0; i < PERSIST_MAX_ENTRIES; i++) {
+        if (in_commit[i] && ret != ESP_OK) {
+            requeue(&s_entries[i]);
+            requeued++;
+        }
+        in_commit[i] = false;
+    }
+    return requeued;
+}
+
+// Mark a failed entry dirty again. A newer write already did that (with
+// newer contents), and a discard means it must not be written at all.
+static void requeue(persist_entry_t *e)
+{
+    e->loaded = false;  // Slot state may no longer match flash
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    if (!e->dirty && !e->reset) {
+        e->dirty = true;
+    }
+    xSemaphoreGive(s_mutex);
+}
+
+// Write a blob to the older slot. ESP_ERR_INVALID_STATE = unchanged, skipped.
+static esp_err_t write_entry(nvs_handle_t handle, persist_entry_t *e, const uint8_t *payload, size_t len)
+{
+    if (!e->loaded) {
+        load_slots(handle, e);
+    }
+    if (e->newest_slot >= 0 && e->newest_len == len &&
+        e->newest_crc == payload_crc(e->newest_seq, payload, len)) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (!reserve(&s_work, &s_work_cap, sizeof(slot_header_t) + len)) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    slot_header_t *hdr = (slot_header_t *)s_work;
+    memset(hdr, 0, sizeof(*hdr));
+    hdr->magic = PERSIST_MAGIC;
+    hdr->format = PERSIST_FORMAT;
+    hdr->seq = e->newest_seq + 1;
+    hdr->len = len;
+    hdr->crc = payload_crc(hdr->seq, payload, len);
+    memcpy(s_work + sizeof(*hdr), payload, len);
+
+    // Never overwrite the newest valid copy
+    int slot = e->newest_slot == 0 ? 1 : 0;
+    char key[NVS_KEY_NAME_MAX_SIZE];
+    slot_key(key, sizeof(key), e->key, slot);
+    esp_err_t ret = nvs_set_blob(handle, key, s_work, sizeof(*hdr) + len);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    e->newest_slot = slot;
+    e->newest_seq = hdr->seq;
+    e->newest_crc = hdr->crc;
+    e->newest_len = len;
+    return ESP_OK;
+}
+
+static void load_slots(nvs_handle_t handle, persist_entry_t *e)
+{
+    uint8_t *blob = NULL;
+    slot_header_t hdr;
+    e->newest_slot = read_newest(handle, e->key, &blob, &hdr);
+    e->newest_seq = e->newest_slot >= 0 ? hdr.seq : 0;
+    e->newest_crc = e->newest_slot >= 0 ? hdr.crc : 0;
+    e->newest_len = e->newest_slot >= 0 ? hdr.len : 0;
+    e->loaded = true;
+    mem_budget_free(MEM_TAG_PERSIST, blob);
+}
+
+// Newest valid slot (0/1) with its blob, or -1. The caller frees the blob.
+static int read_newest(nvs_handle_t handle, const char *key, uint8_t **out_blob, slot_header_t *out_hdr)
+{
+    uint8_t *blobs[2] = {NULL, NULL};
+    slot_header_t hdrs[2];
+    bool valid[2];
+    for (int slot = 0; slot < 2; slot++) {
+        valid[slot] = read_slot(handle, key, slot, &blobs[slot], &hdrs[slot]);
+    }
+
+    int newest = -1;
+    if (valid[0] && valid[1]) {
+        newest = hdrs[1].seq > hdrs[0].seq ? 1 : 0;
+    } else if (valid[0] || valid[1]) {
+        newest = valid[0] ? 0 : 1;
+        ESP_LOGW(TAG, "Key '%s': only slot %d is valid", key, newest);
+    }
+
+    *out_blob = NULL;
+    if (newest >= 0) {
+        *out_blob = blobs[newest];
+        *out_hdr = hdrs[newest];
+        blobs[newest] = NULL;
+    }
+    mem_budget_free(MEM_TAG_PERSIST, blobs[0]);
+    mem_budget_free(MEM_TAG_PERSIST, blobs[1]);
+    return newest;
+}
+
+static bool read_slot(nvs_handle_t handle, const char *key, int slot, uint8_t **out_blob, slot_header_t *out_hdr)
+{
+    char name[NVS_KEY_NAME_MAX_SIZE];
+    slot_key(name, sizeof(name), key, slot);
+
+    size_t size = 0;
+    if (nvs_get_blob(handle, name, NULL, &size) != ESP_OK || size < sizeof(slot_header_t)) {
+        return false;
+    }
+    uint8_t *blob = mem_budget_malloc(MEM_TAG_PERSIST, size, MALLOC_CAP_8BIT);
+    if (blob == NULL) {
+        return false;
+    }
+    if (nvs_get_blob(handle, name, blob, &size) != ESP_OK) {
+        mem_budget_free(MEM_TAG_PERSIST, blob);
+        return false;
+    }
+
+    slot_header_t hdr;
+    memcpy(&hdr, blob, sizeof(hdr));
+    if (hdr.magic != PERSIST_MAGIC || hdr.format != PERSIST_FORMAT ||
+        hdr.len != size - sizeof(hdr) ||
+        hdr.crc != payload_crc(hdr.seq, blob + sizeof(hdr), hdr.len)) {
+        ESP_LOGW(TAG, "Key '%s' slot %d is corrupt, ignoring", key, slot);
+        mem_budget_free(MEM_TAG_PERSIST, blob);
+        return false;
+    }
+
+    *out_blob = blob;
+    *out_hdr = hdr;
+    return true;
+}
+
+static void slot_key(char *out, size_t size, const char *key, int slot)
+{
+    snprintf(out, size, "%s_%d", key, slot);
+}
+
+static uint32_t payload_crc(uint32_t seq, const uint8_t *payload, size_t len)
+{
+    uint32_t crc = esp_rom_crc32_le(0, (const uint8_t *)&seq, sizeof(seq));
+    return esp_rom_crc32_le(crc, payload, len);
+}
+
+// Caller holds s_mutex
+static persist_entry_t *find_entry(const char *ns, const char *key)
+{
+    for (int i = 0; i < PERSIST_MAX_ENTRIES; i++) {
+        if (s_entries[i].key[0] != '\0' && strcmp(s_entries[i].key, key) == 0 &&
+            strcmp(s_entries[i].ns, ns) == 0) {
+            return &s_entries[i];
+        }
+    }
+    return NULL;
+}
+
+static bool reserve(uint8_t **buf, size_t *cap, size_t len)
+{
+    if (*cap >= len) {
+        return true;
+    }
+    uint8_t *grown = mem_budget_realloc(MEM_TAG_PERSIST, *buf, len, MALLOC_CAP_8BIT);
+    if (grown == NULL) {
+        return false;
+    }
+    *buf = grown;
+    *cap = len;
+    return true;
+}
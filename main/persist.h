@@ -0,0 +1,60 @@
+/*
+ * Background Persistence
+ * Moves NVS writes off the calling task. Callers hand over a whole blob
+ * per namespace/key; a low-priority task coalesces bursts of saves,
+ * skips blobs identical to what is already in flash and commits once
+ * per namespace per pass.
+ *
+ * Each key is stored in two slots ("<key>_0" and "<key>_1") that are
+ * written alternately. A slot carries a sequence number and a CRC, so a
+ * write torn by a reset leaves the previous slot as the valid copy.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#define PERSIST_KEY_MAX 13  // NVS key limit (15) minus the slot suffix
+
+/**
+ * @brief Start the persistence task
+ * nvs_flash_init() must have succeeded. persist_read() works before this.
+ * @return true on success
+ */
+bool persist_init(void);
+
+/**
+ * @brief Queue a blob for writing
+ * The data is copied; a newer write to the same key before the task runs
+ * replaces it. Never touches flash, so it is safe on the LVGL task.
+ * Keys are written in the order they were first queued.
+ * @param ns NVS namespace (max 15 chars)
+ * @param key Key (max PERSIST_KEY_MAX chars)
+ * @param data Blob contents
+ * @param len Blob size in bytes
+ * @return ESP_OK once queued, ESP_ERR_NO_MEM if no entry or buffer is free
+ */
+esp_err_t persist_write(const char *ns, const char *key, const void *data, size_t len);
+
+/**
+ * @brief Read the newest blob for a key
+ * Returns a queued but unwritten blob if there is one, otherwise the
+ * newest slot whose CRC checks out. Blocks for the flash read.
+ * @param ns NVS namespace
+ * @param key Key
+ * @param data Buffer to fill
+ * @param len In: buffer size. Out: blob size
+ * @return ESP_OK, ESP_ERR_NVS_NOT_FOUND if no valid slot, or
+ *         ESP_ERR_NVS_INVALID_LENGTH if the blob is larger than the buffer
+ */
+esp_err_t persist_read(const char *ns, const char *key, void *data, size_t *len);
+
+/**
+ * @brief Drop queued writes for a namespace and forget its slot state
+ * Call before erasing the namespace.
+ * @param ns NVS namespace
+ */
+void persist_discard(const char *ns);
@@ -0,0 +1,167 @@
+/*
+ * Adaptive Poll Scheduler Implementation
+ *
+ * Traffic is measured as the number of tracks a poll created or moved
+ * (reports identical to the stored fix don't count), which grows with
+ * both density and movement. Its moving average maps linearly onto
+ * ADSB_POLL_IDLE_MS .. ADSB_POLL_MIN_MS between the quiet and busy
+ * thresholds.
+ */
+
+#include "poll_scheduler.h"
+#include "radar_config.h"
+#include "esp_log.h"
+#include "esp_random.h"
+
+static const char *TAG = "poll_scheduler";
+
+#define ACTIVITY_ALPHA 0.3f     // Weight of the latest poll in the traffic average
+#define LATENCY_ALPHA 0.25f     // Weight of the latest request in the latency average
+#define BACKOFF_MAX_SHIFT 8     // Stop doubling long before uint32 overflow
+
+// Traffic and latency estimates
+static int s_pending_changes = 0;
+static float s_activity = -1.0f;  // < 0 = no successful poll yet
+static uint32_t s_latency_ms = 0;
+static uint32_t s_interval_ms = ADSB_POLL_INTERVAL_MS;
+
+// Failure state
+static int s_failures = 0;
+static uint32_t s_backoff_ms = 0;
+
+static poll_phase_source_t s_phase_source = NULL;
+
+// Forward declarations
+static uint32_t traffic_interval_ms(float activity);
+static uint32_t jitter_ms(uint32_t range_ms);
+#if ADSB_POLL_ALIGN_SWEEP
+static uint32_t align_to_sweep(uint32_t now_ms, uint32_t interval_ms);
+#endif
+
+void poll_scheduler_init(void)
+{
+    s_pending_changes = 0;
+    s_activity = -1.0f;
+    s_latency_ms = 0;
+    s_interval_ms = ADSB_POLL_INTERVAL_MS;
+    s_failures = 0;
+    s_backoff_ms = 0;
+}
+
+void poll_scheduler_set_phase_source(poll_phase_source_t source)
+{
+    s_phase_source = source;
+}
+
+void poll_scheduler_note_changes(int changed)
+{
+    s_pending_changes += changed;
+}
+
+void poll_scheduler_on_success(uint32_t latency_ms)
+{
+    float changes = (float)s_pending_changes;
+    s_pending_changes = 0;
+    s_failures = 0;
+
+    if (s_activity < 0.0f) {
+        s_activity = changes;
+        s_latency_ms = latency_ms;
+    } else {
+        s_activity += ACTIVITY_ALPHA * (changes - s_activity);
+        s_latency_ms = (uint32_t)((float)s_latency_ms + LATENCY_ALPHA * ((float)latency_ms - (float)s_latency_ms));
+    }
+    s_interval_ms = traffic_interval_ms(s_activity);
+
+    ESP_LOGD(TAG, "%d changed, activity %.1f, latency %lu ms -> interval %lu ms",
+             (int)changes, s_activity, (unsigned long)s_latency_ms, (unsigned long)s_interval_ms);
+}
+
+void poll_scheduler_on_failure(int status_code, int retry_after_s)
+{
+    s_pending_changes = 0;
+    s_failures++;
+
+    // Equal jitter: half the doubled interval fixed, half random, so a
+    // fleet of displays that failed together doesn't retry together
+    int shift = s_failures - 1 < BACKOFF_MAX_SHIFT ? s_failures - 1 : BACKOFF_MAX_SHIFT;
+    uint32_t backoff = (uint32_t)ADSB_POLL_INTERVAL_MS << shift;
+    if (backoff > ADSB_MAX_BACKOFF_MS) {
+        backoff = ADSB_MAX_BACKOFF_MS;
+    }
+    s_backoff_ms = backoff / 2 + jitter_ms(backoff / 2);
+
+    // The server's Retry-After is a floor, never shortened by jitter
+    if (retry_after_s > 0) {
+        uint32_t retry_ms = (uint32_t)retry_after_s * 1000;
+        retry_ms += jitter_ms(retry_ms / 10);
+        if (retry_ms > s_backoff_ms) {
+            s_backoff_ms = retry_ms;
+        }
+    }
+
+    if (status_code == 429 || status_code == 503) {
+        ESP_LOGW(TAG, "Server busy (HTTP %d, Retry-After %d s), next poll in %lu s",
+                 status_code, retry_after_s, (unsigned long)(s_backoff_ms / 1000));
+    }
+}
+
+uint32_t poll_scheduler_next_delay_ms(uint32_t now_ms)
+{
+    if (s_failures > 0) {
+        return s_backoff_ms;
+    }
+#if ADSB_POLL_ALIGN_SWEEP
+    if (s_phase_source != NULL) {
+        return align_to_sweep(now_ms, s_interval_ms);
+    }
+#endif
+    (void)now_ms;
+    return s_interval_ms;
+}
+
+// Internal functions
+
+static uint32_t traffic_interval_ms(float activity)
+{
+    if (activity <= ADSB_POLL_QUIET_CHANGES) {
+        return ADSB_POLL_IDLE_MS;
+    }
+    if (activity >= ADSB_POLL_BUSY_CHANGES) {
+        return ADSB_POLL_MIN_MS;
+    }
+    float t = (activity - ADSB_POLL_QUIET_CHANGES) / (float)(ADSB_POLL_BUSY_CHANGES - ADSB_POLL_QUIET_CHANGES);
+    return (uint32_t)(ADSB_POLL_IDLE_MS + t * (float)(ADSB_POLL_MIN_MS - ADSB_POLL_IDLE_MS));
+}
+
+static uint32_t jitter_ms(uint32_t range_ms)
+{
+    return range_ms > 0 ? esp_random() % range_ms : 0;
+}
+
+#if ADSB_POLL_ALIGN_SWEEP
+// Move the poll so the response (start + average latency) lands on the
+// North crossing nearest to where the traffic interval would put it.
+// Intervals under half a rotation are left alone: alignment would
+// double or drop them.
+static uint32_t align_to_sweep(uint32_t now_ms, uint32_t interval_ms)
+{
+    uint32_t north_ms, period_ms;
+    if (!s_phase_source(&north_ms, &period_ms) || period_ms == 0 || interval_ms * 2 < period_ms) {
+        return interval_ms;
+    }
+
+    uint32_t land_ms = now_ms + interval_ms;
+    uint32_t phase_ms = (land_ms - north_ms) % period_ms;
+    uint32_t crossing_ms = land_ms - phase_ms;
+    if (phase_ms > period_ms / 2) {
+        crossing_ms += period_ms;
+    }
+
+    uint32_t start_ms = crossing_ms - s_latency_ms;
+    while ((int32_t)(start_ms - now_ms) < ADSB_POLL_MIN_MS) {
+        start_ms += period_ms;
+    }
+    return start_ms - now_ms;
+}
+#endif
@@ -0,0 +1,61 @@
+/*
+ * Adaptive Poll Scheduler
+ * Picks the delay before the next ADSB API poll: shorter while many
+ * aircraft are changing, longer when traffic is quiet, jittered backoff
+ * after failures, Retry-After on 429/503, and optionally timed so the
+ * response lands as the sweep crosses North.
+ *
+ * Only the poll task calls the on_* and next_delay functions, so the
+ * scheduler keeps no lock.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Reports the sweep's phase for poll alignment
+ * @param north_ms Tick time (ms) of the last North crossing
+ * @param period_ms Measured rotation period (ms)
+ * @return false while the sweep is not running
+ */
+typedef bool (*poll_phase_source_t)(uint32_t *north_ms, uint32_t *period_ms);
+
+/**
+ * @brief Reset to ADSB_POLL_INTERVAL_MS with no traffic history
+ */
+void poll_scheduler_init(void);
+
+/**
+ * @brief Set the sweep phase source used when ADSB_POLL_ALIGN_SWEEP is on
+ * @param source Phase callback, or NULL to disable alignment
+ */
+void poll_scheduler_set_phase_source(poll_phase_source_t source);
+
+/**
+ * @brief Count tracks that changed while the current response streams in
+ * @param changed New or moved tracks from one store update
+ */
+void poll_scheduler_note_changes(int changed);
+
+/**
+ * @brief Record a successful poll
+ * Folds the changes noted since the last poll into the traffic estimate.
+ * @param latency_ms Request start to last byte
+ */
+void poll_scheduler_on_success(uint32_t latency_ms);
+
+/**
+ * @brief Record a failed poll
+ * @param status_code HTTP status (0 if the request never completed)
+ * @param retry_after_s Server's Retry-After in seconds (0 if none)
+ */
+void poll_scheduler_on_failure(int status_code, int retry_after_s);
+
+/**
+ * @brief Get the delay before the next poll
+ * @param now_ms Current tick time in ms
+ * @return Milliseconds to wait
+ */
+uint32_t poll_scheduler_next_delay_ms(uint32_t now_ms);
@@ -0,0 +1,147 @@
+/*
+ * PPI Repaint Scheduler Implementation
+ *
+ * Buckets are a counting sort of the snapshot's indices by sector: one
+ * pass to count, one to place, so a snapshot costs O(n) plus one bearing
+ * per aircraft, and a sector's aircraft are a contiguous slice.
+ *
+ * Decay is a lookup by how many sectors the sweep is past the blip. The
+ * table is flat within a decay level, so a held blip's opacity only
+ * changes when the sweep crosses one of the PPI_DECAY_LEVELS level
+ * boundaries behind it.
+ */
+
+#include "ppi_scheduler.h"
+#include "radar_math.h"
+#include "radar_config.h"
+#include "esp_log.h"
+#include "mem_budget.h"
+#include "esp_heap_caps.h"
+#include <string.h>
+
+static const char *TAG = "ppi_scheduler";
+
+#define SECTOR_DECIDEG (PPI_SECTOR_DEGREES * 10)
+#define NO_SECTOR 0xFF
+
+// Buckets: sector s holds s_order[s_start[s] .. s_start[s + 1])
+static int16_t *s_order = NULL;
+static uint8_t *s_sector_of = NULL;  // Scratch: sector of each snapshot index
+static int16_t s_start[PPI_SECTORS + 1];
+static int s_capacity = 0;
+static uint32_t s_generation = 0;
+static bool s_bucketed = false;
+
+static int s_sweep_sector = -1;      // -1 = repaint everything on the next advance
+static uint8_t s_decay_opa[PPI_SECTORS];  // By sectors behind the sweep
+
+// Forward declarations
+static void build_decay_table(void);
+
+bool ppi_scheduler_init(int capacity)
+{
+    s_order = mem_budget_calloc(MEM_TAG_RENDER, capacity, sizeof(int16_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    s_sector_of = mem_budget_calloc(MEM_TAG_RENDER, capacity, sizeof(uint8_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (s_order == NULL || s_sector_of == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate sector buckets (%d aircraft)", capacity);
+        return false;
+    }
+    s_capacity = capacity;
+    memset(s_start, 0, sizeof(s_start));
+    build_decay_table();
+    ppi_scheduler_reset();
+
+    ESP_LOGI(TAG, "PPI: %d sectors of %d°, %d decay levels", PPI_SECTORS, PPI_SECTOR_DEGREES, PPI_DECAY_LEVELS);
+    return true;
+}
+
+void ppi_scheduler_reset(void)
+{
+    s_sweep_sector = -1;
+    s_bucketed = false;
+}
+
+bool ppi_scheduler_advance(int sweep_decideg, ppi_span_t *out_span)
+{
+    int sector = (sweep_decideg / SECTOR_DECIDEG) % PPI_SECTORS;
+    if (sector == s_sweep_sector) {
+        return false;
+    }
+
+    if (s_sweep_sector < 0) {
+        out_span->first = (sector + 1) % PPI_SECTORS;  // Oldest first; ends under the sweep
+        out_span->count = PPI_SECTORS;
+    } else {
+        // Usually one sector; more if frames were late
+        out_span->first = (s_sweep_sector + 1) % PPI_SECTORS;
+        out_span->count = (sector - s_sweep_sector + PPI_SECTORS) % PPI_SECTORS;
+    }
+    s_sweep_sector = sector;
+    return true;
+}
+
+void ppi_scheduler_bucket(uint32_t generation, const tracked_aircraft_t *aircraft, int count, int range_nm)
+{
+    if (s_order == NULL || (s_bucketed && generation == s_generation)) {
+        return;
+    }
+    if (count > s_capacity) {
+        count = s_capacity;
+    }
+
+    int counts[PPI_SECTORS] = {0};
+    for (int i = 0; i < count; i++) {
+        s_sector_of[i] = NO_SECTOR;
+        if (aircraft[i].distance_nm > range_nm) {
+            continue;
+        }
+        int sector = radar_math_decideg(aircraft_store_bearing_deg(&aircraft[i])) / SECTOR_DECIDEG;
+        s_sector_of[i] = (uint8_t)sector;
+        counts[sector]++;
+    }
+
+    s_start[0] = 0;
+    for (int s = 0; s < PPI_SECTORS; s++) {
+        s_start[s + 1] = (int16_t)(s_start[s] + counts[s]);
+        counts[s] = s_start[s];  // Now the next free position in the bucket
+    }
+    for (int i = 0; i < count; i++) {
+        if (s_sector_of[i] != NO_SECTOR) {
+            s_order[counts[s_sector_of[i]]++] = (int16_t)i;
+        }
+    }
+
+    s_generation = generation;
+    s_bucketed = true;
+}
+
+const int16_t *ppi_scheduler_sector(int sector, int *out_count)
+{
+    *out_count = s_bucketed ? s_start[sector + 1] - s_start[sector] : 0;
+    return &s_order[s_start[sector]];
+}
+
+bool ppi_scheduler_in_span(const ppi_span_t *span, int sector)
+{
+    return (sector - span->first + PPI_SECTORS) % PPI_SECTORS < span->count;
+}
+
+uint8_t ppi_scheduler_opacity(int sector)
+{
+    int behind = s_sweep_sector < 0 ? 0 : (s_sweep_sector - sector + PPI_SECTORS) % PPI_SECTORS;
+    return s_decay_opa[behind];
+}
+
+// Internal functions
+
+// Quadratic fade from full to the floor, flat within each decay level
+static void build_decay_table(void)
+{
+    const int floor_opa = 255 * PPI_DECAY_FLOOR_PCT / 100;
+    for (int behind = 0; behind < PPI_SECTORS; behind++) {
+        int level = behind * PPI_DECAY_LEVELS / PPI_SECTORS;
+        int remain = PPI_DECAY_LEVELS - 1 - level;
+        int span = PPI_DECAY_LEVELS - 1 > 0 ? PPI_DECAY_LEVELS - 1 : 1;
+        s_decay_opa[behind] = (uint8_t)(floor_opa + (255 - floor_opa) * remain * remain / (span * span));
+    }
+}
@@ -0,0 +1,84 @@
+/*
+ * PPI Repaint Scheduler
+ * Decides which blips the batched renderer repaints on each sweep frame.
+ * The scope is split into PPI_SECTOR_DEGREES sectors and the aircraft of
+ * each snapshot are bucketed by the sector of their bearing; a sector's
+ * blips are repainted only as the sweep enters it. Between passes a blip
+ * fades through PPI_DECAY_LEVELS quantised opacity steps, so its
+ * opacity changes (and it is redrawn) only a few times per rotation
+ * instead of every frame.
+ *
+ * Runs on the LVGL task only, so it keeps no lock.
+ */
+
+#pragma once
+
+#include "aircraft_store.h"
+#include "radar_config.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define PPI_SECTORS (360 / PPI_SECTOR_DEGREES)
+
+// Sectors entered by the sweep since the previous frame
+typedef struct {
+    int first;           // First sector entered
+    int count;           // Sectors entered (PPI_SECTORS = repaint everything)
+} ppi_span_t;
+
+/**
+ * @brief Allocate the buckets
+ * @param capacity Maximum aircraft per snapshot (store capacity)
+ * @return true on success
+ */
+bool ppi_scheduler_init(int capacity);
+
+/**
+ * @brief Repaint every sector on the next advance (zoom, mode switch)
+ * Also forces the next snapshot to be bucketed again.
+ */
+void ppi_scheduler_reset(void);
+
+/**
+ * @brief Move the sweep
+ * @param sweep_decideg Sweep bearing in decidegrees (0 = North, clockwise)
+ * @param out_span Sectors to repaint
+ * @return true if the sweep entered at least one new sector
+ */
+bool ppi_scheduler_advance(int sweep_decideg, ppi_span_t *out_span);
+
+/**
+ * @brief Bucket a snapshot's aircraft by sector
+ * Skips the work if the snapshot generation was already bucketed.
+ * Aircraft beyond range_nm are left out.
+ * @param generation Snapshot generation
+ * @param aircraft Snapshot aircraft
+ * @param count Number of aircraft
+ * @param range_nm Scope range
+ */
+void ppi_scheduler_bucket(uint32_t generation, const tracked_aircraft_t *aircraft, int count, int range_nm);
+
+/**
+ * @brief Get the aircraft bucketed into a sector
+ * @param sector Sector index
+ * @param out_count Number of entries
+ * @return Indices into the bucketed snapshot
+ */
+const int16_t *ppi_scheduler_sector(int sector, int *out_count);
+
+/**
+ * @brief Check whether a sector is part of a span
+ * @param span Span from ppi_scheduler_advance()
+ * @param sector Sector index
+ * @return true if the sector is being repainted
+ */
+bool ppi_scheduler_in_span(const ppi_span_t *span, int sector);
+
+/**
+ * @brief Opacity of a blip painted in a sector, given where the sweep is now
+ * Full for the sector under the sweep, quantised down to
+ * PPI_DECAY_FLOOR_PCT just before the next pass.
+ * @param sector Sector the blip was painted in
+ * @return Opacity (0-255)
+ */
+uint8_t ppi_scheduler_opacity(int sector);
@@ -0,0 +1,100 @@
+/*
+ * Radar Math Implementation
+ *
+ * One quarter wave of sine is stored (0-90° at 0.1°, 901 entries, 3.6 KB
+ * of internal RAM); the other quadrants are mirrors of it. Products of
+ * two Q16 values are formed in 64 bits and rounded to the nearest pixel,
+ * which also removes the one-pixel bias that truncating float casts had
+ * around the scope centre.
+ */
+
+#include "radar_math.h"
+#include "radar_config.h"
+#include "esp_log.h"
+#include <math.h>
+#include <stdbool.h>
+
+static const char *TAG = "radar_math";
+
+static q16_t s_quarter_sin[RADAR_MATH_DECIDEG_QUARTER + 1];
+static bool s_ready = false;
+
+// Forward declarations
+static int wrap_decideg(int decideg);
+static int round_q32(int64_t value);
+
+void radar_math_init(void)
+{
+    if (s_ready) {
+        return;
+    }
+    for (int i = 0; i <= RADAR_MATH_DECIDEG_QUARTER; i++) {
+        double rad = (double)i * M_PI / (2.0 * RADAR_MATH_DECIDEG_QUARTER);
+        s_quarter_sin[i] = (q16_t)lround(sin(rad) * Q16_ONE);
+    }
+    s_ready = true;
+    ESP_LOGI(TAG, "Sine table ready (%d entries, %u bytes)",
+             RADAR_MATH_DECIDEG_QUARTER + 1, (unsigned)sizeof(s_quarter_sin));
+}
+
+int radar_math_decideg(float degrees)
+{
+    return wrap_decideg((int)lrintf(degrees * 10.0f));
+}
+
+q16_t radar_math_sin(int decideg)
+{
+    int d = wrap_decideg(decideg);
+    int quadrant = d / RADAR_MATH_DECIDEG_QUARTER;
+    int offset = d - quadrant * RADAR_MATH_DECIDEG_QUARTER;
+
+    switch (quadrant) {
+        case 0:
+            return s_quarter_sin[offset];
+        case 1:
+            return s_quarter_sin[RADAR_MATH_DECIDEG_QUARTER - offset];
+        case 2:
+            return -s_quarter_sin[offset];
+        default:
+            return -s_quarter_sin[RADAR_MATH_DECIDEG_QUARTER - offset];
+    }
+}
+
+q16_t radar_math_cos(int decideg)
+{
+    return radar_math_sin(decideg + RADAR_MATH_DECIDEG_QUARTER);
+}
+
+void radar_math_polar(q16_t radius_px, int bearing_decideg, int *out_dx, int *out_dy)
+{
+    // Bearing 0 = North (screen up), clockwise: x = r sin, y = -r cos
+    *out_dx = round_q32((int64_t)radius_px * radar_math_sin(bearing_decideg));
+    *out_dy = -round_q32((int64_t)radius_px * radar_math_cos(bearing_decideg));
+}
+
+void radar_math_project(q16_t east_nm, q16_t north_nm, q16_t px_per_nm, int *out_dx, int *out_dy)
+{
+    *out_dx = round_q32((int64_t)east_nm * px_per_nm);
+    *out_dy = -round_q32((int64_t)north_nm * px_per_nm);
+}
+
+alt_band_t radar_math_altitude_band(int altitude_ft)
+{
+    return (alt_band_t)((altitude_ft >= ALT_GROUND_THRESHOLD) +
+                        (altitude_ft >= ALT_LOW_THRESHOLD) +
+                        (altitude_ft >= ALT_MED_THRESHOLD));
+}
+
+// Internal functions
+
+static int wrap_decideg(int decideg)
+{
+    decideg %= RADAR_MATH_DECIDEG_FULL;
+    return decideg < 0 ? decideg + RADAR_MATH_DECIDEG_FULL : decideg;
+}
+
+// Q32 (product of two Q16 values) to the nearest integer
+static int round_q32(int64_t value)
+{
+    return (int)((value + ((int64_t)1 << 31)) >> 32);
+}
@@ -0,0 +1,90 @@
+/*
+ * Radar Math
+ * Table-driven trig and Q16.16 fixed-point helpers for the per-frame
+ * render paths: dead reckoning, screen projection, trails, velocity
+ * vectors and the sweep. Angles are integer decidegrees (0-3599) on the
+ * bearing convention (0 = North, clockwise), so a lookup is an index and
+ * a sign, with no float trig or range reduction.
+ *
+ * Has no LVGL dependency and builds for the linux target.
+ */
+
+#pragma once
+
+#include <math.h>
+#include <stdint.h>
+
+typedef int32_t q16_t;                   // Signed Q16.16 fixed point
+
+#define Q16_ONE (1 << 16)
+#define Q16_FROM_FLOAT(f) ((q16_t)lrintf((f) * (float)Q16_ONE))
+#define Q16_TO_FLOAT(q) ((float)(q) * (1.0f / Q16_ONE))
+
+#define RADAR_MATH_DECIDEG_FULL 3600     // One turn
+#define RADAR_MATH_DECIDEG_QUARTER 900
+
+// Altitude bands (index into a per-band colour table)
+typedef enum {
+    ALT_BAND_GROUND = 0,     // < ALT_GROUND_THRESHOLD
+    ALT_BAND_LOW,            // < ALT_LOW_THRESHOLD
+    ALT_BAND_MED,            // < ALT_MED_THRESHOLD
+    ALT_BAND_HIGH,
+    ALT_BAND_COUNT
+} alt_band_t;
+
+/**
+ * @brief Fill the sine table
+ * Safe to call more than once; aircraft_store_init() and
+ * radar_renderer_init() call it before their first lookup.
+ */
+void radar_math_init(void);
+
+/**
+ * @brief Convert degrees to decidegrees, rounded and wrapped into 0-3599
+ * @param degrees Angle in degrees (any range)
+ * @return Decidegrees
+ */
+int radar_math_decideg(float degrees);
+
+/**
+ * @brief Sine of an angle
+ * @param decideg Decidegrees (any range; wrapped)
+ * @return sin() in Q16
+ */
+q16_t radar_math_sin(int decideg);
+
+/**
+ * @brief Cosine of an angle
+ * @param decideg Decidegrees (any range; wrapped)
+ * @return cos() in Q16
+ */
+q16_t radar_math_cos(int decideg);
+
+/**
+ * @brief Screen offset of a point at a bearing and distance
+ * Screen axes: X right, Y down. Rounded to the nearest pixel.
+ * @param radius_px Distance in pixels (Q16)
+ * @param bearing_decideg Bearing (0 = North, clockwise)
+ * @param out_dx X offset from the origin in pixels
+ * @param out_dy Y offset from the origin in pixels
+ */
+void radar_math_polar(q16_t radius_px, int bearing_decideg, int *out_dx, int *out_dy);
+
+/**
+ * @brief Screen offset of an east/north offset
+ * The same rounding as radar_math_polar(), so straight-line and polar
+ * projections land on the same pixel grid.
+ * @param east_nm East offset in NM (Q16)
+ * @param north_nm North offset in NM (Q16)
+ * @param px_per_nm Scale (Q16)
+ * @param out_dx X offset in pixels
+ * @param out_dy Y offset in pixels
+ */
+void radar_math_project(q16_t east_nm, q16_t north_nm, q16_t px_per_nm, int *out_dx, int *out_dy);
+
+/**
+ * @brief Altitude band of an altitude (no branches)
+ * @param altitude_ft Altitude in feet
+ * @return Band
+ */
+alt_band_t radar_math_altitude_band(int altitude_ft);
@@ -4,11 +4,20 @@
 
 #include "radar_renderer.h"
 #include "aircraft_store.h"
+#include "background_layer.h"
+#include "blip_layer.h"
+#include "sweep_layer.h"
+#include "icao_index.h"
+#include "perf_stats.h"
+#include "render_lod.h"
+#include "radar_math.h"
+#include "ppi_scheduler.h"
 #include "radar_config.h"
 #include "wifi.h"
 #include "bsp/esp-bsp.h"
 #include "esp_log.h"
-#include <math.h>
+#include "mem_budget.h"
+#include "esp_heap_caps.h"
 #include <string.h>
 #include <time.h>
 
@@ -18,23 +27,19 @@ static const char *TAG = "radar_renderer";
 static char s_display_label[32] = "RADAR - 50NM";  // Default label
 static float s_sweep_degrees_per_frame = SWEEP_DEGREES_PER_FRAME;  // Default from radar_config.h
 static bool s_show_aircraft_labels = true;  // Default: show labels
+static uint8_t s_render_mode = RADAR_RENDER_MODE;  // Widgets or batched blip layer
+static int s_radar_radius_nm = RADAR_RADIUS_NM;  // Current zoom range; aircraft beyond it are not drawn
+
+// Zoom levels, innermost first; the last is the configured radius
+static int s_zoom_levels[RADAR_ZOOM_MAX_LEVELS];
+static int s_zoom_count = 0;
+static int s_zoom_index = 0;
+static int s_max_range_nm = RADAR_RADIUS_NM;
 
 // UI elements
 static lv_obj_t *s_radar_container = NULL;
-static lv_obj_t *s_title_label = NULL;
 static lv_obj_t *s_status_label = NULL;  // Aircraft count + last update
-static lv_obj_t *s_ring_10nm = NULL;
-static lv_obj_t *s_ring_25nm = NULL;
-static lv_obj_t *s_ring_50nm = NULL;
-static lv_obj_t *s_cardinal_n = NULL;
-static lv_obj_t *s_cardinal_e = NULL;
-static lv_obj_t *s_cardinal_s = NULL;
-static lv_obj_t *s_cardinal_w = NULL;
-static lv_obj_t *s_sweep_line = NULL;
-static lv_obj_t *s_sweep_trail = NULL;
-
-// Distance ring labels (12 total: 3 rings × 4 positions)
-static lv_obj_t *s_ring_labels[12] = {NULL};
+static volatile bool s_stale = false;     // Showing the boot snapshot, not live data
 
 // Clock display
 static lv_obj_t *s_clock_label = NULL;
@@ -48,15 +53,34 @@ static lv_obj_t *s_config_label = NULL;
 typedef void (*config_button_callback_t)(void);
 static config_button_callback_t s_config_callback = NULL;
 
+// Zoom buttons (either side of the config button)
+static lv_obj_t *s_zoom_out_button = NULL;
+static lv_obj_t *s_zoom_in_button = NULL;
+
 // Sweep animation state
 static lv_timer_t *s_sweep_timer = NULL;
-static float s_sweep_angle = 0.0f;  // Current angle in degrees (0-360)
+static uint32_t s_sweep_phase = 0;  // Current angle, one turn = 2^32 (wraps at North)
+static uint32_t s_sweep_step = 0;   // Phase advance per frame
+static volatile uint32_t s_sweep_north_ms = 0;   // Last North crossing (0 = not running)
+static volatile uint32_t s_sweep_period_ms = 0;  // Measured rotation period
+
+// Debug overlay (perf_stats table)
+static lv_obj_t *s_debug_label = NULL;
+static lv_timer_t *s_debug_timer = NULL;
+
+// Aircraft updates are pulled from the store on the LVGL task
+static lv_timer_t *s_aircraft_timer = NULL;
+static uint32_t s_rendered_generation = 0;  // Last snapshot drawn
+static render_lod_t s_applied_lod = RENDER_LOD_FULL;  // Detail tier of the last update
+static uint32_t s_apply_count = 0;
+
+// Aircraft selected by tapping its blip (batched mode)
+static uint32_t s_selected_icao = ICAO_KEY_INVALID;
 
 // Aircraft rendering
-#define MAX_AIRCRAFT_BLIPS 64
 #define VELOCITY_VECTOR_SCALE 0.2f  // Pixels per knot of speed
 typedef struct {
-    char hex[8];           // Aircraft ID for tracking
+    uint32_t icao;         // Aircraft ID for tracking (integer ICAO key)
     lv_obj_t *blip;        // Circle blip
     lv_obj_t *label_cs;    // Callsign label
     lv_obj_t *label_alt;   // Altitude label
@@ -64,25 +88,58 @@ typedef struct {
     bool active;
 } aircraft_blip_t;
 
-static aircraft_blip_t s_blips[MAX_AIRCRAFT_BLIPS];
+static aircraft_blip_t *s_blips = NULL;  // Sized to the store capacity
+static int s_blip_capacity = 0;
 static int s_blip_count = 0;
+static icao_index_t s_blip_index;  // ICAO -> blip slot
 
 // Velocity vector line points (persistent storage for LVGL)
-static lv_point_precise_t s_velocity_points[MAX_AIRCRAFT_BLIPS][2];
+static lv_point_precise_t (*s_velocity_points)[2] = NULL;
+
+// Which parts of a blip the current detail tier draws (batched mode)
+typedef struct {
+    bool callsign;
+    bool alt;
+    bool vectors;
+    bool trails;
+} blip_detail_t;
+
+// PPI mode: on-screen items replaced by a fresh blip this pass
+static bool *s_ppi_replaced = NULL;
+
+// Blip colour per altitude band, built once
+static lv_color_t s_altitude_colors[ALT_BAND_COUNT];
 
 // Forward declarations
-static void create_distance_rings(lv_obj_t *parent);
-static void create_cardinal_markers(lv_obj_t *parent);
-static void create_distance_ring_labels(lv_obj_t *parent);
 static void create_clock_display(lv_obj_t *parent);
 static void create_sweep_elements(lv_obj_t *parent);
 static void create_config_button(lv_obj_t *parent);
 static void config_button_event_callback(lv_event_t *e);
+static void radar_click_event_callback(lv_event_t *e);
+static void radar_gesture_event_callback(lv_event_t *e);
+static lv_obj_t *create_zoom_button(lv_obj_t *parent, int x, const char *symbol, int steps);
+static void zoom_button_event_callback(lv_event_t *e);
+static void build_zoom_levels(void);
+static void apply_range(int range_nm);
+static void redraw_now(void);
 static void sweep_timer_callback(lv_timer_t *timer);
 static void clock_timer_callback(lv_timer_t *timer);
+static void aircraft_timer_callback(lv_timer_t *timer);
+static void apply_aircraft(const tracked_aircraft_t *aircraft, int count);
+static const tracked_aircraft_t *find_selected(const tracked_aircraft_t *aircraft, int count);
+static void debug_timer_callback(lv_timer_t *timer);
+static void build_altitude_colors(void);
 static lv_color_t get_altitude_color(int altitude_ft);
-static int find_blip(const char *hex);
+static uint32_t sweep_step_for(float degrees_per_frame);
 static void delete_blip(int index);
+static int update_widget_blips(const tracked_aircraft_t *aircraft, int count);
+static int update_batched_blips(const tracked_aircraft_t *aircraft, int count, bool hold_far);
+static int update_ppi_blips(const ppi_span_t *span);
+static bool ppi_active(void);
+static blip_detail_t current_detail(void);
+static void fill_item(blip_draw_item_t *item, const tracked_aircraft_t *ac, const blip_detail_t *detail);
+static void hold_item(blip_draw_item_t *item, const blip_draw_item_t *last);
+static bool velocity_vector_end(const tracked_aircraft_t *ac, int *end_x, int *end_y);
 
 bool radar_renderer_init(lv_obj_t *parent)
 {
@@ -93,6 +150,9 @@ bool radar_renderer_init(lv_obj_t *parent)
         return false;
     }
 
+    radar_math_init();
+    build_altitude_colors();
+
     // Create radar container (full screen)
     s_radar_container = lv_obj_create(parent);
     if (s_radar_container == NULL) {
@@ -112,14 +172,21 @@ bool radar_renderer_init(lv_obj_t *parent)
     lv_obj_set_style_pad_all(s_radar_container, 0, 0);
     lv_obj_clear_flag(s_radar_container, LV_OBJ_FLAG_SCROLLABLE);
 
-    // Create distance rings (10, 25, 50 nm)
-    create_distance_rings(s_radar_container);
+    // Taps that miss every button land on the container (layers are not clickable)
+    lv_obj_add_event_cb(s_radar_container, radar_click_event_callback, LV_EVENT_CLICKED, NULL);
+    lv_obj_add_event_cb(s_radar_container, radar_gesture_event_callback, LV_EVENT_GESTURE, NULL);
 
-    // Create cardinal direction markers (N, E, S, W)
-    create_cardinal_markers(s_radar_container);
+    if (s_zoom_count == 0) {
+        build_zoom_levels();
+        s_zoom_index = s_zoom_count - 1;
+    }
 
-    // Create distance ring labels (10nm, 25nm, 50nm)
-    create_distance_ring_labels(s_radar_container);
+    // Rings, ring labels, cardinal markers and title are baked into one
+    // cached image drawn under everything else
+    if (!background_layer_init(s_radar_container, s_display_label, s_radar_radius_nm)) {
+        ESP_LOGE(TAG, "Failed to create background layer");
+        return false;
+    }
 
     // Create clock display beneath North marker
     create_clock_display(s_radar_container);
@@ -127,19 +194,21 @@ bool radar_renderer_init(lv_obj_t *parent)
     // Create sweep line and trail
     create_sweep_elements(s_radar_container);
 
-    // Create title label at top
-    s_title_label = lv_label_create(s_radar_container);
-    lv_label_set_text(s_title_label, s_display_label);
-    lv_obj_set_style_text_color(s_title_label,
-                                 lv_color_make(COLOR_SWEEP_R,
-                                             COLOR_SWEEP_G,
-                                             COLOR_SWEEP_B), 0);
-    lv_obj_set_style_text_font(s_title_label, &lv_font_montserrat_16, 0);
-    lv_obj_align(s_title_label, LV_ALIGN_TOP_MID, 0, 20);
+    // Create batched blip layer (above the sweep, below the title/buttons)
+    if (!blip_layer_init(s_radar_container, aircraft_store_get_capacity(),
+                         RADAR_SHOW_TRAILS ? TRACK_HISTORY_POINTS : 0)) {
+        ESP_LOGE(TAG, "Failed to create blip layer");
+        return false;
+    }
+    blip_layer_set_visible(s_render_mode == RENDER_MODE_BATCHED);
 
     // Create config button in top-right
     create_config_button(s_radar_container);
 
+    // Zoom out / in either side of it
+    s_zoom_out_button = create_zoom_button(s_radar_container, SCREEN_CENTER_X - 95, LV_SYMBOL_MINUS, -1);
+    s_zoom_in_button = create_zoom_button(s_radar_container, SCREEN_CENTER_X + 45, LV_SYMBOL_PLUS, 1);
+
     // Create status label at bottom
     s_status_label = lv_label_create(s_radar_container);
     lv_label_set_text(s_status_label, "0 aircraft");
@@ -148,9 +217,26 @@ bool radar_renderer_init(lv_obj_t *parent)
     lv_obj_set_style_text_font(s_status_label, &lv_font_montserrat_12, 0);
     lv_obj_align(s_status_label, LV_ALIGN_BOTTOM_MID, 0, -20);
 
-    // Initialize aircraft blips array
-    memset(s_blips, 0, sizeof(s_blips));
+    // Initialize aircraft blips array (one blip per store slot)
+    s_blip_capacity = aircraft_store_get_capacity();
+    s_blips = mem_budget_calloc(MEM_TAG_RENDER, s_blip_capacity, sizeof(aircraft_blip_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    s_velocity_points = mem_budget_calloc(MEM_TAG_RENDER, s_blip_capacity, sizeof(*s_velocity_points), MALLOC_CAP_SPIRAM);
+    if (s_blip_capacity <= 0 || s_blips == NULL || s_velocity_points == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate blip pool (%d blips)", s_blip_capacity);
+        return false;
+    }
     s_blip_count = 0;
+    if (!icao_index_init(&s_blip_index, s_blip_capacity, MEM_TAG_RENDER)) {
+        ESP_LOGE(TAG, "Failed to allocate blip index");
+        return false;
+    }
+    if (RADAR_PPI) {
+        s_ppi_replaced = mem_budget_calloc(MEM_TAG_RENDER, s_blip_capacity, sizeof(bool), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        if (s_ppi_replaced == NULL || !ppi_scheduler_init(s_blip_capacity)) {
+            ESP_LOGE(TAG, "Failed to allocate PPI state");
+            return false;
+        }
+    }
 
     ESP_LOGI(TAG, "Radar renderer initialized successfully");
     return true;
@@ -167,20 +253,66 @@ void radar_renderer_set_label(const char *label)
         strncpy(s_display_label, label, sizeof(s_display_label) - 1);
         s_display_label[sizeof(s_display_label) - 1] = '\0';
 
-        // Update label if already created
-        if (s_title_label != NULL) {
-            lv_label_set_text(s_title_label, s_display_label);
+        // Re-bake the background if already created
+        if (s_radar_container != NULL) {
+            background_layer_set_title(s_display_label);
         }
 
         ESP_LOGI(TAG, "Display label set to: %s", s_display_label);
     }
 }
 
+void radar_renderer_set_radius(int radius_nm)
+{
+    if (radius_nm <= 0 || (radius_nm == s_max_range_nm && s_zoom_count > 0)) {
+        return;
+    }
+    s_max_range_nm = radius_nm;
+
+    // Zoom back out to the new outermost level
+    build_zoom_levels();
+    s_zoom_index = s_zoom_count - 1;
+    apply_range(radius_nm);
+
+    ESP_LOGI(TAG, "Radar radius set to: %d NM (%d zoom levels)", radius_nm, s_zoom_count);
+}
+
+void radar_renderer_zoom(int steps)
+{
+    if (s_zoom_count == 0) {
+        return;
+    }
+    int index = s_zoom_index - steps;
+    if (index < 0) {
+        index = 0;
+    } else if (index >= s_zoom_count) {
+        index = s_zoom_count - 1;
+    }
+    if (index == s_zoom_index) {
+        return;
+    }
+    s_zoom_index = index;
+    apply_range(s_zoom_levels[index]);
+
+    // Redraw at the new scale now rather than at the next snapshot
+    if (s_radar_container != NULL) {
+        redraw_now();
+    }
+
+    ESP_LOGI(TAG, "Zoom: %d NM (level %d/%d)", s_radar_radius_nm, index + 1, s_zoom_count);
+}
+
+int radar_renderer_get_range(void)
+{
+    return s_radar_radius_nm;
+}
+
 void radar_renderer_set_sweep_rate(float sweep_seconds)
 {
     // Calculate degrees per frame: 360° / (sweep_seconds * 60 FPS)
     float old_rate = s_sweep_degrees_per_frame;
     s_sweep_degrees_per_frame = 360.0f / (sweep_seconds * 60.0f);
+    s_sweep_step = sweep_step_for(s_sweep_degrees_per_frame);
     ESP_LOGI(TAG, "Sweep rate changed: %.2f°/frame -> %.2f°/frame (%.1fs per rotation)",
              old_rate, s_sweep_degrees_per_frame, sweep_seconds);
 }
@@ -191,6 +323,44 @@ void radar_renderer_set_show_labels(bool show_labels)
     ESP_LOGI(TAG, "Aircraft labels %s", show_labels ? "enabled" : "disabled");
 }
 
+void radar_renderer_set_render_mode(uint8_t mode)
+{
+    if (mode != RENDER_MODE_WIDGETS && mode != RENDER_MODE_BATCHED) {
+        ESP_LOGW(TAG, "Invalid render mode: %d", mode);
+        return;
+    }
+    if (mode == s_render_mode) {
+        return;
+    }
+    s_render_mode = mode;
+    ESP_LOGI(TAG, "Render mode: %s", mode == RENDER_MODE_BATCHED ? "batched" : "widgets");
+
+    if (s_radar_container == NULL) {
+        return;  // Applied at init
+    }
+
+    // Tear down the other mode's blips, then redraw from the latest snapshot
+    bsp_display_lock(0);
+    s_selected_icao = ICAO_KEY_INVALID;
+    blip_layer_select(ICAO_KEY_INVALID);
+    if (mode == RENDER_MODE_BATCHED) {
+        for (int i = 0; i < s_blip_capacity; i++) {
+            if (s_blips[i].blip != NULL) {
+                delete_blip(i);
+            }
+        }
+    } else {
+        blip_layer_clear();
+    }
+    blip_layer_set_visible(mode == RENDER_MODE_BATCHED);
+    ppi_scheduler_reset();
+    bsp_display_unlock();
+
+    const aircraft_snapshot_t *snapshot = aircraft_store_acquire_snapshot();
+    radar_renderer_update_aircraft(snapshot->aircraft, snapshot->count);
+    aircraft_store_release_snapshot(snapshot);
+}
+
 void radar_renderer_set_config_callback(config_button_callback_t callback)
 {
     s_config_callback = callback;
@@ -211,6 +381,7 @@ void radar_renderer_pause_sweep(void)
 {
     if (s_sweep_timer != NULL) {
         lv_timer_pause(s_sweep_timer);
+        s_sweep_north_ms = 0;  // Phase is meaningless until the next crossing
         ESP_LOGI(TAG, "Sweep animation paused");
     }
 }
@@ -231,168 +402,69 @@ void radar_renderer_stop_sweep(void)
     if (s_sweep_timer != NULL) {
         lv_timer_del(s_sweep_timer);
         s_sweep_timer = NULL;
+        s_sweep_north_ms = 0;
         ESP_LOGI(TAG, "Sweep animation stopped");
     }
 }
 
-void radar_renderer_debug_overlay(bool enable)
+void radar_renderer_set_stale(bool stale)
 {
-    // TODO: Add debug overlay showing center point and exact ring positions
-    ESP_LOGI(TAG, "Debug overlay %s (not yet implemented)", enable ? "enabled" : "disabled");
+    // Picked up by the next apply; live data always publishes a new snapshot
+    s_stale = stale;
 }
 
-// Internal functions
-
-static void create_distance_rings(lv_obj_t *parent)
-{
-    // 10nm ring (innermost)
-    s_ring_10nm = lv_arc_create(parent);
-    lv_obj_set_size(s_ring_10nm, RING_10NM_RADIUS * 2, RING_10NM_RADIUS * 2);
-    lv_obj_center(s_ring_10nm);
-    lv_arc_set_rotation(s_ring_10nm, 0);
-    lv_arc_set_bg_angles(s_ring_10nm, 0, 360);
-    lv_arc_set_value(s_ring_10nm, 0);
-    lv_obj_remove_style(s_ring_10nm, NULL, LV_PART_KNOB);
-    lv_obj_remove_style(s_ring_10nm, NULL, LV_PART_INDICATOR);
-    lv_obj_set_style_arc_color(s_ring_10nm,
-                                lv_color_make(COLOR_RING_R, COLOR_RING_G, COLOR_RING_B),
-                                LV_PART_MAIN);
-    lv_obj_set_style_arc_width(s_ring_10nm, 2, LV_PART_MAIN);
-    lv_obj_set_style_arc_opa(s_ring_10nm, LV_OPA_50, LV_PART_MAIN);
-    lv_obj_clear_flag(s_ring_10nm, LV_OBJ_FLAG_CLICKABLE);
-
-    // 25nm ring (middle)
-    s_ring_25nm = lv_arc_create(parent);
-    lv_obj_set_size(s_ring_25nm, RING_25NM_RADIUS * 2, RING_25NM_RADIUS * 2);
-    lv_obj_center(s_ring_25nm);
-    lv_arc_set_rotation(s_ring_25nm, 0);
-    lv_arc_set_bg_angles(s_ring_25nm, 0, 360);
-    lv_arc_set_value(s_ring_25nm, 0);
-    lv_obj_remove_style(s_ring_25nm, NULL, LV_PART_KNOB);
-    lv_obj_remove_style(s_ring_25nm, NULL, LV_PART_INDICATOR);
-    lv_obj_set_style_arc_color(s_ring_25nm,
-                                lv_color_make(COLOR_RING_R, COLOR_RING_G, COLOR_RING_B),
-                                LV_PART_MAIN);
-    lv_obj_set_style_arc_width(s_ring_25nm, 2, LV_PART_MAIN);
-    lv_obj_set_style_arc_opa(s_ring_25nm, LV_OPA_50, LV_PART_MAIN);
-    lv_obj_clear_flag(s_ring_25nm, LV_OBJ_FLAG_CLICKABLE);
-
-    // 50nm ring (outer)
-    s_ring_50nm = lv_arc_create(parent);
-    lv_obj_set_size(s_ring_50nm, RING_50NM_RADIUS * 2, RING_50NM_RADIUS * 2);
-    lv_obj_center(s_ring_50nm);
-    lv_arc_set_rotation(s_ring_50nm, 0);
-    lv_arc_set_bg_angles(s_ring_50nm, 0, 360);
-    lv_arc_set_value(s_ring_50nm, 0);
-    lv_obj_remove_style(s_ring_50nm, NULL, LV_PART_KNOB);
-    lv_obj_remove_style(s_ring_50nm, NULL, LV_PART_INDICATOR);
-    lv_obj_set_style_arc_color(s_ring_50nm,
-                                lv_color_make(COLOR_RING_R, COLOR_RING_G, COLOR_RING_B),
-                                LV_PART_MAIN);
-    lv_obj_set_style_arc_width(s_ring_50nm, 3, LV_PART_MAIN);
-    lv_obj_set_style_arc_opa(s_ring_50nm, LV_OPA_60, LV_PART_MAIN);
-    lv_obj_clear_flag(s_ring_50nm, LV_OBJ_FLAG_CLICKABLE);
-
-    ESP_LOGI(TAG, "Distance rings created: 10nm, 25nm, 50nm");
-}
-
-static void create_cardinal_markers(lv_obj_t *parent)
-{
-    // Cardinal direction positions just inside outer ring
-    const int label_radius = RING_50NM_RADIUS - 30;  // Just inside outer ring
-
-    // North (top, 90 degrees = -90 in our coordinate system)
-    float angle_n = -90.0f * M_PI / 180.0f;
-    int x_n = SCREEN_CENTER_X + (int)(label_radius * cosf(angle_n));
-    int y_n = SCREEN_CENTER_Y + (int)(label_radius * sinf(angle_n));
-
-    s_cardinal_n = lv_label_create(parent);
-    lv_label_set_text(s_cardinal_n, "N");
-    lv_obj_set_style_text_color(s_cardinal_n, lv_color_make(0xAA, 0xAA, 0xAA), 0);
-    lv_obj_set_style_text_font(s_cardinal_n, &lv_font_montserrat_16, 0);
-    lv_obj_set_pos(s_cardinal_n, x_n - 8, y_n - 8);
-
-    // East (right, 0 degrees)
-    float angle_e = 0.0f * M_PI / 180.0f;
-    int x_e = SCREEN_CENTER_X + (int)(label_radius * cosf(angle_e));
-    int y_e = SCREEN_CENTER_Y + (int)(label_radius * sinf(angle_e));
-
-    s_cardinal_e = lv_label_create(parent);
-    lv_label_set_text(s_cardinal_e, "E");
-    lv_obj_set_style_text_color(s_cardinal_e, lv_color_make(0xAA, 0xAA, 0xAA), 0);
-    lv_obj_set_style_text_font(s_cardinal_e, &lv_font_montserrat_16, 0);
-    lv_obj_set_pos(s_cardinal_e, x_e - 8, y_e - 8);
-
-    // South (bottom, 90 degrees)
-    float angle_s = 90.0f * M_PI / 180.0f;
-    int x_s = SCREEN_CENTER_X + (int)(label_radius * cosf(angle_s));
-    int y_s = SCREEN_CENTER_Y + (int)(label_radius * sinf(angle_s));
-
-    s_cardinal_s = lv_label_create(parent);
-    lv_label_set_text(s_cardinal_s, "S");
-    lv_obj_set_style_text_color(s_cardinal_s, lv_color_make(0xAA, 0xAA, 0xAA), 0);
-    lv_obj_set_style_text_font(s_cardinal_s, &lv_font_montserrat_16, 0);
-    lv_obj_set_pos(s_cardinal_s, x_s - 8, y_s - 8);
-
-    // West (left, 180 degrees)
-    float angle_w = 180.0f * M_PI / 180.0f;
-    int x_w = SCREEN_CENTER_X + (int)(label_radius * cosf(angle_w));
-    int y_w = SCREEN_CENTER_Y + (int)(label_radius * sinf(angle_w));
-
-    s_cardinal_w = lv_label_create(parent);
-    lv_label_set_text(s_cardinal_w, "W");
-    lv_obj_set_style_text_color(s_cardinal_w, lv_color_make(0xAA, 0xAA, 0xAA), 0);
-    lv_obj_set_style_text_font(s_cardinal_w, &lv_font_montserrat_16, 0);
-    lv_obj_set_pos(s_cardinal_w, x_w - 8, y_w - 8);
-
-    ESP_LOGI(TAG, "Cardinal markers created: N, E, S, W");
-}
-
-static void create_distance_ring_labels(lv_obj_t *parent)
-{
-    typedef struct {
-        int ring_radius;
-        const char *text;
-    } ring_label_config_t;
-
-    static const ring_label_config_t RING_CONFIGS[3] = {
-        {RING_10NM_RADIUS, "10nm"},
-        {RING_25NM_RADIUS, "25nm"},
-        {RING_50NM_RADIUS, "50nm"}
-    };
-
-    static const float LABEL_ANGLES[4] = {45.0f, 135.0f, 225.0f, 315.0f};
-    const int LABEL_OFFSET = 12;  // Pixels outside ring
-
-    for (int ring = 0; ring < 3; ring++) {
-        int label_radius = RING_CONFIGS[ring].ring_radius + LABEL_OFFSET;
-
-        for (int pos = 0; pos < 4; pos++) {
-            int label_idx = ring * 4 + pos;
-            float angle_deg = LABEL_ANGLES[pos];
-            float angle_rad = (angle_deg - 90.0f) * M_PI / 180.0f;
-
-            int x = SCREEN_CENTER_X + (int)(label_radius * cosf(angle_rad));
-            int y = SCREEN_CENTER_Y + (int)(label_radius * sinf(angle_rad));
+bool radar_renderer_get_sweep_timing(uint32_t *north_ms, uint32_t *period_ms)
+{
+    // Two 32-bit reads from another task; a torn pair only shifts one poll
+    uint32_t north = s_sweep_north_ms;
+    uint32_t period = s_sweep_period_ms;
+    if (north == 0 || period == 0) {
+        return false;
+    }
+    *north_ms = north;
+    *period_ms = period;
+    return true;
+}
 
-            s_ring_labels[label_idx] = lv_label_create(parent);
-            lv_label_set_text(s_ring_labels[label_idx], RING_CONFIGS[ring].text);
-            lv_obj_set_style_text_color(s_ring_labels[label_idx],
-                                         lv_color_make(0xAA, 0xAA, 0xAA), 0);
-            lv_obj_set_style_text_font(s_ring_labels[label_idx],
-                                        &lv_font_montserrat_12, 0);
+void radar_renderer_debug_overlay(bool enable)
+{
+    if (s_radar_container == NULL) {
+        return;
+    }
 
-            // Center text (update layout to get actual dimensions)
-            lv_obj_update_layout(s_ring_labels[label_idx]);
-            int width = lv_obj_get_width(s_ring_labels[label_idx]);
-            int height = lv_obj_get_height(s_ring_labels[label_idx]);
-            lv_obj_set_pos(s_ring_labels[label_idx], x - width/2, y - height/2);
+    bsp_display_lock(0);
+    if (enable) {
+        if (s_debug_label == NULL) {
+            s_debug_label = lv_label_create(s_radar_container);
+            lv_obj_set_style_text_font(s_debug_label, &lv_font_unscii_8, 0);  // Monospace columns
+            lv_obj_set_style_text_color(s_debug_label, lv_color_make(0xFF, 0xFF, 0xFF), 0);
+            lv_obj_set_style_bg_color(s_debug_label, lv_color_make(0x00, 0x00, 0x00), 0);
+            lv_obj_set_style_bg_opa(s_debug_label, LV_OPA_70, 0);
+            lv_obj_set_style_pad_all(s_debug_label, 6, 0);
+            lv_obj_align(s_debug_label, LV_ALIGN_CENTER, 0, 150);
+            lv_obj_clear_flag(s_debug_label, LV_OBJ_FLAG_CLICKABLE);
+        }
+        lv_obj_clear_flag(s_debug_label, LV_OBJ_FLAG_HIDDEN);
+        if (s_debug_timer == NULL) {
+            s_debug_timer = lv_timer_create(debug_timer_callback, 1000, NULL);
+        }
+        debug_timer_callback(s_debug_timer);
+    } else {
+        if (s_debug_timer != NULL) {
+            lv_timer_del(s_debug_timer);
+            s_debug_timer = NULL;
+        }
+        if (s_debug_label != NULL) {
+            lv_obj_add_flag(s_debug_label, LV_OBJ_FLAG_HIDDEN);
         }
     }
+    bsp_display_unlock();
 
-    ESP_LOGI(TAG, "Distance ring labels created (12 labels)");
+    ESP_LOGI(TAG, "Debug overlay %s", enable ? "enabled" : "disabled");
 }
 
+// Internal functions
+
 static void create_clock_display(lv_obj_t *parent)
 {
     s_clock_label = lv_label_create(parent);
@@ -407,41 +479,14 @@ static void create_clock_display(lv_obj_t *parent)
 
 static void create_sweep_elements(lv_obj_t *parent)
 {
-    // Create sweep line from center to outer edge
-    static lv_point_precise_t line_points[2];
-    line_points[0].x = SCREEN_CENTER_X;  // Center point
-    line_points[0].y = SCREEN_CENTER_Y;
-    line_points[1].x = SCREEN_CENTER_X;  // Will be updated by rotation
-    line_points[1].y = SCREEN_CENTER_Y - RADAR_DISPLAY_RADIUS;  // Point upward (North)
-
-    s_sweep_line = lv_line_create(parent);
-    lv_line_set_points(s_sweep_line, line_points, 2);
-    lv_obj_set_style_line_color(s_sweep_line,
-                                 lv_color_make(COLOR_SWEEP_R, COLOR_SWEEP_G, COLOR_SWEEP_B), 0);
-    lv_obj_set_style_line_width(s_sweep_line, 2, 0);
-    lv_obj_set_style_line_rounded(s_sweep_line, true, 0);
-
-    // Set rotation pivot to center point
-    lv_obj_set_style_transform_pivot_x(s_sweep_line, SCREEN_CENTER_X, 0);
-    lv_obj_set_style_transform_pivot_y(s_sweep_line, SCREEN_CENTER_Y, 0);
-
-    // Create sweep trail arc (30° wide, follows behind sweep)
-    s_sweep_trail = lv_arc_create(parent);
-    lv_obj_set_size(s_sweep_trail, RADAR_DISPLAY_RADIUS * 2, RADAR_DISPLAY_RADIUS * 2);
-    lv_obj_center(s_sweep_trail);
-    lv_arc_set_rotation(s_sweep_trail, 270);  // Start at North (270 in LVGL coords)
-    lv_arc_set_bg_angles(s_sweep_trail, 0, 0);  // Will be updated
-    lv_arc_set_angles(s_sweep_trail, 0, SWEEP_TRAIL_DEGREES);  // 30° trail
-    lv_obj_remove_style(s_sweep_trail, NULL, LV_PART_KNOB);
-    lv_obj_remove_style(s_sweep_trail, NULL, LV_PART_MAIN);
-    lv_obj_set_style_arc_color(s_sweep_trail,
-                                lv_color_make(COLOR_SWEEP_R, COLOR_SWEEP_G, COLOR_SWEEP_B),
-                                LV_PART_INDICATOR);
-    lv_obj_set_style_arc_width(s_sweep_trail, RADAR_DISPLAY_RADIUS, LV_PART_INDICATOR);
-    lv_obj_set_style_arc_opa(s_sweep_trail, LV_OPA_40, LV_PART_INDICATOR);  // Brighter trail
-    lv_obj_clear_flag(s_sweep_trail, LV_OBJ_FLAG_CLICKABLE);
-
-    ESP_LOGI(TAG, "Sweep elements created: line and trail arc");
+    // Sweep line and fading trail are drawn by the sweep layer, which only
+    // invalidates the sector that changed each frame
+    if (!sweep_layer_init(parent)) {
+        ESP_LOGE(TAG, "Failed to create sweep layer");
+        return;
+    }
+
+    ESP_LOGI(TAG, "Sweep elements created: line and %d° trail", SWEEP_TRAIL_DEGREES);
 }
 
 static void create_config_button(lv_obj_t *parent)
@@ -486,20 +531,140 @@ static void config_button_event_callback(lv_event_t *e)
     }
 }
 
+// Tap on the scope: select the nearest blip, or clear the selection
+static void radar_click_event_callback(lv_event_t *e)
+{
+    (void)e;
+    lv_indev_t *indev = lv_indev_active();
+    if (indev == NULL || s_render_mode != RENDER_MODE_BATCHED) {
+        return;
+    }
+    if (lv_indev_get_gesture_dir(indev) != LV_DIR_NONE) {
+        return;  // End of a zoom swipe, not a tap
+    }
+
+    lv_point_t point;
+    lv_indev_get_point(indev, &point);
+    s_selected_icao = blip_layer_hit_test(point.x, point.y);
+    blip_layer_select(s_selected_icao);
+    ESP_LOGI(TAG, "Tap at (%d, %d): %s", (int)point.x, (int)point.y,
+             s_selected_icao != ICAO_KEY_INVALID ? "aircraft selected" : "selection cleared");
+
+    // Show the ring and details now rather than at the next snapshot
+    redraw_now();
+}
+
+// Swipe up zooms in, swipe down zooms out (the indev has no pinch)
+static void radar_gesture_event_callback(lv_event_t *e)
+{
+    (void)e;
+    lv_indev_t *indev = lv_indev_active();
+    if (indev == NULL) {
+        return;
+    }
+
+    lv_dir_t dir = lv_indev_get_gesture_dir(indev);
+    if (dir == LV_DIR_TOP) {
+        radar_renderer_zoom(1);
+    } else if (dir == LV_DIR_BOTTOM) {
+        radar_renderer_zoom(-1);
+    }
+}
+
+static lv_obj_t *create_zoom_button(lv_obj_t *parent, int x, const char *symbol, int steps)
+{
+    lv_obj_t *button = lv_btn_create(parent);
+    lv_obj_set_size(button, 50, 40);
+    lv_obj_set_pos(button, x, 710);
+
+    // Same styling as the config button
+    lv_obj_set_style_bg_color(button, lv_color_make(0x40, 0x40, 0x80), 0);
+    lv_obj_set_style_bg_opa(button, LV_OPA_COVER, 0);
+    lv_obj_set_style_border_color(button,
+                                  lv_color_make(COLOR_SWEEP_R, COLOR_SWEEP_G, COLOR_SWEEP_B), 0);
+    lv_obj_set_style_border_width(button, 2, 0);
+    lv_obj_set_style_radius(button, 8, 0);
+
+    lv_obj_t *label = lv_label_create(button);
+    lv_label_set_text(label, symbol);
+    lv_obj_set_style_text_color(label,
+                                lv_color_make(COLOR_SWEEP_R, COLOR_SWEEP_G, COLOR_SWEEP_B), 0);
+    lv_obj_center(label);
+
+    lv_obj_add_event_cb(button, zoom_button_event_callback, LV_EVENT_CLICKED,
+                        (void *)(intptr_t)steps);
+    return button;
+}
+
+static void zoom_button_event_callback(lv_event_t *e)
+{
+    radar_renderer_zoom((int)(intptr_t)lv_event_get_user_data(e));
+}
+
+// Presets below the configured radius (ascending), then the radius itself
+static void build_zoom_levels(void)
+{
+    static const int PRESETS[] = RADAR_ZOOM_PRESETS_NM;
+
+    s_zoom_count = 0;
+    for (size_t i = 0; i < sizeof(PRESETS) / sizeof(PRESETS[0]); i++) {
+        if (s_zoom_count >= RADAR_ZOOM_MAX_LEVELS - 1) {
+            break;
+        }
+        if (PRESETS[i] > 0 && PRESETS[i] < s_max_range_nm &&
+            (s_zoom_count == 0 || PRESETS[i] > s_zoom_levels[s_zoom_count - 1])) {
+            s_zoom_levels[s_zoom_count++] = PRESETS[i];
+        }
+    }
+    s_zoom_levels[s_zoom_count++] = s_max_range_nm;
+}
+
+// Scale the scope to a range: background rings plus the store's projection
+// and in-range filter (no new fetch; the store holds the full radius)
+static void apply_range(int range_nm)
+{
+    s_radar_radius_nm = range_nm;
+    if (s_radar_container != NULL) {
+        background_layer_set_radius(range_nm);
+        aircraft_store_set_radar_radius(range_nm);
+        ppi_scheduler_reset();  // Every blip moves: repaint the whole scope
+    }
+}
+
+// Draw the latest snapshot immediately
+static void redraw_now(void)
+{
+    const aircraft_snapshot_t *snapshot = aircraft_store_acquire_snapshot();
+    apply_aircraft(snapshot->aircraft, snapshot->count);
+    s_rendered_generation = snapshot->generation;
+    aircraft_store_release_snapshot(snapshot);
+}
+
 static void sweep_timer_callback(lv_timer_t *timer)
 {
     // Debug: Log sweep rate every 10 rotations
     static int rotation_count = 0;
     static uint32_t last_rotation_time = 0;
 
-    float prev_angle = s_sweep_angle;
-
-    // Update sweep angle
-    s_sweep_angle += s_sweep_degrees_per_frame;
-    if (s_sweep_angle >= 360.0f) {
-        s_sweep_angle -= 360.0f;
+    // Update sweep angle: integer phase, so a rotation is an exact number
+    // of frames and no rounding error accumulates
+    if (s_sweep_step == 0) {
+        s_sweep_step = sweep_step_for(s_sweep_degrees_per_frame);
+    }
+    uint32_t last_phase = s_sweep_phase;
+    s_sweep_phase += s_sweep_step;
+    if (s_sweep_phase < last_phase) {  // Wrapped past North
         rotation_count++;
 
+        // Frames run slightly slower than nominal, so measure the real period
+        uint32_t crossing = xTaskGetTickCount() * portTICK_PERIOD_MS;
+        if (s_sweep_north_ms != 0) {
+            s_sweep_period_ms = crossing - s_sweep_north_ms;
+        } else {
+            s_sweep_period_ms = (uint32_t)(360.0f / (s_sweep_degrees_per_frame * 60.0f) * 1000.0f);
+        }
+        s_sweep_north_ms = crossing != 0 ? crossing : 1;
+
         // Log timing every 10 rotations
         if (rotation_count % 10 == 0) {
             uint32_t now = xTaskGetTickCount() * portTICK_PERIOD_MS;
@@ -514,19 +679,17 @@ static void sweep_timer_callback(lv_timer_t *timer)
         }
     }
 
-    // Rotate sweep line
-    // LVGL rotation is in 0.1 degree units, and 0° is right (East)
-    // We want 0° to be North, so subtract 90°
-    int rotation_decidegrees = (int)((s_sweep_angle - 90.0f) * 10.0f);
-    lv_obj_set_style_transform_rotation(s_sweep_line, rotation_decidegrees, 0);
+    // Bearing convention (0 = North, clockwise), trail follows behind
+    int sweep_decideg = (int)(((uint64_t)s_sweep_phase * RADAR_MATH_DECIDEG_FULL) >> 32);
+    sweep_layer_set_angle(sweep_decideg);
 
-    // Update trail arc rotation to follow sweep
-    // Trail arc rotation in LVGL: 270 = North, increases clockwise
-    int arc_rotation = (int)(270.0f + s_sweep_angle);
-    if (arc_rotation >= 360) {
-        arc_rotation -= 360;
+    // PPI: repaint the blips in the sectors the sweep just entered
+    ppi_span_t span;
+    if (ppi_active() && ppi_scheduler_advance(sweep_decideg, &span)) {
+        int64_t start_us = perf_stats_now();
+        s_blip_count = update_ppi_blips(&span);
+        perf_stats_record_since(PERF_RENDER_APPLY, start_us);
     }
-    lv_arc_set_rotation(s_sweep_trail, arc_rotation);
 }
 
 static void clock_timer_callback(lv_timer_t *timer)
@@ -569,47 +732,180 @@ static void clock_timer_callback(lv_timer_t *timer)
 
 void radar_renderer_update_aircraft(const void *aircraft_data, int count)
 {
-    const tracked_aircraft_t *aircraft = (const tracked_aircraft_t *)aircraft_data;
-
     if (s_radar_container == NULL) {
         ESP_LOGW(TAG, "Radar not initialized, skipping aircraft update");
         return;
     }
 
-    ESP_LOGI(TAG, "Updating %d aircraft on radar display", count);
-
     // Lock LVGL before modifying objects
     bsp_display_lock(0);
+    apply_aircraft((const tracked_aircraft_t *)aircraft_data, count);
+    bsp_display_unlock();
+}
 
+void radar_renderer_start_aircraft_updates(void)
+{
+    if (s_aircraft_timer == NULL) {
+        s_aircraft_timer = lv_timer_create(aircraft_timer_callback, AIRCRAFT_RENDER_POLL_MS, NULL);
+        ESP_LOGI(TAG, "Aircraft updates started (polling store every %d ms)", AIRCRAFT_RENDER_POLL_MS);
+    }
+}
+
+// Refresh the debug overlay with the perf_stats and mem_budget tables
+static void debug_timer_callback(lv_timer_t *timer)
+{
+    (void)timer;
+
+    static char text[PERF_STAGE_COUNT * 64 + MEM_TAG_COUNT * 48 + 256];
+    int len = perf_stats_format(text, sizeof(text));
+    len += snprintf(text + len, sizeof(text) - len, "lod %s, refresh %lu us\n",
+                    render_lod_name(render_lod_get()), (unsigned long)render_lod_get_frame_us());
+    mem_budget_format(text + len, sizeof(text) - len);
+    lv_label_set_text(s_debug_label, text);
+}
+
+// Runs on the LVGL task (lock already held): draw the latest store
+// snapshot if a new generation was published since the last frame
+static void aircraft_timer_callback(lv_timer_t *timer)
+{
+    (void)timer;
+
+    // A new detail tier redraws the current snapshot straight away
+    if (aircraft_store_get_generation() == s_rendered_generation && render_lod_get() == s_applied_lod) {
+        return;
+    }
+
+    const aircraft_snapshot_t *snapshot = aircraft_store_acquire_snapshot();
+    apply_aircraft(snapshot->aircraft, snapshot->count);
+    s_rendered_generation = snapshot->generation;
+    aircraft_store_release_snapshot(snapshot);
+}
+
+// Caller must hold the LVGL lock
+static void apply_aircraft(const tracked_aircraft_t *aircraft, int count)
+{
+    ESP_LOGD(TAG, "Updating %d aircraft on radar display", count);
+    int64_t start_us = perf_stats_now();
+
+    const tracked_aircraft_t *selected = find_selected(aircraft, count);
+
+    // Far targets are held on every update but the Nth below full detail;
+    // never right after a tier change, so held items match the new tier
+    render_lod_t lod = render_lod_get();
+    bool hold_far = lod == s_applied_lod && lod > RENDER_LOD_FULL &&
+                    (++s_apply_count % RENDER_LOD_FAR_DIVIDER) != 0;
+    s_applied_lod = lod;
+    sweep_layer_set_trail(lod < RENDER_LOD_VECTORS);
+
+    if (ppi_active()) {
+        s_blip_count = blip_layer_get_count();  // Blips are repainted by the sweep
+    } else if (s_render_mode == RENDER_MODE_BATCHED) {
+        s_blip_count = update_batched_blips(aircraft, count, hold_far);
+    } else {
+        s_blip_count = update_widget_blips(aircraft, count);
+    }
+
+    // Update status label (selected aircraft's details replace the count)
+    char status_str[64];
+    if (selected != NULL) {
+        snprintf(status_str, sizeof(status_str), "%s  %d ft  %.0f kt  %.1f nm  brg %03d",
+                 selected->callsign[0] != '\0' ? selected->callsign : selected->hex,
+                 selected->altitude, selected->speed, selected->distance_nm,
+                 (int)(aircraft_store_bearing_deg(selected) + 0.5f) % 360);
+    } else {
+        snprintf(status_str, sizeof(status_str), s_stale ? "%d aircraft (cached)" : "%d aircraft", s_blip_count);
+    }
+    lv_label_set_text(s_status_label, status_str);
+
+    perf_stats_record_since(PERF_RENDER_APPLY, start_us);
+    ESP_LOGD(TAG, "Radar display updated: %d blips rendered", s_blip_count);
+}
+
+// Helper functions
+
+// The selected aircraft in this update; drops the selection once it has
+// left the store or the scope
+static const tracked_aircraft_t *find_selected(const tracked_aircraft_t *aircraft, int count)
+{
+    if (s_selected_icao == ICAO_KEY_INVALID) {
+        return NULL;
+    }
+    for (int i = 0; i < count; i++) {
+        if (aircraft[i].icao == s_selected_icao && aircraft[i].distance_nm <= s_radar_radius_nm) {
+            return &aircraft[i];
+        }
+    }
+    s_selected_icao = ICAO_KEY_INVALID;
+    blip_layer_select(ICAO_KEY_INVALID);
+    return NULL;
+}
+
+static void build_altitude_colors(void)
+{
+    // Color-code by altitude:
+    // Light grey: < 50 ft (on ground/taxiing)
+    // Yellow: 50 - 10,000 ft (low)
+    // Orange: 10,000 - 25,000 ft (medium)
+    // White: > 25,000 ft (high)
+    s_altitude_colors[ALT_BAND_GROUND] = lv_color_make(COLOR_GROUND_R, COLOR_GROUND_G, COLOR_GROUND_B);
+    s_altitude_colors[ALT_BAND_LOW] = lv_color_make(COLOR_LOW_ALT_R, COLOR_LOW_ALT_G, COLOR_LOW_ALT_B);
+    s_altitude_colors[ALT_BAND_MED] = lv_color_make(COLOR_MED_ALT_R, COLOR_MED_ALT_G, COLOR_MED_ALT_B);
+    s_altitude_colors[ALT_BAND_HIGH] = lv_color_make(COLOR_HIGH_ALT_R, COLOR_HIGH_ALT_G, COLOR_HIGH_ALT_B);
+}
+
+static lv_color_t get_altitude_color(int altitude_ft)
+{
+    return s_altitude_colors[radar_math_altitude_band(altitude_ft)];
+}
+
+// Phase advance per frame for a sweep rate (one turn = 2^32)
+static uint32_t sweep_step_for(float degrees_per_frame)
+{
+    return (uint32_t)((double)degrees_per_frame / 360.0 * 4294967296.0);
+}
+
+// One LVGL object each for blip, labels and vector (original renderer)
+static int update_widget_blips(const tracked_aircraft_t *aircraft, int count)
+{
     // Mark all blips as inactive for pruning
-    for (int i = 0; i < MAX_AIRCRAFT_BLIPS; i++) {
+    for (int i = 0; i < s_blip_capacity; i++) {
         if (s_blips[i].active) {
             s_blips[i].active = false;  // Will be set true if found in new data
         }
     }
 
-    // Use configured label visibility preference
-    bool show_labels = s_show_aircraft_labels;
+    // Retire blips for aircraft that left the store before allocating new
+    // ones: the pool is exactly the store capacity, so an aircraft evicted
+    // from a full store must free its slot for the one that replaced it
+    for (int i = 0; i < count; i++) {
+        if (aircraft[i].distance_nm > s_radar_radius_nm) {
+            continue;
+        }
+        int blip_idx = icao_index_find(&s_blip_index, aircraft[i].icao);
+        if (blip_idx != -1) {
+            s_blips[blip_idx].active = true;
+        }
+    }
+    for (int i = 0; i < s_blip_capacity; i++) {
+        if (s_blips[i].blip != NULL && !s_blips[i].active) {
+            delete_blip(i);
+        }
+    }
+
+    // Configured label visibility, reduced by the detail tier
+    bool show_callsign = s_show_aircraft_labels && s_applied_lod <= RENDER_LOD_CALLSIGN;
+    bool show_alt = s_show_aircraft_labels && s_applied_lod == RENDER_LOD_FULL;
+    bool show_vectors = s_applied_lod <= RENDER_LOD_VECTORS;
 
     // Update/create blips for each aircraft
     for (int i = 0; i < count; i++) {
         // Skip aircraft outside radar radius
-        if (aircraft[i].distance_nm > RADAR_RADIUS_NM) {
+        if (aircraft[i].distance_nm > s_radar_radius_nm) {
             continue;
         }
 
-        // Find existing blip or create new one
-        int blip_idx = find_blip(aircraft[i].hex);
-        if (blip_idx == -1) {
-            // Find empty slot
-            for (int j = 0; j < MAX_AIRCRAFT_BLIPS; j++) {
-                if (s_blips[j].blip == NULL) {
-                    blip_idx = j;
-                    break;
-                }
-            }
-        }
-
+        // Find existing blip or allocate a free slot
+        int blip_idx = icao_index_insert(&s_blip_index, aircraft[i].icao, NULL);
         if (blip_idx == -1) {
             ESP_LOGW(TAG, "No free blip slots for aircraft %s", aircraft[i].hex);
             continue;
@@ -639,7 +935,7 @@ void radar_renderer_update_aircraft(const void *aircraft_data, int count)
             lv_obj_set_style_line_opa(s_blips[blip_idx].velocity_line, LV_OPA_70, 0);
             lv_obj_clear_flag(s_blips[blip_idx].velocity_line, LV_OBJ_FLAG_CLICKABLE);
 
-            strncpy(s_blips[blip_idx].hex, aircraft[i].hex, sizeof(s_blips[blip_idx].hex) - 1);
+            s_blips[blip_idx].icao = aircraft[i].icao;
         }
 
         // Update position
@@ -653,7 +949,7 @@ void radar_renderer_update_aircraft(const void *aircraft_data, int count)
         lv_obj_set_style_text_color(s_blips[blip_idx].label_alt, color, 0);
 
         // Update labels
-        if (show_labels && aircraft[i].callsign[0] != '\0') {
+        if (show_callsign && aircraft[i].callsign[0] != '\0') {
             lv_label_set_text(s_blips[blip_idx].label_cs, aircraft[i].callsign);
             lv_obj_set_pos(s_blips[blip_idx].label_cs, aircraft[i].screen_x + 6, aircraft[i].screen_y - 14);
             lv_obj_clear_flag(s_blips[blip_idx].label_cs, LV_OBJ_FLAG_HIDDEN);
@@ -662,7 +958,7 @@ void radar_renderer_update_aircraft(const void *aircraft_data, int count)
         }
 
         // Format altitude (35000 → "350")
-        if (show_labels && aircraft[i].altitude > 0) {
+        if (show_alt && aircraft[i].altitude > 0) {
             char alt_str[8];
             snprintf(alt_str, sizeof(alt_str), "%d", aircraft[i].altitude / 100);
             lv_label_set_text(s_blips[blip_idx].label_alt, alt_str);
@@ -673,18 +969,8 @@ void radar_renderer_update_aircraft(const void *aircraft_data, int count)
         }
 
         // Update velocity vector
-        if (aircraft[i].speed > 0 && aircraft[i].track >= 0) {
-            // Calculate vector length based on speed (scale: 0.2 pixels per knot)
-            float vector_length = aircraft[i].speed * VELOCITY_VECTOR_SCALE;
-
-            // Convert track to radians (track: 0° = North, increases clockwise)
-            // Adjust for screen coordinates: subtract 90° to rotate North to top
-            float angle_rad = (aircraft[i].track - 90.0f) * M_PI / 180.0f;
-
-            // Calculate endpoint
-            int end_x = aircraft[i].screen_x + (int)(vector_length * cosf(angle_rad));
-            int end_y = aircraft[i].screen_y + (int)(vector_length * sinf(angle_rad));
-
+        int end_x, end_y;
+        if (show_vectors && velocity_vector_end(&aircraft[i], &end_x, &end_y)) {
             // Update line points in persistent storage
             s_velocity_points[blip_idx][0].x = aircraft[i].screen_x;
             s_velocity_points[blip_idx][0].y = aircraft[i].screen_y;
@@ -701,60 +987,182 @@ void radar_renderer_update_aircraft(const void *aircraft_data, int count)
         s_blips[blip_idx].active = true;
     }
 
-    // Delete blips for aircraft that are no longer present
-    for (int i = 0; i < MAX_AIRCRAFT_BLIPS; i++) {
-        if (s_blips[i].blip != NULL && !s_blips[i].active) {
-            delete_blip(i);
+    // Count active blips
+    int blip_count = 0;
+    for (int i = 0; i < s_blip_capacity; i++) {
+        if (s_blips[i].blip != NULL) {
+            blip_count++;
         }
     }
 
-    // Count active blips
-    s_blip_count = 0;
-    for (int i = 0; i < MAX_AIRCRAFT_BLIPS; i++) {
-        if (s_blips[i].blip != NULL) {
-            s_blip_count++;
+    return blip_count;
+
+}
+
+// All blips drawn by the blip layer from a flat draw list
+static int update_batched_blips(const tracked_aircraft_t *aircraft, int count, bool hold_far)
+{
+    int capacity = 0;
+    blip_draw_item_t *items = blip_layer_begin(&capacity);
+    blip_detail_t detail = current_detail();
+    float far_nm = s_radar_radius_nm * RENDER_LOD_FAR_FRACTION;
+    int n = 0;
+
+    for (int i = 0; i < count && n < capacity; i++) {
+        // Skip aircraft outside radar radius
+        if (aircraft[i].distance_nm > s_radar_radius_nm) {
+            continue;
         }
+
+        blip_draw_item_t *item = &items[n++];
+        if (hold_far && aircraft[i].distance_nm > far_nm && aircraft[i].icao != s_selected_icao) {
+            const blip_draw_item_t *last = blip_layer_find(aircraft[i].icao);
+            if (last != NULL) {
+                hold_item(item, last);
+                continue;
+            }
+        }
+        fill_item(item, &aircraft[i], &detail);
     }
 
-    // Update status label
-    char status_str[32];
-    snprintf(status_str, sizeof(status_str), "%d aircraft", s_blip_count);
-    lv_label_set_text(s_status_label, status_str);
+    blip_layer_commit(n);
+    return n;
+}
 
-    bsp_display_unlock();
+// PPI: repaint the aircraft in the sectors the sweep just entered; every
+// other blip stays as it was painted, one decay step dimmer when one is
+// due. A blip in a swept sector with no aircraft there any more is gone.
+static int update_ppi_blips(const ppi_span_t *span)
+{
+    const aircraft_snapshot_t *snapshot = aircraft_store_acquire_snapshot();
+    ppi_scheduler_bucket(snapshot->generation, snapshot->aircraft, snapshot->count, s_radar_radius_nm);
+
+    int capacity = 0;
+    blip_draw_item_t *items = blip_layer_begin(&capacity);
+    int front_count = 0;
+    const blip_draw_item_t *front = blip_layer_items(&front_count);
+    blip_detail_t detail = current_detail();
+    memset(s_ppi_replaced, 0, front_count * sizeof(bool));
+    int n = 0;
+
+    for (int k = 0; k < span->count; k++) {
+        int sector = (span->first + k) % PPI_SECTORS;
+        int bucket_count = 0;
+        const int16_t *bucket = ppi_scheduler_sector(sector, &bucket_count);
+        for (int b = 0; b < bucket_count && n < capacity; b++) {
+            const tracked_aircraft_t *ac = &snapshot->aircraft[bucket[b]];
+            blip_draw_item_t *item = &items[n++];
+            fill_item(item, ac, &detail);
+            item->sector = (uint8_t)sector;
+            item->opa = ppi_scheduler_opacity(sector);
+
+            // An aircraft that crossed into this sector replaces its old blip
+            const blip_draw_item_t *last = blip_layer_find(ac->icao);
+            if (last != NULL) {
+                s_ppi_replaced[last - front] = true;
+            }
+        }
+    }
+
+    for (int j = 0; j < front_count && n < capacity; j++) {
+        if (s_ppi_replaced[j] || ppi_scheduler_in_span(span, front[j].sector)) {
+            continue;
+        }
+        blip_draw_item_t *item = &items[n++];
+        hold_item(item, &front[j]);
+        item->opa = ppi_scheduler_opacity(item->sector);
+    }
 
-    ESP_LOGI(TAG, "Radar display updated: %d blips rendered", s_blip_count);
+    blip_layer_commit(n);
+    aircraft_store_release_snapshot(snapshot);
+    return n;
 }
 
-// Helper functions
+static bool ppi_active(void)
+{
+    return RADAR_PPI && s_render_mode == RENDER_MODE_BATCHED && s_ppi_replaced != NULL;
+}
 
-static lv_color_t get_altitude_color(int altitude_ft)
+// Configured label visibility, reduced by the detail tier
+static blip_detail_t current_detail(void)
 {
-    // Color-code by altitude:
-    // Light grey: < 50 ft (on ground/taxiing)
-    // Yellow: 50 - 10,000 ft (low)
-    // Orange: 10,000 - 25,000 ft (medium)
-    // White: > 25,000 ft (high)
+    blip_detail_t detail = {
+        .callsign = s_show_aircraft_labels && s_applied_lod <= RENDER_LOD_CALLSIGN,
+        .alt = s_show_aircraft_labels && s_applied_lod == RENDER_LOD_FULL,
+        .vectors = s_applied_lod <= RENDER_LOD_VECTORS,
+        .trails = RADAR_SHOW_TRAILS && s_applied_lod <= RENDER_LOD_CALLSIGN,
+    };
+    return detail;
+}
 
-    if (altitude_ft < ALT_GROUND_THRESHOLD) {
-        return lv_color_make(COLOR_GROUND_R, COLOR_GROUND_G, COLOR_GROUND_B);  // Light grey
-    } else if (altitude_ft < ALT_LOW_THRESHOLD) {
-        return lv_color_make(COLOR_LOW_ALT_R, COLOR_LOW_ALT_G, COLOR_LOW_ALT_B);  // Yellow
-    } else if (altitude_ft < ALT_MED_THRESHOLD) {
-        return lv_color_make(COLOR_MED_ALT_R, COLOR_MED_ALT_G, COLOR_MED_ALT_B);  // Orange
-    } else {
-        return lv_color_make(COLOR_HIGH_ALT_R, COLOR_HIGH_ALT_G, COLOR_HIGH_ALT_B);  // White
+// Draw item for an aircraft at full opacity
+static void fill_item(blip_draw_item_t *item, const tracked_aircraft_t *ac, const blip_detail_t *detail)
+{
+    item->icao = ac->icao;
+    item->x = (int16_t)ac->screen_x;
+    item->y = (int16_t)ac->screen_y;
+    item->color = get_altitude_color(ac->altitude);
+    item->opa = LV_OPA_COVER;
+    item->sector = 0;
+
+    int end_x = ac->screen_x;
+    int end_y = ac->screen_y;
+    item->has_vector = detail->vectors && velocity_vector_end(ac, &end_x, &end_y);
+    item->vec_x = (int16_t)end_x;
+    item->vec_y = (int16_t)end_y;
+
+    // Trail is already in screen space; just copy it into the layer
+    item->trail_count = 0;
+    if (detail->trails && item->trail != NULL) {
+        for (int k = 0; k < ac->trail_count; k++) {
+            item->trail[k].x = ac->trail[k].x;
+            item->trail[k].y = ac->trail[k].y;
+        }
+        item->trail_count = (uint8_t)ac->trail_count;
+    }
+
+    item->callsign[0] = '\0';
+    item->alt[0] = '\0';
+    if (detail->callsign) {
+        strncpy(item->callsign, ac->callsign, sizeof(item->callsign) - 1);
+        item->callsign[sizeof(item->callsign) - 1] = '\0';
+    }
+    if (detail->alt && ac->altitude > 0) {
+        // Format altitude (35000 → "350")
+        snprintf(item->alt, sizeof(item->alt), "%d", ac->altitude / 100);
     }
 }
 
-static int find_blip(const char *hex)
+// Repeat an item exactly as it is on screen, so the diff skips it
+// (trail storage belongs to each list, so copy the points, not the pointer)
+static void hold_item(blip_draw_item_t *item, const blip_draw_item_t *last)
 {
-    for (int i = 0; i < MAX_AIRCRAFT_BLIPS; i++) {
-        if (s_blips[i].blip != NULL && strcmp(s_blips[i].hex, hex) == 0) {
-            return i;
-        }
+    blip_point_t *trail = item->trail;
+    *item = *last;
+    item->trail = trail;
+    item->trail_count = trail != NULL ? last->trail_count : 0;
+    if (item->trail_count > 0) {
+        memcpy(trail, last->trail, item->trail_count * sizeof(blip_point_t));
+    }
+}
+
+// Velocity vector end point (scale: 0.2 pixels per knot)
+// Returns false if there is no speed/track data
+static bool velocity_vector_end(const tracked_aircraft_t *ac, int *end_x, int *end_y)
+{
+    *end_x = ac->screen_x;
+    *end_y = ac->screen_y;
+    if (!(ac->speed > 0 && ac->track >= 0)) {
+        return false;
     }
-    return -1;
+
+    // Track follows the bearing convention (0° = North, clockwise), so the
+    // sine table gives the screen offset directly
+    int dx, dy;
+    radar_math_polar(Q16_FROM_FLOAT(ac->speed * VELOCITY_VECTOR_SCALE), radar_math_decideg(ac->track), &dx, &dy);
+    *end_x = ac->screen_x + dx;
+    *end_y = ac->screen_y + dy;
+    return true;
 }
 
 static void delete_blip(int index)
@@ -775,7 +1183,8 @@ static void delete_blip(int index)
         lv_obj_del(s_blips[index].velocity_line);
         s_blips[index].velocity_line = NULL;
     }
-    memset(s_blips[index].hex, 0, sizeof(s_blips[index].hex));
+    icao_index_remove(&s_blip_index, s_blips[index].icao);
+    s_blips[index].icao = ICAO_KEY_INVALID;
     s_blips[index].active = false;
 }
 
@@ -7,6 +7,7 @@
 
 #include "lvgl.h"
 #include <stdbool.h>
+#include <stdint.h>
 
 /**
  * @brief Initialize radar renderer and create static display elements
@@ -27,6 +28,30 @@ lv_obj_t *radar_renderer_get_container(void);
  */
 void radar_renderer_set_label(const char *label);
 
+/**
+ * @brief Set the radar radius (the range fetched from the API)
+ * Becomes the outermost zoom level, below which the RADAR_ZOOM_PRESETS_NM
+ * presets are offered, and resets the zoom to it. Also sets the aircraft
+ * store's radius once the renderer is initialized.
+ * @param radius_nm Radar radius in nautical miles
+ */
+void radar_renderer_set_radius(int radius_nm);
+
+/**
+ * @brief Step the zoom level
+ * Redraws from tracks already in the store (re-filtered and re-projected
+ * there) over a cached background, so a step costs no fetch and no re-bake.
+ * Must be called with the LVGL lock held.
+ * @param steps Levels to move (positive = zoom in, negative = zoom out)
+ */
+void radar_renderer_zoom(int steps);
+
+/**
+ * @brief Get the range currently shown
+ * @return Zoom range in nautical miles
+ */
+int radar_renderer_get_range(void);
+
 /**
  * @brief Set the sweep rotation rate
  * @param sweep_seconds Seconds for one full 360° rotation (e.g., 10.0)
@@ -39,6 +64,15 @@ void radar_renderer_set_sweep_rate(float sweep_seconds);
  */
 void radar_renderer_set_show_labels(bool show_labels);
 
+/**
+ * @brief Select how aircraft are drawn
+ * RENDER_MODE_WIDGETS creates LVGL objects per aircraft; RENDER_MODE_BATCHED
+ * draws all blips from one custom draw callback. Switching redraws
+ * immediately from the latest store snapshot.
+ * @param mode RENDER_MODE_WIDGETS or RENDER_MODE_BATCHED (radar_config.h)
+ */
+void radar_renderer_set_render_mode(uint8_t mode);
+
 /**
  * @brief Callback function type for config button press
  */
@@ -72,7 +106,24 @@ void radar_renderer_pause_sweep(void);
 void radar_renderer_resume_sweep(void);
 
 /**
- * @brief Toggle debug overlay (shows center point and ring radii)
+ * @brief Mark the displayed traffic as cached (boot snapshot) or live
+ * Shown in the status line. Safe to call from any task, and before init.
+ * @param stale true while showing last-known traffic
+ */
+void radar_renderer_set_stale(bool stale);
+
+/**
+ * @brief Get the sweep's North crossing time and rotation period
+ * Safe to call from any task; used to phase-align API polls.
+ * @param north_ms Tick time (ms) of the last North crossing
+ * @param period_ms Measured rotation period (ms)
+ * @return false while the sweep is stopped, paused or not yet past North
+ */
+bool radar_renderer_get_sweep_timing(uint32_t *north_ms, uint32_t *period_ms);
+
+/**
+ * @brief Toggle debug overlay (pipeline timing table from perf_stats)
+ * Refreshed once per second while shown. Safe to call from any task.
  * @param enable true to show debug overlay
  */
 void radar_renderer_debug_overlay(bool enable);
@@ -85,6 +136,14 @@ void radar_renderer_debug_overlay(bool enable);
  */
 void radar_renderer_update_aircraft(const void *aircraft, int count);
 
+/**
+ * @brief Start pulling aircraft from the store on the LVGL task
+ * An LVGL timer checks the store generation every AIRCRAFT_RENDER_POLL_MS
+ * and redraws from the latest snapshot when it changed, so ingest tasks
+ * never touch LVGL or take the display lock.
+ */
+void radar_renderer_start_aircraft_updates(void);
+
 /**
  * @brief Start the clock display timer
  * Updates clock every 1 second with current UTC time (adjusted by timezone offset)
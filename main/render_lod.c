@@ -0,0 +1,127 @@
+/*
+ * Render Level of Detail Implementation
+ *
+ * The refresh time (LV_EVENT_REFR_START to LV_EVENT_REFR_READY, render
+ * plus flush) is smoothed and compared against a high and a low water
+ * mark of RENDER_LOD_FRAME_BUDGET_US. Pressure in one direction has to
+ * last RENDER_LOD_STEP_DOWN_MS (or the longer RENDER_LOD_STEP_UP_MS)
+ * before the tier moves one step, and the dwell restarts after every
+ * change, so a single slow frame never changes the tier.
+ */
+
+#include "render_lod.h"
+#include "radar_config.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char *TAG = "render_lod";
+
+#define FRAME_ALPHA 0.1f  // Weight of the latest refresh in the average
+
+static const char *LOD_NAMES[RENDER_LOD_COUNT] = {
+    [RENDER_LOD_FULL] = "full",
+    [RENDER_LOD_CALLSIGN] = "callsign",
+    [RENDER_LOD_VECTORS] = "vectors",
+    [RENDER_LOD_BLIPS] = "blips",
+};
+
+static volatile render_lod_t s_lod = RENDER_LOD_FULL;
+
+// Controller state (only touched on the LVGL task)
+static int64_t s_refr_start_us = 0;
+static float s_frame_us = 0.0f;
+static int s_pending_step = 0;          // +1 = less detail, -1 = more, 0 = none
+static uint32_t s_pending_since_ms = 0;
+static uint32_t s_changed_ms = 0;
+
+// Forward declarations
+static void display_event_cb(lv_event_t *e);
+static void update_lod(uint32_t frame_us, uint32_t now_ms);
+
+void render_lod_attach_display(lv_display_t *display)
+{
+    if (display == NULL) {
+        return;
+    }
+    lv_display_add_event_cb(display, display_event_cb, LV_EVENT_REFR_START, NULL);
+    lv_display_add_event_cb(display, display_event_cb, LV_EVENT_REFR_READY, NULL);
+    ESP_LOGI(TAG, "Level of detail %s (budget %d µs, %d-%d%%)",
+             RENDER_LOD_AUTO ? "adaptive" : "fixed", RENDER_LOD_FRAME_BUDGET_US,
+             RENDER_LOD_LOW_WATER_PCT, RENDER_LOD_HIGH_WATER_PCT);
+}
+
+render_lod_t render_lod_get(void)
+{
+    return s_lod;
+}
+
+const char *render_lod_name(render_lod_t lod)
+{
+    return lod < RENDER_LOD_COUNT ? LOD_NAMES[lod] : "?";
+}
+
+uint32_t render_lod_get_frame_us(void)
+{
+    return (uint32_t)s_frame_us;
+}
+
+// Internal functions
+
+static void display_event_cb(lv_event_t *e)
+{
+    int64_t now_us = esp_timer_get_time();
+
+    if (lv_event_get_code(e) == LV_EVENT_REFR_START) {
+        s_refr_start_us = now_us;
+        return;
+    }
+    if (s_refr_start_us == 0) {
+        return;
+    }
+    int64_t elapsed = now_us - s_refr_start_us;
+    s_refr_start_us = 0;
+    update_lod(elapsed > UINT32_MAX ? UINT32_MAX : (uint32_t)elapsed, (uint32_t)(now_us / 1000));
+}
+
+static void update_lod(uint32_t frame_us, uint32_t now_ms)
+{
+    if (s_frame_us == 0.0f) {
+        s_frame_us = (float)frame_us;
+    } else {
+        s_frame_us += FRAME_ALPHA * ((float)frame_us - s_frame_us);
+    }
+    if (!RENDER_LOD_AUTO) {
+        return;
+    }
+
+    const float high_us = RENDER_LOD_FRAME_BUDGET_US * (RENDER_LOD_HIGH_WATER_PCT / 100.0f);
+    const float low_us = RENDER_LOD_FRAME_BUDGET_US * (RENDER_LOD_LOW_WATER_PCT / 100.0f);
+
+    int step = 0;
+    if (s_frame_us > high_us && s_lod < RENDER_LOD_BLIPS) {
+        step = 1;
+    } else if (s_frame_us < low_us && s_lod > RENDER_LOD_FULL) {
+        step = -1;
+    }
+
+    // Pressure started, eased or reversed: restart the dwell
+    if (step != s_pending_step) {
+        s_pending_step = step;
+        s_pending_since_ms = now_ms;
+        return;
+    }
+    if (step == 0) {
+        return;
+    }
+
+    uint32_t dwell_ms = step > 0 ? RENDER_LOD_STEP_DOWN_MS : RENDER_LOD_STEP_UP_MS;
+    if (now_ms - s_pending_since_ms < dwell_ms || now_ms - s_changed_ms < dwell_ms) {
+        return;
+    }
+
+    s_lod = (render_lod_t)(s_lod + step);
+    s_changed_ms = now_ms;
+    s_pending_step = 0;
+    ESP_LOGI(TAG, "Level of detail -> %s (refresh %lu µs, budget %d µs)",
+             LOD_NAMES[s_lod], (unsigned long)s_frame_us, RENDER_LOD_FRAME_BUDGET_US);
+}
@@ -0,0 +1,50 @@
+/*
+ * Render Level of Detail
+ * Picks how much to draw per aircraft from the measured LVGL refresh time,
+ * stepping detail down when frames approach the sweep's frame budget and
+ * back up once they have been comfortably inside it for a while. The
+ * band between the two thresholds plus a minimum dwell per tier keeps it
+ * from flickering between tiers.
+ */
+
+#pragma once
+
+#include "lvgl.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Detail tiers, most detailed first
+typedef enum {
+    RENDER_LOD_FULL = 0,      // Callsign + altitude, vectors, trails, sweep trail
+    RENDER_LOD_CALLSIGN,      // Callsign only; far targets update less often
+    RENDER_LOD_VECTORS,       // Blips + velocity vectors; no trails or sweep trail blend
+    RENDER_LOD_BLIPS,         // Blips only
+    RENDER_LOD_COUNT
+} render_lod_t;
+
+/**
+ * @brief Time every LVGL refresh on a display and adjust the tier
+ * Must be called with the LVGL lock held.
+ * @param display Display to measure
+ */
+void render_lod_attach_display(lv_display_t *display);
+
+/**
+ * @brief Get the current tier
+ * Always RENDER_LOD_FULL when RENDER_LOD_AUTO is 0.
+ * @return Tier
+ */
+render_lod_t render_lod_get(void);
+
+/**
+ * @brief Get a tier's short name (for logs and the overlay)
+ * @param lod Tier
+ * @return Name
+ */
+const char *render_lod_name(render_lod_t lod);
+
+/**
+ * @brief Get the smoothed refresh time driving the controller
+ * @return Refresh time in µs
+ */
+uint32_t render_lod_get_frame_us(void);
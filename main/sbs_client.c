@@ -0,0 +1,374 @@
+/*
+ * Local Receiver Feed Client Implementation
+ *
+ * SBS messages each carry part of an aircraft's state (identity, position,
+ * velocity), so the feed keeps a small merge table keyed by ICAO. It is
+ * also the conflation stage in front of the store: position messages mark
+ * the aircraft dirty, later ones overwrite the pending state, and every
+ * ADSB_FEED_FLUSH_MS the dirty aircraft go to the callback as one batch.
+ * The store then sees one update (one mutex take, one snapshot) per tick,
+ * sized by the number of moving aircraft rather than the message rate.
+ * Everything runs on the feed task, so the table needs no locking.
+ */
+
+#include "sbs_client.h"
+#include "sbs_parser.h"
+#include "icao_index.h"
+#include "radar_config.h"
+#include "task_layout.h"
+#include "wifi.h"
+#include "esp_log.h"
+#include "mem_budget.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "lwip/sockets.h"
+#include "lwip/netdb.h"
+#include <errno.h>
+#include <string.h>
+
+static const char *TAG = "sbs_client";
+
+#define FEED_RECV_BUFFER 1024
+#define FEED_PRUNE_INTERVAL_MS 5000
+#define FEED_STATS_INTERVAL_MS 60000
+
+// Merged state of one aircraft
+typedef struct {
+    adsb_aircraft_t ac;
+    uint32_t key;          // ICAO key (ICAO_KEY_INVALID = slot unused)
+    uint32_t heard_ms;     // Last message of any type
+    bool dirty;            // New position since the last flush
+} feed_track_t;
+
+// Merge table
+static feed_track_t *s_tracks = NULL;
+static int16_t *s_dirty = NULL;
+static int s_dirty_count = 0;
+static int s_capacity = 0;
+static icao_index_t s_index;
+
+static sbs_parser_t s_parser;
+static adsb_aircraft_t *s_batch = NULL;  // One flush (capacity entries)
+static char s_recv_buf[FEED_RECV_BUFFER];
+
+// Conflation counters since the last stats log
+typedef struct {
+    uint32_t messages;     // Messages merged into the table
+    uint32_t positions;    // Position messages
+    uint32_t conflated;    // Positions overwritten before they were flushed
+    uint32_t flushed;      // Aircraft handed to the store
+    uint32_t flushes;      // Store updates
+    uint32_t dropped;      // Messages for new aircraft while the table was full
+} feed_stats_t;
+
+// Client state
+static adsb_data_callback_t s_data_callback = NULL;
+static TaskHandle_t s_feed_task = NULL;
+static volatile bool s_running = false;
+static volatile bool s_connected = false;
+static volatile uint32_t s_last_position_ms = 0;
+static feed_stats_t s_stats;
+
+// Forward declarations
+static void feed_task(void *pvParameters);
+static int connect_feed(void);
+static void message_callback(const sbs_message_t *msg, void *user_ctx);
+static void flush_dirty(void);
+static void prune_stale(uint32_t now);
+static void log_stats(uint32_t elapsed_ms);
+static uint32_t now_ms(void);
+
+bool sbs_client_init(adsb_data_callback_t callback, int capacity)
+{
+    s_data_callback = callback;
+    s_capacity = capacity;
+
+    s_tracks = mem_budget_calloc(MEM_TAG_FEED, capacity, sizeof(feed_track_t), MALLOC_CAP_SPIRAM);
+    if (s_tracks == NULL) {
+        s_tracks = mem_budget_calloc(MEM_TAG_FEED, capacity, sizeof(feed_track_t), MALLOC_CAP_8BIT);
+    }
+    s_dirty = mem_budget_calloc(MEM_TAG_FEED, capacity, sizeof(int16_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    s_batch = mem_budget_calloc(MEM_TAG_FEED, capacity, sizeof(adsb_aircraft_t), MALLOC_CAP_SPIRAM);
+    if (s_batch == NULL) {
+        s_batch = mem_budget_calloc(MEM_TAG_FEED, capacity, sizeof(adsb_aircraft_t), MALLOC_CAP_8BIT);
+    }
+    if (s_tracks == NULL || s_dirty == NULL || s_batch == NULL || !icao_index_init(&s_index, capacity, MEM_TAG_FEED)) {
+        ESP_LOGE(TAG, "Failed to allocate feed table (%d aircraft)", capacity);
+        return false;
+    }
+    for (int i = 0; i < capacity; i++) {
+        s_tracks[i].key = ICAO_KEY_INVALID;
+    }
+
+    ESP_LOGI(TAG, "Feed client initialized (%s:%d, %d aircraft, %d Hz flush)", ADSB_FEED_HOST, ADSB_FEED_PORT,
+             capacity, 1000 / ADSB_FEED_FLUSH_MS);
+    return true;
+}
+
+void sbs_client_start(void)
+{
+    if (s_feed_task != NULL) {
+        ESP_LOGW(TAG, "Feed client already running");
+        return;
+    }
+    if (s_tracks == NULL) {
+        ESP_LOGE(TAG, "Feed client not initialized");
+        return;
+    }
+
+    s_running = true;
+    if (!task_layout_create(&TASK_LAYOUT_FEED, feed_task, NULL, &s_feed_task)) {
+        s_running = false;
+        s_feed_task = NULL;
+        return;
+    }
+    ESP_LOGI(TAG, "Feed task started");
+}
+
+void sbs_client_stop(void)
+{
+    if (s_feed_task != NULL) {
+        s_running = false;
+        vTaskDelay(pdMS_TO_TICKS(ADSB_FEED_FLUSH_MS * 2));  // recv() times out every flush period
+        s_feed_task = NULL;
+        ESP_LOGI(TAG, "Feed task stopped");
+    }
+}
+
+bool sbs_client_is_connected(void)
+{
+    return s_connected;
+}
+
+int sbs_client_get_data_age_sec(void)
+{
+    if (s_last_position_ms == 0) {
+        return -1;
+    }
+    return (int)((now_ms() - s_last_position_ms) / 1000);
+}
+
+// Internal functions
+
+static void feed_task(void *pvParameters)
+{
+    ESP_LOGI(TAG, "Feed task running, waiting for WiFi...");
+
+    while (s_running) {
+        if (!wifi_is_connected()) {
+            vTaskDelay(pdMS_TO_TICKS(5000));
+            continue;
+        }
+
+        int sock = connect_feed();
+        if (sock < 0) {
+            vTaskDelay(pdMS_TO_TICKS(ADSB_FEED_RECONNECT_MS));
+            continue;
+        }
+
+        sbs_parser_init(&s_parser, message_callback, NULL);
+        s_connected = true;
+        ESP_LOGI(TAG, "Connected to %s:%d", ADSB_FEED_HOST, ADSB_FEED_PORT);
+
+        uint32_t last_flush = now_ms();
+        uint32_t last_prune = last_flush;
+        uint32_t last_stats = last_flush;
+        while (s_running) {
+            int n = recv(sock, s_recv_buf, sizeof(s_recv_buf), 0);
+            if (n > 0) {
+                sbs_parser_feed(&s_parser, s_recv_buf, n);
+            } else if (n == 0) {
+                ESP_LOGW(TAG, "Feed closed by receiver");
+                break;
+            } else if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                ESP_LOGW(TAG, "Feed recv failed: errno %d", errno);
+                break;
+            }
+
+            uint32_t now = now_ms();
+            if (now - last_flush >= ADSB_FEED_FLUSH_MS) {
+                flush_dirty();
+                last_flush = now;
+            }
+            if (now - last_prune >= FEED_PRUNE_INTERVAL_MS) {
+                prune_stale(now);
+                last_prune = now;
+            }
+            if (now - last_stats >= FEED_STATS_INTERVAL_MS) {
+                log_stats(now - last_stats);
+                last_stats = now;
+            }
+        }
+
+        flush_dirty();
+        log_stats(now_ms() - last_stats);
+        close(sock);
+        s_connected = false;
+        ESP_LOGI(TAG, "Disconnected (%lu lines, %lu messages, %lu rejected)",
+                 (unsigned long)s_parser.lines, (unsigned long)s_parser.emitted,
+                 (unsigned long)s_parser.rejected);
+        if (s_running) {
+            vTaskDelay(pdMS_TO_TICKS(ADSB_FEED_RECONNECT_MS));
+        }
+    }
+
+    ESP_LOGI(TAG, "Feed task exiting");
+    task_layout_exit();
+}
+
+static int connect_feed(void)
+{
+    const struct addrinfo hints = {
+        .ai_family = AF_INET,
+        .ai_socktype = SOCK_STREAM,
+    };
+    struct addrinfo *res = NULL;
+    char port[8];
+    snprintf(port, sizeof(port), "%d", ADSB_FEED_PORT);
+
+    int err = getaddrinfo(ADSB_FEED_HOST, port, &hints, &res);
+    if (err != 0 || res == NULL) {
+        ESP_LOGW(TAG, "Cannot resolve %s (%d)", ADSB_FEED_HOST, err);
+        return -1;
+    }
+
+    int sock = socket(res->ai_family, res->ai_socktype, 0);
+    if (sock < 0) {
+        ESP_LOGE(TAG, "Failed to create socket: errno %d", errno);
+        freeaddrinfo(res);
+        return -1;
+    }
+
+    if (connect(sock, res->ai_addr, res->ai_addrlen) != 0) {
+        ESP_LOGW(TAG, "Connect to %s:%d failed: errno %d", ADSB_FEED_HOST, ADSB_FEED_PORT, errno);
+        close(sock);
+        freeaddrinfo(res);
+        return -1;
+    }
+    freeaddrinfo(res);
+
+    // recv() wakes up at least once per flush period so batches go out on time
+    struct timeval timeout = {
+        .tv_sec = ADSB_FEED_FLUSH_MS / 1000,
+        .tv_usec = (ADSB_FEED_FLUSH_MS % 1000) * 1000,
+    };
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    int keep_alive = 1;
+    setsockopt(sock, SOL_SOCKET, SO_KEEPALIVE, &keep_alive, sizeof(keep_alive));
+    return sock;
+}
+
+static void message_callback(const sbs_message_t *msg, void *user_ctx)
+{
+    (void)user_ctx;
+
+    uint32_t key = icao_key_from_hex(msg->hex);
+    if (key == ICAO_KEY_INVALID) {
+        return;
+    }
+
+    uint32_t now = now_ms();
+    bool inserted = false;
+    int idx = icao_index_insert(&s_index, key, &inserted);
+    if (idx == -1) {
+        prune_stale(now);
+        idx = icao_index_insert(&s_index, key, &inserted);
+        if (idx == -1) {
+            if (s_stats.dropped++ % 100 == 0) {
+                ESP_LOGW(TAG, "Feed table full (%d), dropping new aircraft", s_capacity);
+            }
+            return;
+        }
+    }
+
+    feed_track_t *t = &s_tracks[idx];
+    s_stats.messages++;
+    if (inserted) {
+        memset(t, 0, sizeof(*t));
+        t->key = key;
+        strncpy(t->ac.hex, msg->hex, sizeof(t->ac.hex) - 1);
+        t->ac.source = ADSB_SOURCE_LOCAL;
+    }
+    t->heard_ms = now;
+
+    // Merge whichever fields this message carries
+    if (msg->has_callsign) {
+        strncpy(t->ac.callsign, msg->callsign, sizeof(t->ac.callsign) - 1);
+    }
+    if (msg->has_altitude) {
+        t->ac.altitude = msg->altitude;
+    } else if (msg->on_ground) {
+        t->ac.altitude = 0;  // Surface positions have no altitude
+    }
+    if (msg->has_velocity) {
+        t->ac.speed = msg->speed;
+        t->ac.track = msg->track;
+    }
+
+    // Only a new position is worth a store update; other fields ride along
+    if (msg->has_position) {
+        t->ac.lat = msg->lat;
+        t->ac.lon = msg->lon;
+        t->ac.has_position = true;
+        s_last_position_ms = now;
+        s_stats.positions++;
+        if (t->dirty) {
+            s_stats.conflated++;  // Superseded before the store saw it
+        } else {
+            t->dirty = true;
+            s_dirty[s_dirty_count++] = (int16_t)idx;
+        }
+    }
+}
+
+// Hand every dirty aircraft to the callback as one batch
+static void flush_dirty(void)
+{
+    if (s_dirty_count == 0) {
+        return;
+    }
+    for (int i = 0; i < s_dirty_count; i++) {
+        feed_track_t *t = &s_tracks[s_dirty[i]];
+        t->dirty = false;
+        s_batch[i] = t->ac;
+    }
+    if (s_data_callback) {
+        s_data_callback(s_batch, s_dirty_count);
+    }
+    s_stats.flushed += s_dirty_count;
+    s_stats.flushes++;
+    s_dirty_count = 0;
+}
+
+static void prune_stale(uint32_t now)
+{
+    for (int i = 0; i < s_capacity; i++) {
+        feed_track_t *t = &s_tracks[i];
+        if (t->key != ICAO_KEY_INVALID && !t->dirty && now - t->heard_ms > ADSB_AIRCRAFT_STALE_MS) {
+            icao_index_remove(&s_index, t->key);
+            t->key = ICAO_KEY_INVALID;
+        }
+    }
+}
+
+// Message rate in, update rate out, and what conflation saved
+static void log_stats(uint32_t elapsed_ms)
+{
+    if (s_stats.messages == 0 || elapsed_ms == 0) {
+        return;
+    }
+    ESP_LOGI(TAG, "Feed: %lu msg/s, %lu positions, %lu conflated (%lu%%), "
+             "%lu aircraft in %lu store updates, %lu dropped",
+             (unsigned long)(s_stats.messages * 1000ull / elapsed_ms),
+             (unsigned long)s_stats.positions, (unsigned long)s_stats.conflated,
+             (unsigned long)(s_stats.positions ? s_stats.conflated * 100ull / s_stats.positions : 0),
+             (unsigned long)s_stats.flushed, (unsigned long)s_stats.flushes,
+             (unsigned long)s_stats.dropped);
+    memset(&s_stats, 0, sizeof(s_stats));
+}
+
+static uint32_t now_ms(void)
+{
+    return xTaskGetTickCount() * portTICK_PERIOD_MS;
+}
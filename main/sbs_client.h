@@ -0,0 +1,43 @@
+/*
+ * Local Receiver Feed Client
+ * Streams SBS-1 (BaseStation) messages from a readsb/dump1090 receiver
+ * over plain TCP and hands merged aircraft to the same callback as the
+ * ADSB API client, so the store and renderer don't care about the source.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include "adsb_client.h"
+
+/**
+ * @brief Initialize the feed client
+ * @param callback Receives batches of aircraft with source ADSB_SOURCE_LOCAL
+ * @param capacity Aircraft tracked by the feed's merge table
+ * @return true on success
+ */
+bool sbs_client_init(adsb_data_callback_t callback, int capacity);
+
+/**
+ * @brief Start the feed task
+ * Connects to ADSB_FEED_HOST:ADSB_FEED_PORT once Wi-Fi is up and
+ * reconnects with ADSB_FEED_RECONNECT_MS between attempts.
+ */
+void sbs_client_start(void);
+
+/**
+ * @brief Stop the feed task
+ */
+void sbs_client_stop(void);
+
+/**
+ * @brief Check whether the feed socket is connected
+ * @return true while connected
+ */
+bool sbs_client_is_connected(void);
+
+/**
+ * @brief Get seconds since the last position message
+ * @return Seconds since last position, or -1 if none yet
+ */
+int sbs_client_get_data_age_sec(void);
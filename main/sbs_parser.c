@@ -0,0 +1,138 @@
+/*
+ * Streaming SBS-1 (BaseStation) Parser Implementation
+ *
+ * Line layout (0-based field numbers):
+ *   0 "MSG"  1 transmission type  4 hex ident  10 callsign  11 altitude
+ *   12 ground speed  13 track  14 lat  15 lon  21 on ground
+ * Empty fields mean "not in this message".
+ */
+
+#include "sbs_parser.h"
+#include <string.h>
+#include <stdlib.h>
+
+#define SBS_FIELD_COUNT 22
+
+// Forward declarations
+static void parse_line(sbs_parser_t *parser);
+static bool parse_float(const char *field, float *out);
+static bool parse_int(const char *field, int *out);
+
+void sbs_parser_init(sbs_parser_t *parser, sbs_parser_emit_cb_t emit, void *user_ctx)
+{
+    memset(parser, 0, sizeof(*parser));
+    parser->emit = emit;
+    parser->user_ctx = user_ctx;
+}
+
+void sbs_parser_feed(sbs_parser_t *parser, const char *data, int len)
+{
+    for (int i = 0; i < len; i++) {
+        char c = data[i];
+
+        if (c == '\n') {
+            parser->lines++;
+            if (parser->overflow) {
+                parser->rejected++;
+            } else if (parser->line_len > 0) {
+                parser->line[parser->line_len] = '\0';
+                parse_line(parser);
+            }
+            parser->line_len = 0;
+            parser->overflow = false;
+            continue;
+        }
+        if (c == '\r' || parser->overflow) {
+            continue;
+        }
+        if (parser->line_len >= SBS_PARSER_LINE_LEN - 1) {
+            parser->overflow = true;
+            continue;
+        }
+        parser->line[parser->line_len++] = c;
+    }
+}
+
+// Internal functions
+
+static void parse_line(sbs_parser_t *parser)
+{
+    // Split in place; fields past the last comma stay empty
+    char *fields[SBS_FIELD_COUNT];
+    int count = 0;
+    char *p = parser->line;
+    while (count < SBS_FIELD_COUNT) {
+        fields[count++] = p;
+        char *comma = strchr(p, ',');
+        if (comma == NULL) {
+            break;
+        }
+        *comma = '\0';
+        p = comma + 1;
+    }
+    for (int i = count; i < SBS_FIELD_COUNT; i++) {
+        fields[i] = "";
+    }
+
+    if (strcmp(fields[0], "MSG") != 0) {
+        return;  // SEL, ID, AIR, STA and CLK lines carry no track data
+    }
+
+    size_t hex_len = strlen(fields[4]);
+    int type;
+    if (hex_len < 6 || hex_len > 7 || !parse_int(fields[1], &type)) {
+        parser->rejected++;
+        return;
+    }
+
+    sbs_message_t msg;
+    memset(&msg, 0, sizeof(msg));
+    memcpy(msg.hex, fields[4], hex_len);
+    msg.transmission = (uint8_t)type;
+
+    if (fields[10][0] != '\0') {
+        // Callsigns are space padded to 8 characters
+        strncpy(msg.callsign, fields[10], sizeof(msg.callsign) - 1);
+        for (int i = (int)strlen(msg.callsign) - 1; i >= 0 && msg.callsign[i] == ' '; i--) {
+            msg.callsign[i] = '\0';
+        }
+        msg.has_callsign = msg.callsign[0] != '\0';
+    }
+    msg.has_altitude = parse_int(fields[11], &msg.altitude);
+    msg.has_velocity = parse_float(fields[12], &msg.speed) && parse_float(fields[13], &msg.track);
+    msg.has_position = parse_float(fields[14], &msg.lat) && parse_float(fields[15], &msg.lon);
+    msg.on_ground = strcmp(fields[21], "-1") == 0 || strcmp(fields[21], "1") == 0;
+
+    parser->emitted++;
+    if (parser->emit != NULL) {
+        parser->emit(&msg, parser->user_ctx);
+    }
+}
+
+static bool parse_float(const char *field, float *out)
+{
+    if (field[0] == '\0') {
+        return false;
+    }
+    char *end;
+    float value = strtof(field, &end);
+    if (end == field) {
+        return false;
+    }
+    *out = value;
+    return true;
+}
+
+static bool parse_int(const char *field, int *out)
+{
+    if (field[0] == '\0') {
+        return false;
+    }
+    char *end;
+    long value = strtol(field, &end, 10);
+    if (end == field) {
+        return false;
+    }
+    *out = (int)value;
+    return true;
+}
@@ -0,0 +1,68 @@
+/*
+ * Streaming SBS-1 (BaseStation) Parser
+ * Incremental decoder for the CSV feed readsb/dump1090 serve on port 30003
+ *
+ * Bytes are fed as they arrive from the socket; every complete "MSG" line
+ * is decoded into an sbs_message_t and emitted. Each SBS message carries
+ * only some fields (identity, airborne position, velocity, ...), so the
+ * has_* flags say which ones are valid; merging them per aircraft is up
+ * to the caller.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Longest line kept (longer lines are dropped, never overflowed)
+#define SBS_PARSER_LINE_LEN 192
+
+// One decoded MSG line
+typedef struct {
+    char hex[8];           // ICAO hex code
+    uint8_t transmission;  // SBS transmission type (1-8)
+    bool has_callsign;
+    char callsign[12];
+    bool has_altitude;
+    int altitude;          // Feet
+    bool has_velocity;
+    float speed;           // Ground speed in knots
+    float track;           // Degrees
+    bool has_position;
+    float lat;
+    float lon;
+    bool on_ground;
+} sbs_message_t;
+
+// Callback for each decoded message
+typedef void (*sbs_parser_emit_cb_t)(const sbs_message_t *msg, void *user_ctx);
+
+// Parser state (opaque to callers, allocate statically)
+typedef struct {
+    char line[SBS_PARSER_LINE_LEN];
+    int line_len;
+    bool overflow;         // Current line too long, skip to next newline
+
+    sbs_parser_emit_cb_t emit;
+    void *user_ctx;
+    uint32_t lines;        // Complete lines seen
+    uint32_t emitted;      // MSG lines decoded
+    uint32_t rejected;     // Malformed or over-long lines
+} sbs_parser_t;
+
+/**
+ * @brief Reset parser (e.g. after reconnecting)
+ * @param parser Parser state
+ * @param emit Callback invoked once per decoded message
+ * @param user_ctx Opaque pointer passed to the callback
+ */
+void sbs_parser_init(sbs_parser_t *parser, sbs_parser_emit_cb_t emit, void *user_ctx);
+
+/**
+ * @brief Feed a chunk of the stream
+ * Chunk boundaries may fall anywhere in a line.
+ * @param parser Parser state
+ * @param data Chunk data (not NUL-terminated)
+ * @param len Chunk length in bytes
+ */
+void sbs_parser_feed(sbs_parser_t *parser, const char *data, int len);
@@ -19,6 +19,26 @@ static const char *TIMEZONE_OPTIONS =
     "UTC+1\nUTC+2\nUTC+3\nUTC+4\nUTC+5\nUTC+6\n"
     "UTC+7\nUTC+8\nUTC+9\nUTC+10\nUTC+11\nUTC+12\nUTC+13\nUTC+14";
 
+// Max aircraft dropdown options (capacity is applied on restart)
+static const char *MAX_AIRCRAFT_OPTIONS = "64\n128\n256\n512\n1024";
+static const int MAX_AIRCRAFT_VALUES[] = {64, 128, 256, 512, 1024};
+#define MAX_AIRCRAFT_OPTION_COUNT (sizeof(MAX_AIRCRAFT_VALUES) / sizeof(MAX_AIRCRAFT_VALUES[0]))
+
+// Closest option at or below the configured capacity
+static int max_aircraft_to_index(int max_aircraft)
+{
+    int index = 0;
+    for (int i = 0; i < (int)MAX_AIRCRAFT_OPTION_COUNT; i++) {
+        if (MAX_AIRCRAFT_VALUES[i] <= max_aircraft) {
+            index = i;
+        }
+    }
+    return index;
+}
+
+// Render mode dropdown options (index == RENDER_MODE_* value)
+static const char *RENDER_MODE_OPTIONS = "Widgets\nBatched";
+
 // Helper functions for timezone offset conversion
 static int timezone_offset_to_index(int8_t offset)
 {
@@ -51,6 +71,8 @@ static lv_obj_t *s_show_labels_cb = NULL;    // Show aircraft labels checkbox
 
 // Dropdowns
 static lv_obj_t *s_timezone_dd = NULL;       // Timezone dropdown
+static lv_obj_t *s_max_aircraft_dd = NULL;   // Aircraft capacity dropdown
+static lv_obj_t *s_render_mode_dd = NULL;    // Blip render mode dropdown
 
 // Buttons
 static lv_obj_t *s_save_btn = NULL;
@@ -213,6 +235,8 @@ static void save_settings(void)
     // Read dropdown
     int tz_index = lv_dropdown_get_selected(s_timezone_dd);
     int8_t timezone_offset = timezone_index_to_offset(tz_index);
+    int max_aircraft = MAX_AIRCRAFT_VALUES[lv_dropdown_get_selected(s_max_aircraft_dd)];
+    uint8_t render_mode = (uint8_t)lv_dropdown_get_selected(s_render_mode_dd);
 
     // Validate SSID (required if password is set)
     if (strlen(ssid) == 0 && strlen(password) > 0) {
@@ -264,6 +288,8 @@ static void save_settings(void)
     s_current_config.radar_radius_nm = (int)radius;
     s_current_config.show_aircraft_labels = show_labels;
     s_current_config.timezone_offset_hours = timezone_offset;
+    s_current_config.max_aircraft = max_aircraft;
+    s_current_config.render_mode = render_mode;
 
     strncpy(s_current_config.display_label, label, sizeof(s_current_config.display_label) - 1);
     s_current_config.display_label[sizeof(s_current_config.display_label) - 1] = '\0';
@@ -274,6 +300,9 @@ static void save_settings(void)
     ESP_LOGI(TAG, "  Radius: %d NM", s_current_config.radar_radius_nm);
     ESP_LOGI(TAG, "  Show Labels: %s", s_current_config.show_aircraft_labels ? "Yes" : "No");
     ESP_LOGI(TAG, "  Label: %s", s_current_config.display_label);
+    ESP_LOGI(TAG, "  Max Aircraft: %d", s_current_config.max_aircraft);
+    ESP_LOGI(TAG, "  Render Mode: %s",
+             s_current_config.render_mode == RENDER_MODE_BATCHED ? "Batched" : "Widgets");
 
     // Call save callback if registered
     if (s_save_callback != NULL) {
@@ -323,6 +352,8 @@ static void close_panel(void)
     s_radius_label = NULL;
     s_show_labels_cb = NULL;
     s_timezone_dd = NULL;
+    s_max_aircraft_dd = NULL;
+    s_render_mode_dd = NULL;
     s_save_btn = NULL;
     s_cancel_btn = NULL;
     s_reset_btn = NULL;
@@ -486,6 +517,36 @@ void settings_panel_create(lv_obj_t *parent, const radar_config_t *current_cfg)
         lv_color_make(COLOR_SWEEP_R, COLOR_SWEEP_G, COLOR_SWEEP_B), 0);
     lv_obj_set_style_bg_color(s_timezone_dd, lv_color_make(0x40, 0x40, 0x40), 0);
 
+    // Max aircraft dropdown
+    lv_obj_t *max_ac_label = lv_label_create(s_panel);
+    lv_label_set_text(max_ac_label, "Max Aircraft (applies on restart):");
+    lv_obj_set_style_text_color(max_ac_label,
+        lv_color_make(COLOR_SWEEP_R, COLOR_SWEEP_G, COLOR_SWEEP_B), 0);
+
+    s_max_aircraft_dd = lv_dropdown_create(s_panel);
+    lv_obj_set_width(s_max_aircraft_dd, LV_PCT(100));
+    lv_dropdown_set_options(s_max_aircraft_dd, MAX_AIRCRAFT_OPTIONS);
+    lv_dropdown_set_selected(s_max_aircraft_dd,
+        max_aircraft_to_index(s_current_config.max_aircraft));
+    lv_obj_set_style_text_color(s_max_aircraft_dd,
+        lv_color_make(COLOR_SWEEP_R, COLOR_SWEEP_G, COLOR_SWEEP_B), 0);
+    lv_obj_set_style_bg_color(s_max_aircraft_dd, lv_color_make(0x40, 0x40, 0x40), 0);
+
+    // Render mode dropdown
+    lv_obj_t *render_label = lv_label_create(s_panel);
+    lv_label_set_text(render_label, "Blip Rendering:");
+    lv_obj_set_style_text_color(render_label,
+        lv_color_make(COLOR_SWEEP_R, COLOR_SWEEP_G, COLOR_SWEEP_B), 0);
+
+    s_render_mode_dd = lv_dropdown_create(s_panel);
+    lv_obj_set_width(s_render_mode_dd, LV_PCT(100));
+    lv_dropdown_set_options(s_render_mode_dd, RENDER_MODE_OPTIONS);
+    lv_dropdown_set_selected(s_render_mode_dd,
+        s_current_config.render_mode == RENDER_MODE_WIDGETS ? RENDER_MODE_WIDGETS : RENDER_MODE_BATCHED);
+    lv_obj_set_style_text_color(s_render_mode_dd,
+        lv_color_make(COLOR_SWEEP_R, COLOR_SWEEP_G, COLOR_SWEEP_B), 0);
+    lv_obj_set_style_bg_color(s_render_mode_dd, lv_color_make(0x40, 0x40, 0x40), 0);
+
     // Display Label input
     lv_obj_t *label_label = lv_label_create(s_panel);
     lv_label_set_text(label_label, "Display Label:");
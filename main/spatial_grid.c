@@ -0,0 +1,168 @@
+/*
+ * Uniform Spatial Grid Implementation
+ *
+ * Cells hold intrusive doubly linked lists of ids, so insert, move and
+ * remove are O(1) with no per-id allocation. Queries walk only the cells
+ * overlapping the requested area.
+ */
+
+#include "spatial_grid.h"
+#include "mem_budget.h"
+#include "esp_heap_caps.h"
+#include <string.h>
+
+// Forward declarations
+static int cell_coord(int v, int cell_px, int limit);
+static void unlink_id(spatial_grid_t *grid, int id);
+
+bool spatial_grid_init(spatial_grid_t *grid, int width, int height, int cell_px, int capacity, mem_tag_t tag)
+{
+    memset(grid, 0, sizeof(*grid));
+    grid->tag = tag;
+    if (width <= 0 || height <= 0 || cell_px <= 0 || capacity <= 0) {
+        return false;
+    }
+
+    grid->cols = (width + cell_px - 1) / cell_px;
+    grid->rows = (height + cell_px - 1) / cell_px;
+    grid->cell_px = cell_px;
+    grid->capacity = capacity;
+
+    // Walked on every hit test and label placement: keep in internal RAM
+    const uint32_t caps = MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT;
+    grid->head = mem_budget_malloc(grid->tag, grid->cols * grid->rows * sizeof(int16_t), caps);
+    grid->next = mem_budget_malloc(grid->tag, capacity * sizeof(int16_t), caps);
+    grid->prev = mem_budget_malloc(grid->tag, capacity * sizeof(int16_t), caps);
+    grid->cell = mem_budget_malloc(grid->tag, capacity * sizeof(int16_t), caps);
+    grid->x = mem_budget_malloc(grid->tag, capacity * sizeof(int16_t), caps);
+    grid->y = mem_budget_malloc(grid->tag, capacity * sizeof(int16_t), caps);
+    if (grid->head == NULL || grid->next == NULL || grid->prev == NULL ||
+        grid->cell == NULL || grid->x == NULL || grid->y == NULL) {
+        mem_budget_free(grid->tag, grid->head);
+        mem_budget_free(grid->tag, grid->next);
+        mem_budget_free(grid->tag, grid->prev);
+        mem_budget_free(grid->tag, grid->cell);
+        mem_budget_free(grid->tag, grid->x);
+        mem_budget_free(grid->tag, grid->y);
+        memset(grid, 0, sizeof(*grid));
+        return false;
+    }
+
+    spatial_grid_clear(grid);
+    return true;
+}
+
+void spatial_grid_clear(spatial_grid_t *grid)
+{
+    // 0xFF bytes = -1 in every int16_t
+    memset(grid->head, 0xFF, grid->cols * grid->rows * sizeof(int16_t));
+    memset(grid->cell, 0xFF, grid->capacity * sizeof(int16_t));
+}
+
+void spatial_grid_move(spatial_grid_t *grid, int id, int x, int y)
+{
+    if (id < 0 || id >= grid->capacity) {
+        return;
+    }
+
+    grid->x[id] = (int16_t)x;
+    grid->y[id] = (int16_t)y;
+
+    int cell = cell_coord(y, grid->cell_px, grid->rows) * grid->cols +
+               cell_coord(x, grid->cell_px, grid->cols);
+    if (cell == grid->cell[id]) {
+        return;  // Moved within its cell
+    }
+
+    unlink_id(grid, id);
+    grid->cell[id] = (int16_t)cell;
+    grid->prev[id] = -1;
+    grid->next[id] = grid->head[cell];
+    if (grid->head[cell] != -1) {
+        grid->prev[grid->head[cell]] = (int16_t)id;
+    }
+    grid->head[cell] = (int16_t)id;
+}
+
+void spatial_grid_remove(spatial_grid_t *grid, int id)
+{
+    if (id < 0 || id >= grid->capacity) {
+        return;
+    }
+    unlink_id(grid, id);
+    grid->cell[id] = -1;
+}
+
+int spatial_grid_nearest(const spatial_grid_t *grid, int x, int y, int radius)
+{
+    int cx1 = cell_coord(x - radius, grid->cell_px, grid->cols);
+    int cx2 = cell_coord(x + radius, grid->cell_px, grid->cols);
+    int cy1 = cell_coord(y - radius, grid->cell_px, grid->rows);
+    int cy2 = cell_coord(y + radius, grid->cell_px, grid->rows);
+
+    int best = -1;
+    int32_t best_d2 = (int32_t)radius * radius;
+    for (int cy = cy1; cy <= cy2; cy++) {
+        for (int cx = cx1; cx <= cx2; cx++) {
+            for (int id = grid->head[cy * grid->cols + cx]; id != -1; id = grid->next[id]) {
+                int32_t dx = grid->x[id] - x;
+                int32_t dy = grid->y[id] - y;
+                int32_t d2 = dx * dx + dy * dy;
+                if (d2 <= best_d2) {
+                    best_d2 = d2;
+                    best = id;
+                }
+            }
+        }
+    }
+    return best;
+}
+
+bool spatial_grid_query(const spatial_grid_t *grid, int x1, int y1, int x2, int y2,
+                        spatial_grid_visit_t visit, void *ctx)
+{
+    int cx1 = cell_coord(x1, grid->cell_px, grid->cols);
+    int cx2 = cell_coord(x2, grid->cell_px, grid->cols);
+    int cy1 = cell_coord(y1, grid->cell_px, grid->rows);
+    int cy2 = cell_coord(y2, grid->cell_px, grid->rows);
+
+    for (int cy = cy1; cy <= cy2; cy++) {
+        for (int cx = cx1; cx <= cx2; cx++) {
+            for (int id = grid->head[cy * grid->cols + cx]; id != -1; id = grid->next[id]) {
+                if (grid->x[id] >= x1 && grid->x[id] <= x2 &&
+                    grid->y[id] >= y1 && grid->y[id] <= y2 && !visit(id, ctx)) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// Internal functions
+
+// Cell row/column for a coordinate, clamped to the grid
+static int cell_coord(int v, int cell_px, int limit)
+{
+    if (v < 0) {
+        return 0;
+    }
+    int c = v / cell_px;
+    return c < limit ? c : limit - 1;
+}
+
+static void unlink_id(spatial_grid_t *grid, int id)
+{
+    int cell = grid->cell[id];
+    if (cell == -1) {
+        return;
+    }
+    if (grid->prev[id] != -1) {
+        grid->next[grid->prev[id]] = grid->next[id];
+    } else {
+        grid->head[cell] = grid->next[id];
+    }
+    if (grid->next[id] != -1) {
+        grid->prev[grid->next[id]] = grid->prev[id];
+    }
+}
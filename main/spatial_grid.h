@@ -0,0 +1,95 @@
+/*
+ * Uniform Spatial Grid
+ * Buckets screen points into square cells (SPATIAL_GRID_CELL_PX) so
+ * "what is near this pixel" touches a handful of cells instead of every
+ * aircraft. Each id (0..capacity-1) sits in at most one cell; moving an
+ * id only relinks it when it crosses a cell boundary, so the grid is
+ * maintained incrementally as blips move.
+ */
+
+#pragma once
+
+#include "mem_budget.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct {
+    int16_t *head;    // First id per cell (-1 = empty)
+    int16_t *next;    // Per-id links within its cell
+    int16_t *prev;
+    int16_t *cell;    // Cell an id is filed under (-1 = not in grid)
+    int16_t *x;       // Last position of each id
+    int16_t *y;
+    int cols;
+    int rows;
+    int cell_px;
+    int capacity;
+    mem_tag_t tag;    // Owner the arrays are charged to
+} spatial_grid_t;
+
+/**
+ * @brief Visitor for spatial_grid_query()
+ * @param id Id whose point lies in the query rectangle
+ * @param ctx Caller context
+ * @return false to stop the query
+ */
+typedef bool (*spatial_grid_visit_t)(int id, void *ctx);
+
+/**
+ * @brief Allocate a grid covering width x height pixels
+ * Points outside the area are filed in the nearest edge cell.
+ * @param grid Grid to initialize
+ * @param width Covered width in pixels
+ * @param height Covered height in pixels
+ * @param cell_px Cell size in pixels
+ * @param capacity Number of ids (0..capacity-1)
+ * @param tag Subsystem the arrays are charged to
+ * @return true on success
+ */
+bool spatial_grid_init(spatial_grid_t *grid, int width, int height, int cell_px, int capacity, mem_tag_t tag);
+
+/**
+ * @brief Remove every id
+ * @param grid Grid
+ */
+void spatial_grid_clear(spatial_grid_t *grid);
+
+/**
+ * @brief Insert an id or move it to a new position
+ * @param grid Grid
+ * @param id Id (0..capacity-1)
+ * @param x Position in pixels
+ * @param y Position in pixels
+ */
+void spatial_grid_move(spatial_grid_t *grid, int id, int x, int y);
+
+/**
+ * @brief Remove an id (no-op if not in the grid)
+ * @param grid Grid
+ * @param id Id
+ */
+void spatial_grid_remove(spatial_grid_t *grid, int id);
+
+/**
+ * @brief Find the id nearest to a point
+ * @param grid Grid
+ * @param x Point in pixels
+ * @param y Point in pixels
+ * @param radius Maximum distance in pixels
+ * @return Nearest id within radius, or -1
+ */
+int spatial_grid_nearest(const spatial_grid_t *grid, int x, int y, int radius);
+
+/**
+ * @brief Visit every id whose point lies in a rectangle (inclusive)
+ * @param grid Grid
+ * @param x1 Left edge
+ * @param y1 Top edge
+ * @param x2 Right edge
+ * @param y2 Bottom edge
+ * @param visit Called once per id
+ * @param ctx Passed to visit
+ * @return false if a visitor stopped the query early
+ */
+bool spatial_grid_query(const spatial_grid_t *grid, int x1, int y1, int x2, int y2,
+                        spatial_grid_visit_t visit, void *ctx);
@@ -0,0 +1,240 @@
+/*
+ * Radar Sweep Layer Implementation
+ *
+ * The trail is split into bands of SWEEP_TRAIL_BAND_DEGREES anchored to
+ * absolute bearings. Band 0 runs from the last band boundary up to the
+ * leading edge and is drawn at full trail opacity; older bands fade out
+ * using a precomputed opacity table. Because the band boundaries do not
+ * move with the sweep, a frame normally only changes the thin sector the
+ * leading edge moved through. The whole trail is repainted only when the
+ * leading edge crosses into the next band and every band steps one
+ * opacity level down.
+ *
+ * Bearings follow the aircraft convention: 0 = North, clockwise, in
+ * integer decidegrees; rim points come from the radar_math sine table.
+ */
+
+#include "sweep_layer.h"
+#include "radar_math.h"
+#include "radar_config.h"
+#include "esp_log.h"
+
+static const char *TAG = "sweep_layer";
+
+#define BAND_COUNT (SWEEP_TRAIL_DEGREES / SWEEP_TRAIL_BAND_DEGREES)
+#define BOUNDARY_COUNT (360 / SWEEP_TRAIL_BAND_DEGREES)
+#define BAND_DECIDEG (SWEEP_TRAIL_BAND_DEGREES * 10)
+#define TRAIL_PEAK_OPA LV_OPA_40        // Same peak as the old lv_arc trail
+#define LINE_WIDTH 2
+
+// Invalidation granularity: a sector is split into pieces no wider than
+// SECTOR_CHUNK_DEGREES and RADIAL_SEGMENTS rings so that thin diagonal
+// sectors do not invalidate their whole bounding square
+#define SECTOR_CHUNK_DECIDEG 150
+#define RADIAL_SEGMENTS 6
+#define INVALIDATE_PAD 3
+
+static lv_obj_t *s_layer = NULL;
+
+// Rim points of every band boundary, relative to the scope centre
+static lv_point_precise_t s_rim[BOUNDARY_COUNT];
+
+// Opacity of each band, band 0 = newest
+static lv_opa_t s_band_opa[BAND_COUNT];
+
+// Current sweep state
+static int s_angle = 0;                  // Decidegrees
+static int s_band = 0;                   // Boundary index at or before s_angle
+static lv_point_precise_t s_lead;        // Rim point of the leading edge
+static bool s_has_angle = false;
+static bool s_trail_enabled = true;
+
+// Forward declarations
+static void layer_draw_cb(lv_event_t *e);
+static void invalidate_sector(int start_decideg, int span_decideg);
+static void bearing_to_point(int bearing_decideg, int radius, lv_point_precise_t *out);
+
+bool sweep_layer_init(lv_obj_t *parent)
+{
+    if (parent == NULL) {
+        return false;
+    }
+
+    for (int i = 0; i < BOUNDARY_COUNT; i++) {
+        bearing_to_point(i * BAND_DECIDEG, RADAR_DISPLAY_RADIUS, &s_rim[i]);
+    }
+
+    // Quadratic fade from the peak down to nearly transparent
+    for (int k = 0; k < BAND_COUNT; k++) {
+        float remain = (float)(BAND_COUNT - k) / (float)BAND_COUNT;
+        s_band_opa[k] = (lv_opa_t)(TRAIL_PEAK_OPA * remain * remain);
+    }
+
+    s_layer = lv_obj_create(parent);
+    lv_obj_remove_style_all(s_layer);
+    lv_obj_set_size(s_layer, SCREEN_SIZE, SCREEN_SIZE);
+    lv_obj_set_pos(s_layer, 0, 0);
+    lv_obj_clear_flag(s_layer, LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_clear_flag(s_layer, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_add_event_cb(s_layer, layer_draw_cb, LV_EVENT_DRAW_MAIN, NULL);
+
+    s_has_angle = false;
+    sweep_layer_set_angle(0);
+
+    ESP_LOGI(TAG, "Sweep layer created (%d trail bands of %d°)", BAND_COUNT, SWEEP_TRAIL_BAND_DEGREES);
+    return true;
+}
+
+void sweep_layer_set_angle(int bearing_decideg)
+{
+    if (s_layer == NULL) {
+        return;
+    }
+
+    bearing_decideg %= RADAR_MATH_DECIDEG_FULL;
+    if (bearing_decideg < 0) {
+        bearing_decideg += RADAR_MATH_DECIDEG_FULL;
+    }
+    int band = bearing_decideg / BAND_DECIDEG;
+
+    if (!s_has_angle) {
+        lv_obj_invalidate(s_layer);
+    } else if (band != s_band && s_trail_enabled) {
+        // Every band steps down one level: repaint from the old tail to the new edge
+        int tail = (s_band - (BAND_COUNT - 1)) * BAND_DECIDEG;
+        int span = (bearing_decideg - tail + 2 * RADAR_MATH_DECIDEG_FULL) % RADAR_MATH_DECIDEG_FULL;
+        invalidate_sector(tail, span);
+    } else {
+        int span = (bearing_decideg - s_angle + RADAR_MATH_DECIDEG_FULL) % RADAR_MATH_DECIDEG_FULL;
+        invalidate_sector(s_angle, span);
+    }
+
+    s_angle = bearing_decideg;
+    s_band = band;
+    bearing_to_point(bearing_decideg, RADAR_DISPLAY_RADIUS, &s_lead);
+    s_has_angle = true;
+}
+
+void sweep_layer_set_trail(bool enabled)
+{
+    if (s_layer == NULL || enabled == s_trail_enabled) {
+        return;
+    }
+    s_trail_enabled = enabled;
+    lv_obj_invalidate(s_layer);
+    ESP_LOGI(TAG, "Sweep trail %s", enabled ? "on" : "off");
+}
+
+// Internal functions
+
+static void layer_draw_cb(lv_event_t *e)
+{
+    lv_layer_t *layer = lv_event_get_layer(e);
+    lv_obj_t *obj = lv_event_get_target(e);
+
+    lv_area_t coords;
+    lv_obj_get_coords(obj, &coords);
+    int32_t cx = coords.x1 + SCREEN_CENTER_X;
+    int32_t cy = coords.y1 + SCREEN_CENTER_Y;
+
+    lv_color_t color = lv_color_make(COLOR_SWEEP_R, COLOR_SWEEP_G, COLOR_SWEEP_B);
+
+    // Trail, oldest band first
+    lv_draw_triangle_dsc_t tri;
+    lv_draw_triangle_dsc_init(&tri);
+    tri.bg_color = color;
+
+    for (int k = BAND_COUNT - 1; k >= 0 && s_trail_enabled; k--) {
+        int start = (s_band - k + BOUNDARY_COUNT) % BOUNDARY_COUNT;
+        const lv_point_precise_t *p0 = &s_rim[start];
+        const lv_point_precise_t *p1 = (k == 0) ? &s_lead : &s_rim[(start + 1) % BOUNDARY_COUNT];
+
+        tri.bg_opa = s_band_opa[k];
+        tri.p[0].x = cx;
+        tri.p[0].y = cy;
+        tri.p[1].x = cx + p0->x;
+        tri.p[1].y = cy + p0->y;
+        tri.p[2].x = cx + p1->x;
+        tri.p[2].y = cy + p1->y;
+        lv_draw_triangle(layer, &tri);
+    }
+
+    // Leading edge
+    lv_draw_line_dsc_t line;
+    lv_draw_line_dsc_init(&line);
+    line.color = color;
+    line.width = LINE_WIDTH;
+    line.opa = LV_OPA_COVER;
+    line.round_start = 1;
+    line.round_end = 1;
+    line.p1.x = cx;
+    line.p1.y = cy;
+    line.p2.x = cx + s_lead.x;
+    line.p2.y = cy + s_lead.y;
+    lv_draw_line(layer, &line);
+}
+
+// Invalidate the pie slice [start, start + span] as a set of small boxes
+static void invalidate_sector(int start_decideg, int span_decideg)
+{
+    if (span_decideg <= 0) {
+        return;
+    }
+    if (span_decideg >= RADAR_MATH_DECIDEG_FULL / 2) {
+        lv_obj_invalidate(s_layer);
+        return;
+    }
+
+    lv_area_t coords;
+    lv_obj_get_coords(s_layer, &coords);
+
+    int chunks = (span_decideg + SECTOR_CHUNK_DECIDEG - 1) / SECTOR_CHUNK_DECIDEG;
+
+    for (int c = 0; c < chunks; c++) {
+        int a0 = start_decideg + span_decideg * c / chunks;
+        int a1 = start_decideg + span_decideg * (c + 1) / chunks;
+
+        // Unit vectors of both edges and the middle (covers the arc bulge)
+        int angles[3] = {a0, a1, (a0 + a1) / 2};
+        q16_t ux[3], uy[3];
+        for (int p = 0; p < 3; p++) {
+            ux[p] = radar_math_sin(angles[p]);
+            uy[p] = -radar_math_cos(angles[p]);
+        }
+
+        for (int seg = 0; seg < RADIAL_SEGMENTS; seg++) {
+            int32_t r0 = RADAR_DISPLAY_RADIUS * seg / RADIAL_SEGMENTS;
+            int32_t r1 = RADAR_DISPLAY_RADIUS * (seg + 1) / RADIAL_SEGMENTS;
+
+            // Extents in Q16 pixels; the pad absorbs the rounding
+            q16_t min_x = INT32_MAX, min_y = INT32_MAX, max_x = INT32_MIN, max_y = INT32_MIN;
+            for (int p = 0; p < 3; p++) {
+                q16_t xs[2] = {ux[p] * r0, ux[p] * r1};
+                q16_t ys[2] = {uy[p] * r0, uy[p] * r1};
+                for (int q = 0; q < 2; q++) {
+                    min_x = xs[q] < min_x ? xs[q] : min_x;
+                    max_x = xs[q] > max_x ? xs[q] : max_x;
+                    min_y = ys[q] < min_y ? ys[q] : min_y;
+                    max_y = ys[q] > max_y ? ys[q] : max_y;
+                }
+            }
+
+            lv_area_t area;
+            lv_area_set(&area,
+                        coords.x1 + SCREEN_CENTER_X + (min_x >> 16) - INVALIDATE_PAD,
+                        coords.y1 + SCREEN_CENTER_Y + (min_y >> 16) - INVALIDATE_PAD,
+                        coords.x1 + SCREEN_CENTER_X + (max_x >> 16) + 1 + INVALIDATE_PAD,
+                        coords.y1 + SCREEN_CENTER_Y + (max_y >> 16) + 1 + INVALIDATE_PAD);
+            lv_obj_invalidate_area(s_layer, &area);
+        }
+    }
+}
+
+// Point at a bearing and radius, relative to the scope centre
+static void bearing_to_point(int bearing_decideg, int radius, lv_point_precise_t *out)
+{
+    int dx, dy;
+    radar_math_polar(radius << 16, bearing_decideg, &dx, &dy);
+    out->x = (lv_value_precise_t)dx;
+    out->y = (lv_value_precise_t)dy;
+}
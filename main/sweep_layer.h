@@ -0,0 +1,34 @@
+/*
+ * Radar Sweep Layer
+ * Draws the sweep line and fading trail from a precomputed band table and
+ * invalidates only the sectors that change between frames
+ */
+
+#pragma once
+
+#include "lvgl.h"
+#include <stdbool.h>
+
+/**
+ * @brief Create the sweep layer object
+ * A transparent, non-clickable full-screen child of the radar container.
+ * @param parent Radar container
+ * @return true on success
+ */
+bool sweep_layer_init(lv_obj_t *parent);
+
+/**
+ * @brief Move the sweep to a new angle
+ * Invalidates the sector between the previous and new leading edge, plus
+ * the whole trail when it steps to the next band.
+ * @param bearing_decideg Leading edge bearing in decidegrees (0 = North,
+ *        clockwise; wrapped into 0-3599)
+ */
+void sweep_layer_set_angle(int bearing_decideg);
+
+/**
+ * @brief Draw or drop the blended trail (the leading edge is always drawn)
+ * Without the trail each frame only repaints the sector the edge moved through.
+ * @param enabled true to draw the trail
+ */
+void sweep_layer_set_trail(bool enabled);
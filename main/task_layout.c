@@ -0,0 +1,154 @@
+/*
+ * Pipeline Task Layout Implementation
+ */
+
+#include "task_layout.h"
+#include "sdkconfig.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_memory_utils.h"
+
+static const char *TAG = "task_layout";
+
+#ifdef CONFIG_RADAR_POLL_TASK_STACK_PSRAM
+#define POLL_STACK_PSRAM true
+#else
+#define POLL_STACK_PSRAM false
+#endif
+
+#ifdef CONFIG_RADAR_PROJECTION_TASK_STACK_PSRAM
+#define PROJECTION_STACK_PSRAM true
+#else
+#define PROJECTION_STACK_PSRAM false
+#endif
+
+#ifdef CONFIG_RADAR_FEED_TASK_STACK_PSRAM
+#define FEED_STACK_PSRAM true
+#else
+#define FEED_STACK_PSRAM false
+#endif
+
+#ifdef CONFIG_RADAR_RENDER_TASK_STACK_PSRAM
+#define RENDER_STACK_PSRAM true
+#else
+#define RENDER_STACK_PSRAM false
+#endif
+
+const task_layout_t TASK_LAYOUT_POLL = {
+    .name = "adsb_poll",
+    .stack_size = CONFIG_RADAR_POLL_TASK_STACK,
+    .priority = CONFIG_RADAR_POLL_TASK_PRIORITY,
+    .core = CONFIG_RADAR_POLL_TASK_CORE,
+    .stack_in_psram = POLL_STACK_PSRAM,
+};
+
+const task_layout_t TASK_LAYOUT_PROJECTION = {
+    .name = "dr_step",
+    .stack_size = CONFIG_RADAR_PROJECTION_TASK_STACK,
+    .priority = CONFIG_RADAR_PROJECTION_TASK_PRIORITY,
+    .core = CONFIG_RADAR_PROJECTION_TASK_CORE,
+    .stack_in_psram = PROJECTION_STACK_PSRAM,
+};
+
+const task_layout_t TASK_LAYOUT_FEED = {
+    .name = "sbs_feed",
+    .stack_size = CONFIG_RADAR_FEED_TASK_STACK,
+    .priority = CONFIG_RADAR_FEED_TASK_PRIORITY,
+    .core = CONFIG_RADAR_FEED_TASK_CORE,
+    .stack_in_psram = FEED_STACK_PSRAM,
+};
+
+const task_layout_t TASK_LAYOUT_RENDER = {
+    .name = "taskLVGL",
+    .stack_size = CONFIG_RADAR_RENDER_TASK_STACK,
+    .priority = CONFIG_RADAR_RENDER_TASK_PRIORITY,
+    .core = CONFIG_RADAR_RENDER_TASK_CORE,
+    .stack_in_psram = RENDER_STACK_PSRAM,
+};
+
+const task_layout_t TASK_LAYOUT_PERSIST = {
+    .name = "persist",
+    .stack_size = CONFIG_RADAR_PERSIST_TASK_STACK,
+    .priority = CONFIG_RADAR_PERSIST_TASK_PRIORITY,
+    .core = CONFIG_RADAR_PERSIST_TASK_CORE,
+    .stack_in_psram = false,  // Flash writes cannot run on a PSRAM stack
+};
+
+// Forward declarations
+static BaseType_t core_id(const task_layout_t *layout);
+static void reaper_task(void *arg);
+
+bool task_layout_create(const task_layout_t *layout, TaskFunction_t fn, void *arg, TaskHandle_t *out_handle)
+{
+    BaseType_t ret;
+    if (layout->stack_in_psram) {
+        ret = xTaskCreatePinnedToCoreWithCaps(fn, layout->name, layout->stack_size, arg,
+                                              layout->priority, out_handle, core_id(layout),
+                                              MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    } else {
+        ret = xTaskCreatePinnedToCore(fn, layout->name, layout->stack_size, arg,
+                                      layout->priority, out_handle, core_id(layout));
+    }
+
+    if (ret != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create %s task (%lu B stack in %s)", layout->name,
+                 (unsigned long)layout->stack_size, layout->stack_in_psram ? "PSRAM" : "internal RAM");
+        return false;
+    }
+    return true;
+}
+
+void task_layout_exit(void)
+{
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    if (esp_ptr_internal(pxTaskGetStackStart(self))) {
+        vTaskDelete(NULL);
+        return;
+    }
+
+    // vTaskDeleteWithCaps() frees the stack, so it must run on another task
+    xTaskCreate(reaper_task, "task_reap", 2048, self, tskIDLE_PRIORITY + 1, NULL);
+    vTaskSuspend(NULL);
+}
+
+void task_layout_apply_lvgl(lvgl_port_cfg_t *cfg)
+{
+    cfg->task_priority = TASK_LAYOUT_RENDER.priority;
+    cfg->task_stack = TASK_LAYOUT_RENDER.stack_size;
+    cfg->task_affinity = TASK_LAYOUT_RENDER.core;
+    cfg->task_stack_caps = TASK_LAYOUT_RENDER.stack_in_psram ?
+                           (MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT) :
+                           (MALLOC_CAP_INTERNAL | MALLOC_CAP_DEFAULT);
+}
+
+void task_layout_log(void)
+{
+    const task_layout_t *stages[] = {&TASK_LAYOUT_RENDER, &TASK_LAYOUT_POLL, &TASK_LAYOUT_PROJECTION,
+                                     &TASK_LAYOUT_FEED, &TASK_LAYOUT_PERSIST};
+    for (int i = 0; i < (int)(sizeof(stages) / sizeof(stages[0])); i++) {
+        const task_layout_t *l = stages[i];
+        ESP_LOGI(TAG, "  %-10s core %-3s prio %2u  stack %5lu B (%s)", l->name,
+                 l->core < 0 ? "any" : (l->core == 0 ? "0" : "1"),
+                 (unsigned)l->priority, (unsigned long)l->stack_size,
+                 l->stack_in_psram ? "PSRAM" : "internal");
+    }
+}
+
+// Internal functions
+
+static BaseType_t core_id(const task_layout_t *layout)
+{
+    return layout->core < 0 ? tskNO_AFFINITY : (BaseType_t)layout->core;
+}
+
+static void reaper_task(void *arg)
+{
+    TaskHandle_t task = (TaskHandle_t)arg;
+
+    // Wait until the exiting task has suspended itself
+    while (eTaskGetState(task) != eSuspended) {
+        vTaskDelay(1);
+    }
+    vTaskDeleteWithCaps(task);
+    vTaskDelete(NULL);
+}
@@ -0,0 +1,56 @@
+/*
+ * Pipeline Task Layout
+ * Core affinity, priority and stack placement for each pipeline stage,
+ * configured in menuconfig under "ADSB Radar Task Layout"
+ */
+
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "bsp/esp-bsp.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct {
+    const char *name;      // Task name
+    uint32_t stack_size;   // Bytes
+    UBaseType_t priority;
+    int core;              // -1 = no affinity
+    bool stack_in_psram;   // Stack from PSRAM instead of internal RAM
+} task_layout_t;
+
+// Pipeline stages
+extern const task_layout_t TASK_LAYOUT_POLL;        // HTTP fetch + streaming parse
+extern const task_layout_t TASK_LAYOUT_PROJECTION;  // Store dead reckoning
+extern const task_layout_t TASK_LAYOUT_FEED;        // Local receiver socket + SBS parse
+extern const task_layout_t TASK_LAYOUT_RENDER;      // LVGL port task
+extern const task_layout_t TASK_LAYOUT_PERSIST;     // Background NVS writes
+
+/**
+ * @brief Create a task with the given layout
+ * @param layout Stage layout
+ * @param fn Task function
+ * @param arg Task argument
+ * @param out_handle Optional created task handle
+ * @return true on success
+ */
+bool task_layout_create(const task_layout_t *layout, TaskFunction_t fn, void *arg, TaskHandle_t *out_handle);
+
+/**
+ * @brief Delete the calling task
+ * Use instead of vTaskDelete(NULL) in tasks made by task_layout_create(),
+ * which may own a PSRAM stack that cannot be freed by the task itself.
+ */
+void task_layout_exit(void);
+
+/**
+ * @brief Apply the render stage layout to the LVGL port configuration
+ * @param cfg LVGL port config passed to the BSP
+ */
+void task_layout_apply_lvgl(lvgl_port_cfg_t *cfg);
+
+/**
+ * @brief Log the configured layout of every stage
+ */
+void task_layout_log(void);
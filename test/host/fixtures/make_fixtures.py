@@ -0,0 +1,144 @@
+"""
+Regenerate the adsb.lol fixtures used by the host tests.
+
+The fixtures are synthesized, not live captures. They use the structure of
+an adsb.lol /v2/point/{lat}/{lon}/{radius} response: the "ac" array carries
+the full readsb field set (nested "nav_modes", "mlat", "tisb" and
+"lastPosition" members, "alt_baro": "ground", "~" TIS-B addresses, padded
+callsigns), one aircraft per line, followed by the msg/now/total/ctime/ptime
+trailer. Traffic is laid out around the default HOME_LAT/HOME_LON with a
+fixed seed, so the files, and the counts the tests check, never change
+between runs.
+
+    python3 make_fixtures.py        # writes point_light.json, point_heavy.json
+"""
+
+import json
+import math
+import os
+import random
+
+HOME_LAT = -33.8127201
+HOME_LON = 151.2059618
+NOW_MS = 1728918000123
+
+AIRPORTS = [
+    (-33.9461, 151.1772),   # YSSY
+    (-33.9249, 150.9882),   # YSBK
+    (-32.7950, 151.8343),   # YWLM
+    (-35.3069, 149.1950),   # YSCB
+]
+
+TYPES = ["B738", "A320", "A321", "B789", "A333", "DH8D", "E190", "B77W", "A388", "C172", "PC12", "SF34"]
+OPERATORS = ["QFA", "VOZ", "JST", "RXA", "QLK", "UAE", "SIA", "ANZ", "CPA", "FD"]
+NAV_MODES = ["autopilot", "althold", "vnav", "lnav", "approach", "tcas"]
+
+
+def offset(lat, lon, distance_nm, bearing_deg):
+    """Great-circle destination point (matches the store's haversine model)."""
+    r = 3440.065
+    lat1 = math.radians(lat)
+    lon1 = math.radians(lon)
+    brg = math.radians(bearing_deg)
+    d = distance_nm / r
+    lat2 = math.asin(math.sin(lat1) * math.cos(d) + math.cos(lat1) * math.sin(d) * math.cos(brg))
+    lon2 = lon1 + math.atan2(math.sin(brg) * math.sin(d) * math.cos(lat1),
+                             math.cos(d) - math.sin(lat1) * math.sin(lat2))
+    return math.degrees(lat2), (math.degrees(lon2) + 540.0) % 360.0 - 180.0
+
+
+def distance_bearing(lat, lon):
+    lat1 = math.radians(HOME_LAT)
+    lat2 = math.radians(lat)
+    dlat = lat2 - lat1
+    dlon = math.radians(lon - HOME_LON)
+    a = math.sin(dlat / 2) ** 2 + math.cos(lat1) * math.cos(lat2) * math.sin(dlon / 2) ** 2
+    dist = 2 * 3440.065 * math.asin(math.sqrt(a))
+    y = math.sin(dlon) * math.cos(lat2)
+    x = math.cos(lat1) * math.sin(lat2) - math.sin(lat1) * math.cos(lat2) * math.cos(dlon)
+    return dist, (math.degrees(math.atan2(y, x)) + 360.0) % 360.0
+
+
+def make_aircraft(rng, index):
+    # Most traffic near the airports, the rest scattered out to 250 NM
+    if rng.random() < 0.55:
+        base = rng.choice(AIRPORTS)
+        lat, lon = offset(base[0], base[1], rng.uniform(0.0, 30.0), rng.uniform(0.0, 360.0))
+    else:
+        lat, lon = offset(HOME_LAT, HOME_LON, 250.0 * math.sqrt(rng.random()), rng.uniform(0.0, 360.0))
+
+    kind = rng.random()
+    tisb = kind < 0.02
+    icao = 0x7C0000 + index * 37 % 0x3FFFF if not tisb else 0x500000 + index
+    hex_code = ("~%06x" if tisb else "%06x") % icao
+
+    ac = {"hex": hex_code, "type": "tisb_other" if tisb else ("mlat" if kind > 0.95 else "adsb_icao")}
+    if rng.random() > 0.04:
+        ac["flight"] = ("%s%d" % (rng.choice(OPERATORS), rng.randint(1, 9999))).ljust(8)
+    ac["r"] = "VH-%s" % "".join(rng.choice("ABCDEFGHJKLMNOPQRSTUVWXYZ") for _ in range(3))
+    ac["t"] = rng.choice(TYPES)
+
+    on_ground = rng.random() < 0.03
+    altitude = rng.choice([rng.randint(200, 9000), rng.randint(9000, 24000), rng.randint(24000, 41000)])
+    if on_ground:
+        ac["alt_baro"] = "ground"
+        ac["gs"] = round(rng.uniform(0.0, 25.0), 1)
+    else:
+        ac["alt_baro"] = altitude // 25 * 25
+        ac["alt_geom"] = ac["alt_baro"] + rng.randint(-10, 30) * 25
+        ac["gs"] = round(rng.uniform(120.0, 520.0), 1)
+        ac["ias"] = int(ac["gs"] * 0.8)
+        ac["mach"] = round(ac["gs"] / 660.0, 3)
+    ac["track"] = round(rng.uniform(0.0, 359.99), 2)
+    if not on_ground:
+        ac["baro_rate"] = rng.choice([0, rng.randint(-40, 40) * 64])
+        ac["nav_qnh"] = round(rng.uniform(1005.0, 1025.0), 1)
+        ac["nav_altitude_mcp"] = (altitude + 999) // 1000 * 1000
+        ac["nav_heading"] = round(rng.uniform(0.0, 359.0), 2)
+        if rng.random() < 0.6:
+            ac["nav_modes"] = rng.sample(NAV_MODES, rng.randint(1, 3))
+    ac["squawk"] = "%04o" % rng.randint(0, 0o7777)
+    ac["emergency"] = "none"
+    ac["category"] = rng.choice(["A1", "A2", "A3", "A5"])
+
+    positioned = rng.random() > 0.05
+    pos = {"lat": round(lat, 6), "lon": round(lon, 6), "nic": 8, "rc": 186}
+    if positioned:
+        ac.update(pos)
+        ac["seen_pos"] = round(rng.uniform(0.0, 3.0), 1)
+    ac.update({"version": 2, "nic_baro": 1, "nac_p": 9, "nac_v": 1, "sil": 3, "sil_type": "perhour",
+               "gva": 2, "sda": 2, "alert": 0, "spi": 0})
+    ac["mlat"] = ["lat", "lon", "track", "gs"] if ac["type"] == "mlat" else []
+    ac["tisb"] = ["lat", "lon"] if tisb else []
+    if not positioned:
+        # Position aged out: readsb moves it into a nested object
+        pos["seen_pos"] = round(rng.uniform(60.0, 300.0), 1)
+        ac["lastPosition"] = pos
+    ac["messages"] = rng.randint(50, 90000)
+    ac["seen"] = round(rng.uniform(0.0, 5.0), 1)
+    ac["rssi"] = round(rng.uniform(-30.0, -2.0), 1)
+    dist, bearing = distance_bearing(lat, lon)
+    ac["dst"] = round(dist, 3)
+    ac["dir"] = round(bearing, 1)
+    return ac
+
+
+def write_fixture(path, count, seed):
+    rng = random.Random(seed)
+    aircraft = [make_aircraft(rng, i) for i in range(count)]
+    rng.shuffle(aircraft)
+
+    lines = [json.dumps(ac, separators=(",", ":")) for ac in aircraft]
+    trailer = {"msg": "No error", "now": NOW_MS, "total": count, "ctime": NOW_MS, "ptime": 3 + count // 100}
+    with open(path, "w", newline="\r\n") as f:
+        f.write('{"ac":[\n' + ",\n".join(lines) + "\n]," + json.dumps(trailer, separators=(",", ":"))[1:] + "\n")
+
+    positioned = sum(1 for ac in aircraft if "lat" in ac)
+    in_range = sum(1 for ac in aircraft if "lat" in ac and distance_bearing(ac["lat"], ac["lon"])[0] <= 50.0)
+    print("%s: %d aircraft, %d with position, %d within 50 NM" % (os.path.basename(path), count, positioned, in_range))
+
+
+if __name__ == "__main__":
+    here = os.path.dirname(os.path.abspath(__file__))
+    write_fixture(os.path.join(here, "point_light.json"), 48, 1)
+    write_fixture(os.path.join(here, "point_heavy.json"), 720, 2)
@@ -0,0 +1,114 @@
+/*
+ * Host Test Helpers Implementation
+ */
+
+#include "host_test.h"
+#include "adsb_parser.h"
+#include <stdarg.h>
+#include <stdlib.h>
+#include <time.h>
+
+// Output of host_parse_response()
+typedef struct {
+    adsb_aircraft_t *out;
+    int max;
+    int count;
+} parse_sink_t;
+
+static int s_failures = 0;
+
+// Forward declarations
+static void parse_emit(const adsb_aircraft_t *aircraft, void *user_ctx);
+
+char *host_load_file(const char *path, int *out_len)
+{
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        host_test_fail("cannot open %s", path);
+        return NULL;
+    }
+    fseek(f, 0, SEEK_END);
+    long len = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    char *data = malloc((size_t)len + 1);
+    if (data == NULL || fread(data, 1, (size_t)len, f) != (size_t)len) {
+        host_test_fail("cannot read %s", path);
+        free(data);
+        fclose(f);
+        return NULL;
+    }
+    fclose(f);
+    data[len] = '\0';
+    *out_len = (int)len;
+    return data;
+}
+
+int host_parse_response(const char *data, int len, int chunk, adsb_aircraft_t *out, int max)
+{
+    static adsb_parser_t parser;
+    parse_sink_t sink = { .out = out, .max = max, .count = 0 };
+
+    adsb_parser_init(&parser, parse_emit, &sink);
+    if (chunk <= 0) {
+        chunk = len;
+    }
+    for (int pos = 0; pos < len; pos += chunk) {
+        adsb_parser_feed(&parser, data + pos, len - pos < chunk ? len - pos : chunk);
+    }
+    if (!adsb_parser_finish(&parser)) {
+        return -1;
+    }
+    return adsb_parser_get_count(&parser);
+}
+
+double host_now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+void host_check_rate(const char *what, double rate, const char *unit, double min_rate)
+{
+    if (min_rate <= 0.0) {
+        printf("  %-28s %12.1f %s\n", what, rate, unit);
+        return;
+    }
+    printf("  %-28s %12.1f %s (min %.1f)\n", what, rate, unit, min_rate);
+    if (rate < min_rate) {
+        host_test_fail("%s: %.1f %s is below the %.1f %s threshold", what, rate, unit, min_rate, unit);
+    }
+}
+
+void host_test_fail(const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    printf("FAIL: ");
+    vprintf(format, args);
+    printf("\n");
+    va_end(args);
+    s_failures++;
+}
+
+int host_test_finish(const char *name)
+{
+    if (s_failures > 0) {
+        printf("%s: %d check(s) failed\n", name, s_failures);
+        return 1;
+    }
+    printf("%s: all checks passed\n", name);
+    return 0;
+}
+
+// Internal functions
+
+static void parse_emit(const adsb_aircraft_t *aircraft, void *user_ctx)
+{
+    parse_sink_t *sink = user_ctx;
+    if (sink->out != NULL && sink->count < sink->max) {
+        sink->out[sink->count] = *aircraft;
+    }
+    sink->count++;
+}
@@ -0,0 +1,75 @@
+/*
+ * Host Test Helpers
+ * Fixture loading, timing and check/report helpers shared by the host
+ * regression and throughput tests. Each test is one executable that
+ * returns non-zero on any failed check, so ctest reports it.
+ */
+
+#pragma once
+
+#include "adsb_client.h"
+#include <stdbool.h>
+#include <stdio.h>
+
+// Query centre and radius of the fixtures (see fixtures/make_fixtures.py)
+#define HOST_FIXTURE_LAT -33.8127201
+#define HOST_FIXTURE_LON 151.2059618
+#define HOST_FIXTURE_RANGE_NM 50
+
+// Largest response a test loads
+#define HOST_MAX_AIRCRAFT 1024
+
+// Count a failed check and keep going, so one run reports every failure
+#define HOST_CHECK(cond, format, ...) \
+    do { \
+        if (!(cond)) { \
+            host_test_fail("%s:%d: " format, __FILE__, __LINE__, ##__VA_ARGS__); \
+        } \
+    } while (0)
+
+/**
+ * @brief Read a whole file into memory
+ * @param path File path
+ * @param out_len File length in bytes
+ * @return Heap buffer (NUL-terminated, free() it), or NULL on error
+ */
+char *host_load_file(const char *path, int *out_len);
+
+/**
+ * @brief Parse an adsb.lol response into an array
+ * @param data Response body
+ * @param len Body length
+ * @param chunk Bytes per adsb_parser_feed() call (<= 0: all at once)
+ * @param out Output aircraft (may be NULL to only count)
+ * @param max Capacity of out
+ * @return Aircraft emitted, or -1 if the document did not parse
+ */
+int host_parse_response(const char *data, int len, int chunk, adsb_aircraft_t *out, int max);
+
+/**
+ * @brief Monotonic time for throughput measurements
+ * @return Seconds
+ */
+double host_now_s(void);
+
+/**
+ * @brief Check a measured rate against its threshold and print it
+ * @param what Measurement name
+ * @param rate Measured rate
+ * @param unit Unit label
+ * @param min_rate Lowest passing rate (<= 0 only reports)
+ */
+void host_check_rate(const char *what, double rate, const char *unit, double min_rate);
+
+/**
+ * @brief Record a failed check
+ * @param format printf format
+ */
+void host_test_fail(const char *format, ...) __attribute__((format(printf, 1, 2)));
+
+/**
+ * @brief Print the summary line
+ * @param name Test name
+ * @return Process exit code (0 if every check passed)
+ */
+int host_test_finish(const char *name);
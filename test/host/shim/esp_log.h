@@ -0,0 +1,54 @@
+/*
+ * Host esp_log
+ * Same macros as ESP-IDF, printed to stdout with a ms timestamp.
+ * Debug and verbose levels are compiled out (their formats are still
+ * checked), and esp_log_level_set() sets one level for every tag.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+typedef enum {
+    ESP_LOG_NONE = 0,
+    ESP_LOG_ERROR,
+    ESP_LOG_WARN,
+    ESP_LOG_INFO,
+    ESP_LOG_DEBUG,
+    ESP_LOG_VERBOSE
+} esp_log_level_t;
+
+/**
+ * @brief Set the log level (the tag is ignored on the host)
+ * @param tag Tag, or "*"
+ * @param level Most verbose level still printed
+ */
+void esp_log_level_set(const char *tag, esp_log_level_t level);
+
+/**
+ * @brief Check whether a level is printed
+ * @param level Level
+ * @return true if at or below the current level
+ */
+bool esp_log_enabled(esp_log_level_t level);
+
+/**
+ * @brief Milliseconds since the process started
+ * @return Timestamp for log lines
+ */
+uint32_t esp_log_timestamp(void);
+
+#define HOST_LOG(level, letter, tag, format, ...) \
+    do { \
+        if (esp_log_enabled(level)) { \
+            printf(letter " (%lu) %s: " format "\n", (unsigned long)esp_log_timestamp(), tag, ##__VA_ARGS__); \
+        } \
+    } while (0)
+
+#define ESP_LOGE(tag, format, ...) HOST_LOG(ESP_LOG_ERROR, "E", tag, format, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) HOST_LOG(ESP_LOG_WARN, "W", tag, format, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) HOST_LOG(ESP_LOG_INFO, "I", tag, format, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) do { if (0) { printf("%s" format, tag, ##__VA_ARGS__); } } while (0)
+#define ESP_LOGV(tag, format, ...) do { if (0) { printf("%s" format, tag, ##__VA_ARGS__); } } while (0)
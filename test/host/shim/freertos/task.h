@@ -0,0 +1,13 @@
+/*
+ * Host FreeRTOS tasks (tick count only)
+ */
+
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+
+/**
+ * @brief Ticks since the process started
+ * @return Tick count (1 tick = 1 ms)
+ */
+TickType_t xTaskGetTickCount(void);
@@ -0,0 +1,144 @@
+/*
+ * Host Shim Implementation
+ * Backs the FreeRTOS, esp_log and heap_caps shims with libc and pthreads.
+ */
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+struct host_semaphore {
+    pthread_mutex_t mutex;
+};
+
+static uint64_t s_start_ms = 0;
+static esp_log_level_t s_log_level = ESP_LOG_INFO;
+
+// Forward declarations
+static uint64_t uptime_ms(void);
+
+uint32_t esp_log_timestamp(void)
+{
+    return (uint32_t)uptime_ms();
+}
+
+void esp_log_level_set(const char *tag, esp_log_level_t level)
+{
+    s_log_level = level;
+}
+
+bool esp_log_enabled(esp_log_level_t level)
+{
+    return level <= s_log_level;
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return (TickType_t)(uptime_ms() / portTICK_PERIOD_MS);
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    SemaphoreHandle_t sem = calloc(1, sizeof(*sem));
+    if (sem != NULL) {
+        pthread_mutex_init(&sem->mutex, NULL);
+    }
+    return sem;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks)
+{
+    if (ticks == portMAX_DELAY) {
+        return pthread_mutex_lock(&sem->mutex) == 0 ? pdTRUE : pdFALSE;
+    }
+    if (ticks == 0) {
+        return pthread_mutex_trylock(&sem->mutex) == 0 ? pdTRUE : pdFALSE;
+    }
+
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    uint64_t ns = (uint64_t)deadline.tv_nsec + (uint64_t)ticks * portTICK_PERIOD_MS * 1000000ull;
+    deadline.tv_sec += (time_t)(ns / 1000000000ull);
+    deadline.tv_nsec = (long)(ns % 1000000000ull);
+    return pthread_mutex_timedlock(&sem->mutex, &deadline) == 0 ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem)
+{
+    return pthread_mutex_unlock(&sem->mutex) == 0 ? pdTRUE : pdFALSE;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t sem)
+{
+    if (sem != NULL) {
+        pthread_mutex_destroy(&sem->mutex);
+        free(sem);
+    }
+}
+
+void *heap_caps_malloc(size_t size, uint32_t caps)
+{
+    return malloc(size);
+}
+
+void *heap_caps_calloc(size_t count, size_t size, uint32_t caps)
+{
+    return calloc(count, size);
+}
+
+void *heap_caps_aligned_calloc(size_t alignment, size_t count, size_t size, uint32_t caps)
+{
+    if (size != 0 && count > SIZE_MAX / size) {
+        return NULL;
+    }
+    void *ptr = NULL;
+    if (posix_memalign(&ptr, alignment < sizeof(void *) ? sizeof(void *) : alignment, count * size) != 0) {
+        return NULL;
+    }
+    memset(ptr, 0, count * size);
+    return ptr;
+}
+
+void *heap_caps_realloc(void *ptr, size_t size, uint32_t caps)
+{
+    return realloc(ptr, size);
+}
+
+void heap_caps_free(void *ptr)
+{
+    free(ptr);
+}
+
+size_t heap_caps_get_free_size(uint32_t caps)
+{
+    return 0;
+}
+
+size_t heap_caps_get_minimum_free_size(uint32_t caps)
+{
+    return 0;
+}
+
+size_t heap_caps_get_largest_free_block(uint32_t caps)
+{
+    return 0;
+}
+
+// Internal functions
+
+// Milliseconds since the first call (the FreeRTOS tick starts at boot)
+static uint64_t uptime_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    uint64_t ms = (uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u;
+    if (s_start_ms == 0) {
+        s_start_ms = ms;
+    }
+    return ms - s_start_ms;
+}
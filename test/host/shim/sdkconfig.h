@@ -0,0 +1,10 @@
+/*
+ * Host sdkconfig
+ * The few Kconfig symbols the host-portable modules test. Matches an
+ * ESP-IDF linux target build; LVGL and mbedTLS hooks are left out.
+ */
+
+#pragma once
+
+#define CONFIG_IDF_TARGET_LINUX 1
+#define CONFIG_FREERTOS_HZ 1000
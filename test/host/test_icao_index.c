@@ -0,0 +1,199 @@
+/*
+ * ICAO Index Regression and Throughput Test
+ *
+ *   test_icao_index <fixture.json> <min_million_ops_per_s>
+ *
+ * Fills an index to capacity with the fixture's addresses plus synthetic
+ * ones, checks slot bookkeeping through removal and reuse, then times
+ * icao_index_find() (hits and misses) and insert/remove churn of the
+ * kind a busy feed produces.
+ */
+
+#include "host_test.h"
+#include "icao_index.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define CAPACITY HOST_MAX_AIRCRAFT
+#define ROUNDS 5
+#define ROUND_SECONDS 0.2
+
+static adsb_aircraft_t s_aircraft[HOST_MAX_AIRCRAFT];
+static uint32_t s_keys[CAPACITY];
+
+// Forward declarations
+static void check_hex_keys(void);
+static int load_keys(const char *path);
+static void check_bookkeeping(icao_index_t *index);
+static double measure_finds(icao_index_t *index);
+static double measure_churn(icao_index_t *index);
+
+int main(int argc, char **argv)
+{
+    if (argc != 3) {
+        printf("usage: %s <fixture.json> <min_million_ops_per_s>\n", argv[0]);
+        return 2;
+    }
+    double min_mops = atof(argv[2]);
+
+    check_hex_keys();
+    int from_fixture = load_keys(argv[1]);
+    printf("%s: %d addresses, %d synthetic\n", argv[1], from_fixture, CAPACITY - from_fixture);
+
+    icao_index_t index;
+    if (!icao_index_init(&index, CAPACITY, MEM_TAG_STORE)) {
+        host_test_fail("icao_index_init(%d) failed", CAPACITY);
+        return host_test_finish("test_icao_index");
+    }
+    check_bookkeeping(&index);
+
+    host_check_rate("find (half misses)", measure_finds(&index) / 1e6, "Mops/s", min_mops);
+    host_check_rate("remove + insert", measure_churn(&index) / 1e6, "Mops/s", min_mops);
+
+    icao_index_deinit(&index);
+    return host_test_finish("test_icao_index");
+}
+
+// Internal functions
+
+static void check_hex_keys(void)
+{
+    HOST_CHECK(icao_key_from_hex("7c6b2d") == 0x7C6B2Du, "lower-case hex");
+    HOST_CHECK(icao_key_from_hex("7C6B2D") == 0x7C6B2Du, "upper-case hex");
+    HOST_CHECK(icao_key_from_hex("~7c6b2d") == (0x7C6B2Du | ICAO_KEY_NON_ICAO_FLAG), "TIS-B hex");
+    HOST_CHECK(icao_key_from_hex("7c6b2d") != icao_key_from_hex("~7c6b2d"), "TIS-B key collides with ICAO");
+    HOST_CHECK(icao_key_from_hex("") == ICAO_KEY_INVALID, "empty hex");
+    HOST_CHECK(icao_key_from_hex("~") == ICAO_KEY_INVALID, "bare ~");
+    HOST_CHECK(icao_key_from_hex("7c6b2dd") == ICAO_KEY_INVALID, "7 digits");
+    HOST_CHECK(icao_key_from_hex("7c6g2d") == ICAO_KEY_INVALID, "non-hex digit");
+    HOST_CHECK(icao_key_from_hex(NULL) == ICAO_KEY_INVALID, "NULL hex");
+}
+
+// Real addresses first (as clustered as allocation blocks make them), then fill
+static int load_keys(const char *path)
+{
+    int len = 0;
+    int count = 0;
+    char *data = host_load_file(path, &len);
+    if (data != NULL) {
+        count = host_parse_response(data, len, 0, s_aircraft, HOST_MAX_AIRCRAFT);
+        free(data);
+    }
+    if (count < 0) {
+        host_test_fail("%s did not parse", path);
+        count = 0;
+    }
+    if (count > CAPACITY) {
+        count = CAPACITY;
+    }
+
+    for (int i = 0; i < count; i++) {
+        s_keys[i] = icao_key_from_hex(s_aircraft[i].hex);
+        HOST_CHECK(s_keys[i] != ICAO_KEY_INVALID, "fixture hex \"%s\" rejected", s_aircraft[i].hex);
+    }
+    for (int i = count; i < CAPACITY; i++) {
+        s_keys[i] = 0xC80000u + (uint32_t)i;   // One sequential block, the worst case for weak hashes
+    }
+    return count;
+}
+
+static void check_bookkeeping(icao_index_t *index)
+{
+    static bool seen[CAPACITY];
+    memset(seen, 0, sizeof(seen));
+
+    for (int i = 0; i < CAPACITY; i++) {
+        bool inserted = false;
+        int slot = icao_index_insert(index, s_keys[i], &inserted);
+        HOST_CHECK(slot >= 0 && slot < CAPACITY && inserted, "insert %06x -> slot %d", (unsigned)s_keys[i], slot);
+        if (slot >= 0 && slot < CAPACITY) {
+            HOST_CHECK(!seen[slot], "slot %d handed out twice", slot);
+            seen[slot] = true;
+        }
+    }
+    HOST_CHECK(icao_index_count(index) == CAPACITY, "count %d after filling", icao_index_count(index));
+    HOST_CHECK(icao_index_insert(index, 0xABCDEFu, NULL) == -1, "insert into a full index succeeded");
+
+    bool inserted = true;
+    int again = icao_index_insert(index, s_keys[0], &inserted);
+    HOST_CHECK(again == icao_index_find(index, s_keys[0]) && !inserted, "re-insert of a present key");
+
+    // Remove every other key; the rest must still be found (backward-shift deletion)
+    for (int i = 0; i < CAPACITY; i += 2) {
+        HOST_CHECK(icao_index_remove(index, s_keys[i]) >= 0, "remove %06x", (unsigned)s_keys[i]);
+    }
+    HOST_CHECK(icao_index_remove(index, s_keys[0]) == -1, "second remove of a key succeeded");
+    for (int i = 0; i < CAPACITY; i++) {
+        int slot = icao_index_find(index, s_keys[i]);
+        HOST_CHECK((i % 2 == 0) == (slot == -1), "find %06x after removals -> %d", (unsigned)s_keys[i], slot);
+    }
+    HOST_CHECK(icao_index_count(index) == CAPACITY / 2, "count %d after removals", icao_index_count(index));
+
+    // Freed slots are reused
+    for (int i = 0; i < CAPACITY; i += 2) {
+        HOST_CHECK(icao_index_insert(index, s_keys[i], NULL) >= 0, "re-insert %06x", (unsigned)s_keys[i]);
+    }
+    HOST_CHECK(icao_index_count(index) == CAPACITY, "count %d after re-filling", icao_index_count(index));
+
+    icao_index_clear(index);
+    HOST_CHECK(icao_index_count(index) == 0, "count %d after clear", icao_index_count(index));
+    HOST_CHECK(icao_index_find(index, s_keys[1]) == -1, "find after clear");
+}
+
+// Lookups as the renderer does them: index half full, half of the probes miss
+static double measure_finds(icao_index_t *index)
+{
+    icao_index_clear(index);
+    for (int i = 0; i < CAPACITY; i += 2) {
+        icao_index_insert(index, s_keys[i], NULL);
+    }
+
+    double best = 0.0;
+    volatile int sink = 0;
+    for (int round = 0; round < ROUNDS; round++) {
+        long ops = 0;
+        double start = host_now_s();
+        double elapsed;
+        do {
+            for (int i = 0; i < CAPACITY; i++) {
+                sink += icao_index_find(index, s_keys[i]);
+            }
+            ops += CAPACITY;
+            elapsed = host_now_s() - start;
+        } while (elapsed < ROUND_SECONDS);
+        if (ops / elapsed > best) {
+            best = ops / elapsed;
+        }
+    }
+    (void)sink;
+    return best;
+}
+
+// Aircraft leaving and arriving with the index near capacity
+static double measure_churn(icao_index_t *index)
+{
+    icao_index_clear(index);
+    for (int i = 0; i < CAPACITY; i++) {
+        icao_index_insert(index, s_keys[i], NULL);
+    }
+
+    double best = 0.0;
+    for (int round = 0; round < ROUNDS; round++) {
+        long ops = 0;
+        double start = host_now_s();
+        double elapsed;
+        do {
+            for (int i = 0; i < CAPACITY; i++) {
+                icao_index_remove(index, s_keys[i]);
+                icao_index_insert(index, s_keys[i], NULL);
+            }
+            ops += 2 * CAPACITY;
+            elapsed = host_now_s() - start;
+        } while (elapsed < ROUND_SECONDS);
+        if (ops / elapsed > best) {
+            best = ops / elapsed;
+        }
+    }
+    HOST_CHECK(icao_index_count(index) == CAPACITY, "count %d after churn", icao_index_count(index));
+    return best;
+}
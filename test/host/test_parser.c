@@ -0,0 +1,185 @@
+/*
+ * Streaming Parser Regression and Throughput Test
+ *
+ *   test_parser <fixture.json> <aircraft> <with_position> <min_mb_per_s>
+ *
+ * Parses a recorded adsb.lol response whole and at awkward chunk sizes
+ * (every result must be identical), through gzip_stream when zlib is
+ * available, then times adsb_parser_feed() over TCP-segment-sized chunks.
+ */
+
+#include "host_test.h"
+#include "adsb_parser.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if HOST_HAVE_ZLIB
+#include "gzip_stream.h"
+#include "zlib.h"
+#endif
+
+#define TCP_CHUNK 1460                 // One Ethernet MSS, as the HTTP client delivers it
+#define ROUNDS 5
+#define ROUND_SECONDS 0.2
+
+static adsb_aircraft_t s_reference[HOST_MAX_AIRCRAFT];
+static adsb_aircraft_t s_result[HOST_MAX_AIRCRAFT];
+
+// Forward declarations
+static void check_reference(int count, int expected, int expected_positioned);
+static void check_chunking(const char *data, int len, int count);
+static double measure_parse(const char *data, int len, int chunk);
+#if HOST_HAVE_ZLIB
+static void check_gzip(const char *data, int len, int count);
+#endif
+
+int main(int argc, char **argv)
+{
+    if (argc != 5) {
+        printf("usage: %s <fixture.json> <aircraft> <with_position> <min_mb_per_s>\n", argv[0]);
+        return 2;
+    }
+    int expected = atoi(argv[2]);
+    int expected_positioned = atoi(argv[3]);
+    double min_mb_s = atof(argv[4]);
+
+    int len = 0;
+    char *data = host_load_file(argv[1], &len);
+    if (data == NULL) {
+        return host_test_finish("test_parser");
+    }
+
+    int count = host_parse_response(data, len, 0, s_reference, HOST_MAX_AIRCRAFT);
+    printf("%s: %d bytes, %d aircraft\n", argv[1], len, count);
+    check_reference(count, expected, expected_positioned);
+    if (count > 0 && count <= HOST_MAX_AIRCRAFT) {
+        check_chunking(data, len, count);
+#if HOST_HAVE_ZLIB
+        check_gzip(data, len, count);
+#endif
+    }
+
+    double seconds = measure_parse(data, len, TCP_CHUNK);
+    host_check_rate("parse", len / seconds / 1e6, "MB/s", min_mb_s);
+    host_check_rate("parse", count / seconds, "aircraft/s", 0.0);
+    host_check_rate("parse, 1-byte chunks", len / measure_parse(data, len, 1) / 1e6, "MB/s", 0.0);
+
+    free(data);
+    return host_test_finish("test_parser");
+}
+
+// Internal functions
+
+static void check_reference(int count, int expected, int expected_positioned)
+{
+    HOST_CHECK(count == expected, "parsed %d aircraft, expected %d", count, expected);
+    if (count <= 0 || count > HOST_MAX_AIRCRAFT) {
+        return;
+    }
+
+    int positioned = 0;
+    for (int i = 0; i < count; i++) {
+        const adsb_aircraft_t *ac = &s_reference[i];
+        HOST_CHECK(ac->hex[0] != '\0', "aircraft %d has no hex", i);
+        size_t cs_len = strlen(ac->callsign);
+        HOST_CHECK(cs_len == 0 || (ac->callsign[0] != ' ' && ac->callsign[cs_len - 1] != ' '),
+                   "callsign \"%s\" of %s not trimmed", ac->callsign, ac->hex);
+        if (ac->has_position) {
+            positioned++;
+            HOST_CHECK(ac->lat >= -90.0f && ac->lat <= 90.0f && ac->lon >= -180.0f && ac->lon <= 180.0f,
+                       "%s position %f,%f out of range", ac->hex, ac->lat, ac->lon);
+        } else {
+            // "lastPosition" is nested one level down and must not leak in
+            HOST_CHECK(ac->lat == 0.0f && ac->lon == 0.0f, "%s has no fix but kept %f,%f", ac->hex, ac->lat, ac->lon);
+        }
+        HOST_CHECK(ac->track >= 0.0f && ac->track < 360.0f, "%s track %f out of range", ac->hex, ac->track);
+    }
+    HOST_CHECK(positioned == expected_positioned, "%d aircraft with position, expected %d",
+               positioned, expected_positioned);
+}
+
+static void check_chunking(const char *data, int len, int count)
+{
+    static const int chunks[] = { 1, 2, 7, 64, 1000, TCP_CHUNK, 4096 };
+
+    for (size_t c = 0; c < sizeof(chunks) / sizeof(chunks[0]); c++) {
+        memset(s_result, 0xA5, sizeof(s_result));
+        int n = host_parse_response(data, len, chunks[c], s_result, HOST_MAX_AIRCRAFT);
+        HOST_CHECK(n == count, "%d-byte chunks: %d aircraft, expected %d", chunks[c], n, count);
+        HOST_CHECK(n != count || memcmp(s_result, s_reference, sizeof(adsb_aircraft_t) * count) == 0,
+                   "%d-byte chunks: decoded aircraft differ", chunks[c]);
+    }
+}
+
+static double measure_parse(const char *data, int len, int chunk)
+{
+    // Best round, so a descheduled round on a busy CI host doesn't fail the test
+    double best = 0.0;
+    for (int round = 0; round < ROUNDS; round++) {
+        int runs = 0;
+        double start = host_now_s();
+        double elapsed;
+        do {
+            host_parse_response(data, len, chunk, NULL, 0);
+            runs++;
+            elapsed = host_now_s() - start;
+        } while (elapsed < ROUND_SECONDS);
+
+        double per_run = elapsed / runs;
+        if (best == 0.0 || per_run < best) {
+            best = per_run;
+        }
+    }
+    return best;
+}
+
+#if HOST_HAVE_ZLIB
+
+static void gzip_sink(const char *data, int len, void *user_ctx)
+{
+    adsb_parser_feed(user_ctx, data, len);
+}
+
+static void collect(const adsb_aircraft_t *aircraft, void *user_ctx)
+{
+    int *n = user_ctx;
+    if (*n < HOST_MAX_AIRCRAFT) {
+        s_result[*n] = *aircraft;
+    }
+    (*n)++;
+}
+
+// Same document as the server sends it with Accept-Encoding: gzip
+static void check_gzip(const char *data, int len, int count)
+{
+    uLong bound = compressBound((uLong)len) + 32;
+    unsigned char *packed = malloc(bound);
+    z_stream zs = { 0 };
+    deflateInit2(&zs, Z_BEST_SPEED, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);
+    zs.next_in = (Bytef *)data;
+    zs.avail_in = (uInt)len;
+    zs.next_out = packed;
+    zs.avail_out = (uInt)bound;
+    HOST_CHECK(deflate(&zs, Z_FINISH) == Z_STREAM_END, "gzip compression failed");
+    int packed_len = (int)zs.total_out;
+    deflateEnd(&zs);
+
+    static adsb_parser_t parser;
+    static gzip_stream_t gz;
+    int n = 0;
+    memset(s_result, 0xA5, sizeof(s_result));
+    adsb_parser_init(&parser, collect, &n);
+    HOST_CHECK(gzip_stream_begin(&gz, gzip_sink, &parser), "gzip_stream_begin failed");
+    for (int pos = 0; pos < packed_len; pos += TCP_CHUNK) {
+        int chunk = packed_len - pos < TCP_CHUNK ? packed_len - pos : TCP_CHUNK;
+        gzip_stream_feed(&gz, (const char *)packed + pos, chunk);
+    }
+    HOST_CHECK(gzip_stream_end(&gz), "gzip body did not decode cleanly");
+    HOST_CHECK(adsb_parser_finish(&parser), "inflated document did not parse");
+    HOST_CHECK(n == count && memcmp(s_result, s_reference, sizeof(adsb_aircraft_t) * count) == 0,
+               "gzip path decoded %d aircraft, differing from the plain parse", n);
+    printf("  gzip: %d -> %d bytes\n", len, packed_len);
+    free(packed);
+}
+
+#endif
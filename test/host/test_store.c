@@ -0,0 +1,214 @@
+/*
+ * Aircraft Store Regression and Throughput Test
+ *
+ *   test_store <fixture.json> <min_updates_per_s> <min_projects_per_s>
+ *
+ * Loads a parsed adsb.lol response into the store and checks every
+ * published track on the scope against a double-precision great-circle
+ * reference (distance, bearing and screen position), then times full-batch
+ * aircraft_store_update() calls in which every aircraft has moved, and
+ * aircraft_store_project() dead-reckoning steps.
+ */
+
+#include "host_test.h"
+#include "aircraft_store.h"
+#include "perf_stats.h"
+#include "radar_config.h"
+#include "esp_log.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ROUNDS 5
+#define ROUND_SECONDS 0.2
+
+// Reference tolerances. The tangent plane ignores meridian convergence,
+// which turns bearings by up to ~0.3° (under 2 px) at 50 NM; great
+// circle is only off by float math, table trig and pixel rounding.
+#if RADAR_PROJECTION == PROJECTION_TANGENT_PLANE
+#define TOL_DISTANCE_NM 0.05
+#define TOL_BEARING_DEG 0.35
+#define TOL_SCREEN_PX 2.5
+#else
+#define TOL_DISTANCE_NM 0.02
+#define TOL_BEARING_DEG 0.1
+#define TOL_SCREEN_PX 1.0
+#endif
+#define EDGE_BAND_NM 0.1               // Tracks this close to the range edge may fall either side
+
+#define EARTH_RADIUS_NM 3440.065
+#define DEG2RAD (M_PI / 180.0)
+
+static adsb_aircraft_t s_batch[2][HOST_MAX_AIRCRAFT];
+
+// Forward declarations
+static void reference(double lat, double lon, double *out_nm, double *out_bearing);
+static void check_snapshot(int count);
+static double measure_updates(int count);
+static double measure_projects(void);
+
+int main(int argc, char **argv)
+{
+    if (argc != 4) {
+        printf("usage: %s <fixture.json> <min_updates_per_s> <min_projects_per_s>\n", argv[0]);
+        return 2;
+    }
+    double min_updates = atof(argv[2]);
+    double min_projects = atof(argv[3]);
+
+    int len = 0;
+    char *data = host_load_file(argv[1], &len);
+    if (data == NULL) {
+        return host_test_finish("test_store");
+    }
+    int count = host_parse_response(data, len, 0, s_batch[0], HOST_MAX_AIRCRAFT);
+    free(data);
+    if (count <= 0 || count > HOST_MAX_AIRCRAFT) {
+        host_test_fail("%s: %d aircraft", argv[1], count);
+        return host_test_finish("test_store");
+    }
+
+    // Second batch: every aircraft one poll (~5 s at 450 kt) further on
+    for (int i = 0; i < count; i++) {
+        s_batch[1][i] = s_batch[0][i];
+        s_batch[1][i].lat += 0.01f;
+    }
+
+    HOST_CHECK(aircraft_store_init(RADAR_MAX_AIRCRAFT_LIMIT), "aircraft_store_init failed");
+    aircraft_store_set_home_location((float)HOST_FIXTURE_LAT, (float)HOST_FIXTURE_LON);
+    aircraft_store_set_radar_radius(HOST_FIXTURE_RANGE_NM);
+
+    aircraft_store_update(s_batch[0], count);
+    check_snapshot(count);
+
+    // Per-batch log lines would dominate the timings
+    perf_stats_reset();
+    esp_log_level_set("*", ESP_LOG_WARN);
+    double updates = measure_updates(count);
+    double projects = measure_projects();
+    esp_log_level_set("*", ESP_LOG_INFO);
+
+    host_check_rate("update (all moved)", updates, "batches/s", min_updates);
+    host_check_rate("update (all moved)", updates * count, "aircraft/s", 0.0);
+    host_check_rate("project", projects, "steps/s", min_projects);
+    perf_stats_log();
+
+    return host_test_finish("test_store");
+}
+
+// Internal functions
+
+// Haversine distance and initial bearing from the fixture centre
+static void reference(double lat, double lon, double *out_nm, double *out_bearing)
+{
+    double lat1 = HOST_FIXTURE_LAT * DEG2RAD;
+    double lat2 = lat * DEG2RAD;
+    double dlat = lat2 - lat1;
+    double dlon = (lon - HOST_FIXTURE_LON) * DEG2RAD;
+
+    double a = sin(dlat / 2) * sin(dlat / 2) + cos(lat1) * cos(lat2) * sin(dlon / 2) * sin(dlon / 2);
+    *out_nm = 2.0 * EARTH_RADIUS_NM * asin(sqrt(a));
+
+    double y = sin(dlon) * cos(lat2);
+    double x = cos(lat1) * sin(lat2) - sin(lat1) * cos(lat2) * cos(dlon);
+    *out_bearing = fmod(atan2(y, x) / DEG2RAD + 360.0, 360.0);
+}
+
+static void check_snapshot(int count)
+{
+    int positioned = 0;
+    int in_range = 0;
+    int edge = 0;
+    for (int i = 0; i < count; i++) {
+        if (!s_batch[0][i].has_position) {
+            continue;
+        }
+        positioned++;
+        double nm, bearing;
+        reference(s_batch[0][i].lat, s_batch[0][i].lon, &nm, &bearing);
+        if (fabs(nm - HOST_FIXTURE_RANGE_NM) < EDGE_BAND_NM) {
+            edge++;
+        } else if (nm < HOST_FIXTURE_RANGE_NM) {
+            in_range++;
+        }
+    }
+    HOST_CHECK(aircraft_store_get_count() == positioned, "store holds %d tracks, expected %d",
+               aircraft_store_get_count(), positioned);
+
+    const aircraft_snapshot_t *snap = aircraft_store_acquire_snapshot();
+    HOST_CHECK(snap->count >= in_range && snap->count <= in_range + edge,
+               "snapshot has %d tracks, expected %d (+%d at the edge)", snap->count, in_range, edge);
+
+    double worst_nm = 0.0;
+    double worst_deg = 0.0;
+    double worst_px = 0.0;
+    double px_per_nm = (double)RADAR_DISPLAY_RADIUS / HOST_FIXTURE_RANGE_NM;
+    for (int i = 0; i < snap->count; i++) {
+        const tracked_aircraft_t *ac = &snap->aircraft[i];
+        double nm, bearing;
+        reference(ac->lat, ac->lon, &nm, &bearing);
+
+        double ref_x = SCREEN_CENTER_X + nm * px_per_nm * sin(bearing * DEG2RAD);
+        double ref_y = SCREEN_CENTER_Y - nm * px_per_nm * cos(bearing * DEG2RAD);
+        double err_nm = fabs(ac->distance_nm - nm);
+        double err_deg = fabs(fmod(aircraft_store_bearing_deg(ac) - bearing + 540.0, 360.0) - 180.0);
+        double err_px = hypot(ac->screen_x - ref_x, ac->screen_y - ref_y);
+
+        // Bearing is meaningless right over home
+        if (nm < 1.0) {
+            err_deg = 0.0;
+        }
+        HOST_CHECK(err_nm <= TOL_DISTANCE_NM, "%s distance %.3f NM, reference %.3f", ac->hex, ac->distance_nm, nm);
+        HOST_CHECK(err_deg <= TOL_BEARING_DEG, "%s bearing %.2f, reference %.2f", ac->hex,
+                   aircraft_store_bearing_deg(ac), bearing);
+        HOST_CHECK(err_px <= TOL_SCREEN_PX, "%s at %d,%d, reference %.1f,%.1f", ac->hex,
+                   ac->screen_x, ac->screen_y, ref_x, ref_y);
+        worst_nm = fmax(worst_nm, err_nm);
+        worst_deg = fmax(worst_deg, err_deg);
+        worst_px = fmax(worst_px, err_px);
+    }
+    printf("  %d tracks, %d in view; worst error %.3f NM, %.3f deg, %.2f px\n",
+           aircraft_store_get_count(), snap->count, worst_nm, worst_deg, worst_px);
+    aircraft_store_release_snapshot(snap);
+}
+
+// Alternate between the two batches so every report is a new fix
+static double measure_updates(int count)
+{
+    double best = 0.0;
+    int which = 1;
+    for (int round = 0; round < ROUNDS; round++) {
+        long batches = 0;
+        double start = host_now_s();
+        double elapsed;
+        do {
+            aircraft_store_update(s_batch[which], count);
+            which ^= 1;
+            batches++;
+            elapsed = host_now_s() - start;
+        } while (elapsed < ROUND_SECONDS);
+        if (batches / elapsed > best) {
+            best = batches / elapsed;
+        }
+    }
+    return best;
+}
+
+static double measure_projects(void)
+{
+    double best = 0.0;
+    for (int round = 0; round < ROUNDS; round++) {
+        long steps = 0;
+        double start = host_now_s();
+        double elapsed;
+        do {
+            aircraft_store_project();
+            steps++;
+            elapsed = host_now_s() - start;
+        } while (elapsed < ROUND_SECONDS);
+        if (steps / elapsed > best) {
+            best = steps / elapsed;
+        }
+    }
+    return best;
+}